@@ -50,6 +50,22 @@ public:
 void dump();
 void dump_and_reset();
 
+// Runtime profiling of the recompiled code, only implemented on Linux.
+//
+// The jitdump file (/tmp/jit-PID.dump) holds the code of every mapped block so that
+// `perf record -k 1` followed by `perf inject --jit` can annotate the JIT code.
+//
+// The sampling profiler attributes SIGPROF samples of the host pc to the guest blocks
+// and writes the hottest ones to <dir>/hotblocks-CRC.txt, on dump() and when the game
+// changes. Both return false when they aren't available. Only the threads which called
+// SampleThisThread() (the EE thread) are sampled, at hz per second of their cpu time.
+bool EnableJitDump();
+bool StartSampling(const char *dir, int hz = 1000, size_t top = 100);
+void StopSampling();
+void SampleThisThread();
+void StopSamplingThisThread();
+void SetGame(u32 crc);
+
 extern InfoVector any;
 extern InfoVector ee;
 extern InfoVector iop;
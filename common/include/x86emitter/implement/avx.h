@@ -0,0 +1,56 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// Implement the AVX/AVX2 instructions used by the recompilers.  Only the VEX.256 forms
+// are provided; the code emitting them must check x86caps and issue a VZEROUPPER before
+// returning to SSE code.
+
+namespace x86Emitter
+{
+
+struct xImplAVX_Move
+{
+    u8 Prefix;
+    u8 LoadOpcode;
+    u8 StoreOpcode;
+
+    void operator()(const xRegisterYMM &to, const xRegisterYMM &from) const;
+    void operator()(const xRegisterYMM &to, const xIndirectVoid &from) const;
+    void operator()(const xIndirectVoid &to, const xRegisterYMM &from) const;
+};
+
+struct xImplAVX_RVM
+{
+    u8 Prefix;
+    u8 MbPrefix;
+    u8 Opcode;
+
+    // RVM
+    // VANDPS 	Bitwise logical AND of packed single values
+    void operator()(const xRegisterYMM &to, const xRegisterYMM &from1, const xRegisterYMM &from2) const;
+    void operator()(const xRegisterYMM &to, const xRegisterYMM &from1, const xIndirectVoid &from2) const;
+};
+
+struct xImplAVX_PMove
+{
+    u8 OpcodeBase;
+
+    // [AVX2] Sign or zero extends 8 words into 8 dwords.
+    void WD(const xRegisterYMM &to, const xRegisterSSE &from) const;
+    void WD(const xRegisterYMM &to, const xIndirectVoid &from) const;
+};
+}
@@ -124,6 +124,15 @@ extern const xImpl_Set xSETA, xSETAE,
 // BMI extra instruction requires BMI1/BMI2
 extern const xImplBMI_RVM xMULX, xPDEP, xPEXT, xANDN_S; // Warning xANDN is already used by SSE
 
+// ------------------------------------------------------------------------
+// AVX/AVX2 instructions (VEX.256 forms only), check x86caps before use
+extern const xImplAVX_Move xVMOVUPS;
+extern const xImplAVX_RVM xVANDPS;
+extern const xImplAVX_PMove xVPMOVSX, xVPMOVZX;
+
+extern void xVINSERTI128(const xRegisterYMM &to, const xRegisterYMM &from1, const xIndirectVoid &from2, u8 imm8);
+extern void xVZEROUPPER();
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Miscellaneous Instructions
 // These are all defined inline or in ix86.cpp.
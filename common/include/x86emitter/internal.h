@@ -118,22 +118,46 @@ __emitinline void xOpWrite0F(u16 opcode, const T1 &param1, const T2 &param2, u8
     xOpWrite0F(0, opcode, param1, param2, imm8);
 }
 
+// Inverted REX.X and REX.B bits of a VEX prefix, for the operand encoded in ModRM.rm
+static __fi u8 VexXB(const xRegisterBase &rm)
+{
+#ifdef __M_X86_64
+    return rm.IsExtended() ? 0x40 : 0x60;
+#else
+    return 0x60;
+#endif
+}
+
+static __fi u8 VexXB(const xIndirectVoid &rm)
+{
+#ifdef __M_X86_64
+    // Without a SIB byte the index register is the one encoded in ModRM.rm (see EmitRex)
+    const bool sib = !rm.Index.IsEmpty() && (rm.Scale != 0 || !rm.Base.IsEmpty());
+    const bool x = sib && rm.Index.IsExtended();
+    const bool b = sib ? rm.Base.IsExtended() : rm.Index.IsExtended();
+    return (x ? 0x00 : 0x40) | (b ? 0x00 : 0x20);
+#else
+    return 0x60;
+#endif
+}
+
 // VEX 2 Bytes Prefix
+// param1 is the ModRM.reg operand, param2 the VEX.vvvv one (empty when unused) and param3
+// the ModRM.rm one, which can't be an extended register: use xOpWriteC4 for those.
 template <typename T1, typename T2, typename T3>
-__emitinline void xOpWriteC5(u8 prefix, u8 opcode, const T1 &param1, const T2 &param2, const T3 &param3)
+__emitinline void xOpWriteC5(u8 prefix, u8 opcode, const T1 &param1, const T2 &param2, const T3 &param3, int extraRIPOffset = 0)
 {
     pxAssert(prefix == 0 || prefix == 0x66 || prefix == 0xF3 || prefix == 0xF2);
-
-    const xRegisterInt &reg = param1.IsReg() ? param1 : param2;
+    pxAssert(VexXB(param3) == 0x60);
 
 #ifdef __M_X86_64
-    u8 nR = reg.IsExtended() ? 0x00 : 0x80;
+    u8 nR = param1.IsExtended() ? 0x00 : 0x80;
 #else
     u8 nR = 0x80;
 #endif
-    u8 L = reg.IsWideSIMD() ? 4 : 0;
+    u8 L = param1.IsWideSIMD() ? 4 : 0;
 
-    u8 nv = (~param2.GetId() & 0xF) << 3;
+    u8 nv = param2.IsEmpty() ? 0x78 : (~param2.GetId() & 0xF) << 3;
 
     u8 p =
         prefix == 0xF2 ? 3 :
@@ -143,32 +167,27 @@ __emitinline void xOpWriteC5(u8 prefix, u8 opcode, const T1 &param1, const T2 &p
     xWrite8(0xC5);
     xWrite8(nR | nv | L | p);
     xWrite8(opcode);
-    EmitSibMagic(param1, param3);
+    EmitSibMagic(param1, param3, extraRIPOffset);
 }
 
 // VEX 3 Bytes Prefix
 template <typename T1, typename T2, typename T3>
-__emitinline void xOpWriteC4(u8 prefix, u8 mb_prefix, u8 opcode, const T1 &param1, const T2 &param2, const T3 &param3, int w = -1)
+__emitinline void xOpWriteC4(u8 prefix, u8 mb_prefix, u8 opcode, const T1 &param1, const T2 &param2, const T3 &param3, int w = -1, int extraRIPOffset = 0)
 {
     pxAssert(prefix == 0 || prefix == 0x66 || prefix == 0xF3 || prefix == 0xF2);
     pxAssert(mb_prefix == 0x0F || mb_prefix == 0x38 || mb_prefix == 0x3A);
 
-    const xRegisterInt &reg = param1.IsReg() ? param1 : param2;
-
 #ifdef __M_X86_64
-    u8 nR = reg.IsExtended() ? 0x00 : 0x80;
-    u8 nB = param3.IsExtended() ? 0x00 : 0x20;
-    u8 nX = 0x40; // likely unused so hardwired to disabled
+    u8 nR = param1.IsExtended() ? 0x00 : 0x80;
 #else
     u8 nR = 0x80;
-    u8 nB = 0x20;
-    u8 nX = 0x40;
 #endif
-    u8 L = reg.IsWideSIMD() ? 4 : 0;
-    u8 W = (w == -1) ? (reg.GetOperandSize() == 8 ? 0x80 : 0) : // autodetect the size
-               0x80 * w;                                        // take directly the W value
+    u8 nXB = VexXB(param3);
+    u8 L = param1.IsWideSIMD() ? 4 : 0;
+    u8 W = (w == -1) ? (param1.GetOperandSize() == 8 ? 0x80 : 0) : // autodetect the size
+               0x80 * w;                                           // take directly the W value
 
-    u8 nv = (~param2.GetId() & 0xF) << 3;
+    u8 nv = param2.IsEmpty() ? 0x78 : (~param2.GetId() & 0xF) << 3;
 
     u8 p =
         prefix == 0xF2 ? 3 :
@@ -180,9 +199,9 @@ __emitinline void xOpWriteC4(u8 prefix, u8 mb_prefix, u8 opcode, const T1 &param
                             mb_prefix == 0x38 ? 2 : 1;
 
     xWrite8(0xC4);
-    xWrite8(nR | nX | nB | m);
+    xWrite8(nR | nXB | m);
     xWrite8(W | nv | L | p);
     xWrite8(opcode);
-    EmitSibMagic(param1, param3);
+    EmitSibMagic(param1, param3, extraRIPOffset);
 }
 }
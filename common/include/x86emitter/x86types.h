@@ -461,6 +461,31 @@ public:
     static const inline xRegisterSSE &GetInstance(uint id);
 };
 
+// --------------------------------------------------------------------------------------
+//  xRegisterYMM  -  Represents the 256 bit AVX view of an xmm register
+// --------------------------------------------------------------------------------------
+// Only accepted by the VEX.256 instructions (see implement/avx.h).  The lower half of a
+// ymm register is the xmm register of the same index.
+
+class xRegisterYMM : public xRegisterBase
+{
+    typedef xRegisterBase _parent;
+
+public:
+    xRegisterYMM() = default;
+    explicit xRegisterYMM(int regId)
+        : _parent(32, regId)
+    {
+    }
+    explicit xRegisterYMM(const xRegisterSSE &xmm)
+        : _parent(32, xmm.Id)
+    {
+    }
+
+    bool operator==(const xRegisterYMM &src) const { return this->Id == src.Id; }
+    bool operator!=(const xRegisterYMM &src) const { return this->Id != src.Id; }
+};
+
 class xRegisterCL : public xRegister8
 {
 public:
@@ -605,6 +630,12 @@ extern const xRegisterSSE
     xmm8, xmm9, xmm10, xmm11,
     xmm12, xmm13, xmm14, xmm15;
 
+extern const xRegisterYMM
+    ymm0, ymm1, ymm2, ymm3,
+    ymm4, ymm5, ymm6, ymm7,
+    ymm8, ymm9, ymm10, ymm11,
+    ymm12, ymm13, ymm14, ymm15;
+
 extern const xAddressReg
     rax, rbx, rcx, rdx,
     rsi, rdi, rbp, rsp,
@@ -981,3 +1012,4 @@ static __fi xAddressVoid operator+(sptr addr, const xAddressReg &reg)
 #include "implement/jmpcall.h"
 
 #include "implement/bmi.h"
+#include "implement/avx.h"
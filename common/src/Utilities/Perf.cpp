@@ -21,6 +21,20 @@
 #include "unistd.h"
 #endif
 
+#ifdef __linux__
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/time.h>
+#include <time.h>
+#include <ucontext.h>
+#endif
+
 //#define ProfileWithPerf
 #define MERGE_BLOCK_RESULT
 
@@ -41,6 +55,461 @@ InfoVector iop("IOP");
 InfoVector vu("VU");
 InfoVector vif("VIF");
 
+#ifdef __linux__
+
+////////////////////////////////////////////////////////////////////////////////
+// Runtime JIT profiling: jitdump and sampling
+////////////////////////////////////////////////////////////////////////////////
+
+// Everything below is protected by s_mutex, except the sample ring which is
+// filled from the signal handler.
+static std::mutex s_mutex;
+
+// jitdump format, see tools/perf/Documentation/jitdump-specification.txt in the
+// Linux sources.
+struct JitDumpHeader
+{
+    u32 magic;
+    u32 version;
+    u32 total_size;
+    u32 elf_mach;
+    u32 pad1;
+    u32 pid;
+    u64 timestamp;
+    u64 flags;
+};
+
+struct JitDumpCodeLoad
+{
+    u32 id;
+    u32 total_size;
+    u64 timestamp;
+    u32 pid;
+    u32 tid;
+    u64 vma;
+    u64 code_addr;
+    u64 code_size;
+    u64 code_index;
+};
+
+static std::atomic<FILE *> s_jitdump(nullptr);
+static u64 s_jitdump_index = 0;
+
+static u64 jit_timestamp()
+{
+    // perf record -k 1 (CLOCK_MONOTONIC) must be used to match these
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (u64)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static void jitdump_load(const char *name, uptr x86, u32 size)
+{
+    if (!s_jitdump)
+        return;
+
+    JitDumpCodeLoad rec;
+    rec.id = 0; // JIT_CODE_LOAD
+    rec.total_size = sizeof(rec) + strlen(name) + 1 + size;
+    rec.timestamp = jit_timestamp();
+    rec.pid = getpid();
+    rec.tid = syscall(SYS_gettid);
+    rec.vma = x86;
+    rec.code_addr = x86;
+    rec.code_size = size;
+    rec.code_index = s_jitdump_index++;
+
+    fwrite(&rec, sizeof(rec), 1, s_jitdump);
+    fwrite(name, strlen(name) + 1, 1, s_jitdump);
+    fwrite((void *)x86, size, 1, s_jitdump);
+}
+
+bool EnableJitDump()
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+
+    if (s_jitdump)
+        return true;
+
+    char file[256];
+    snprintf(file, sizeof(file), "/tmp/jit-%d.dump", getpid());
+
+    s_jitdump = fopen(file, "w+");
+    if (!s_jitdump)
+        return false;
+
+    // perf finds the file through this mapping, it must be executable
+    if (mmap(nullptr, sysconf(_SC_PAGESIZE), PROT_READ | PROT_EXEC, MAP_PRIVATE, fileno(s_jitdump), 0) == MAP_FAILED) {
+        fclose(s_jitdump);
+        s_jitdump = nullptr;
+        return false;
+    }
+
+    JitDumpHeader header;
+    header.magic = 0x4A695444; // "JiTD"
+    header.version = 1;
+    header.total_size = sizeof(header);
+#ifdef __x86_64__
+    header.elf_mach = 62; // EM_X86_64
+#else
+    header.elf_mach = 3; // EM_386
+#endif
+    header.pad1 = 0;
+    header.pid = getpid();
+    header.timestamp = jit_timestamp();
+    header.flags = 0;
+
+    fwrite(&header, sizeof(header), 1, s_jitdump);
+
+    return true;
+}
+
+// Live blocks by host address. Recompiled code is often overwritten without an
+// explicit unmap, so a new block replaces the ones starting inside its range.
+struct Block
+{
+    u32 size;
+    u32 pc;
+    const char *prefix;
+};
+
+struct Zone
+{
+    uptr x86;
+    u32 size;
+    std::string symbol;
+};
+
+static std::map<uptr, Block> s_blocks;
+static std::vector<Zone> s_zones;
+
+static std::map<std::pair<const char *, u32>, u64> s_block_hits;
+static std::map<std::string, u64> s_zone_hits;
+static u64 s_host_hits = 0;
+
+static const u32 SampleCount = 1 << 16;
+static std::atomic<uptr> s_samples[SampleCount];
+static std::atomic<u32> s_sample_head(0);
+static std::atomic<u32> s_sample_tail(0);
+static std::atomic<u32> s_sample_lost(0);
+
+static std::atomic<bool> s_sampling(false);
+static std::string s_report_dir;
+static size_t s_report_top = 0;
+static u32 s_game = 0;
+static std::thread s_drain_thread;
+static std::condition_variable s_drain_cv;
+static timespec s_sample_interval;
+
+// Cpu time timers of the sampled threads, by kernel thread id
+static std::map<pid_t, timer_t> s_thread_timers;
+
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+
+static void sample_handler(int, siginfo_t *, void *context)
+{
+    const ucontext_t *uc = (const ucontext_t *)context;
+#ifdef __x86_64__
+    const uptr ip = uc->uc_mcontext.gregs[REG_RIP];
+#else
+    const uptr ip = uc->uc_mcontext.gregs[REG_EIP];
+#endif
+
+    // Several threads may be interrupted at once, reserve the slot first
+    u32 head = s_sample_head.load(std::memory_order_relaxed);
+    do {
+        if (head - s_sample_tail.load(std::memory_order_acquire) >= SampleCount) {
+            s_sample_lost.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    } while (!s_sample_head.compare_exchange_weak(head, head + 1, std::memory_order_relaxed));
+
+    s_samples[head % SampleCount].store(ip, std::memory_order_release);
+}
+
+static void attribute(uptr ip)
+{
+    auto it = s_blocks.upper_bound(ip);
+    if (it != s_blocks.begin()) {
+        --it;
+        if (ip < it->first + it->second.size) {
+            s_block_hits[std::make_pair(it->second.prefix, it->second.pc)]++;
+            return;
+        }
+    }
+
+    for (const Zone &zone : s_zones) {
+        if (ip >= zone.x86 && ip < zone.x86 + zone.size) {
+            s_zone_hits[zone.symbol]++;
+            return;
+        }
+    }
+
+    s_host_hits++;
+}
+
+// Must be called with s_mutex held, before the blocks the samples hit go away
+static void drain()
+{
+    u32 tail = s_sample_tail.load(std::memory_order_relaxed);
+    const u32 head = s_sample_head.load(std::memory_order_acquire);
+
+    for (; tail != head; tail++) {
+        const uptr ip = s_samples[tail % SampleCount].exchange(0, std::memory_order_acquire);
+        if (ip == 0) // reserved by a handler that hasn't stored it yet
+            break;
+        attribute(ip);
+    }
+
+    s_sample_tail.store(tail, std::memory_order_release);
+}
+
+static void write_report()
+{
+    drain();
+
+    const u64 jit = std::accumulate(s_block_hits.begin(), s_block_hits.end(), (u64)0,
+                                    [](u64 sum, const decltype(s_block_hits)::value_type &hit) { return sum + hit.second; });
+    const u64 zones = std::accumulate(s_zone_hits.begin(), s_zone_hits.end(), (u64)0,
+                                      [](u64 sum, const decltype(s_zone_hits)::value_type &hit) { return sum + hit.second; });
+    const u64 total = jit + zones + s_host_hits;
+
+    if (total == 0)
+        return;
+
+    char file[512];
+    snprintf(file, sizeof(file), "%s/hotblocks-%08X.txt", s_report_dir.c_str(), s_game);
+    FILE *fp = fopen(file, "w");
+    if (!fp)
+        return;
+
+    std::vector<std::pair<u64, std::string>> hot;
+
+    for (auto &&hit : s_block_hits) {
+        char name[32];
+        snprintf(name, sizeof(name), "%s 0x%08x", hit.first.first, hit.first.second);
+        hot.emplace_back(hit.second, name);
+    }
+    for (auto &&hit : s_zone_hits)
+        hot.emplace_back(hit.second, hit.first);
+
+    std::sort(hot.begin(), hot.end(), [](const std::pair<u64, std::string> &a, const std::pair<u64, std::string> &b) { return a.first > b.first; });
+    if (hot.size() > s_report_top)
+        hot.resize(s_report_top);
+
+    fprintf(fp, "Game CRC %08X: %llu samples, %.1f%% in guest blocks, %.1f%% in other recompiled code, %u lost\n\n",
+            s_game, (unsigned long long)total, 100.0 * jit / total, 100.0 * zones / total, s_sample_lost.load());
+    fprintf(fp, "%10s %7s  %s\n", "samples", "%", "block");
+    fprintf(fp, "%10llu %6.2f%%  %s\n", (unsigned long long)s_host_hits, 100.0 * s_host_hits / total, "(host code)");
+    for (auto &&it : hot)
+        fprintf(fp, "%10llu %6.2f%%  %s\n", (unsigned long long)it.first, 100.0 * it.first / total, it.second.c_str());
+
+    fclose(fp);
+}
+
+static void drain_thread()
+{
+    std::unique_lock<std::mutex> lock(s_mutex);
+
+    while (s_sampling) {
+        drain();
+        s_drain_cv.wait_for(lock, std::chrono::milliseconds(50));
+    }
+}
+
+bool StartSampling(const char *dir, int hz, size_t top)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+
+    if (s_sampling)
+        return true;
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_sigaction = sample_handler;
+    sa.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&sa.sa_mask);
+
+    if (sigaction(SIGPROF, &sa, nullptr) != 0)
+        return false;
+
+    const long interval = 1000000000 / std::max(hz, 1);
+    s_sample_interval.tv_sec = interval / 1000000000;
+    s_sample_interval.tv_nsec = interval % 1000000000;
+    s_report_dir = dir;
+    s_report_top = top;
+    s_sampling = true;
+
+    s_drain_thread = std::thread(drain_thread);
+
+    return true;
+}
+
+void StopSampling()
+{
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+
+        if (!s_sampling)
+            return;
+
+        for (auto &&it : s_thread_timers)
+            timer_delete(it.second);
+        s_thread_timers.clear();
+
+        s_sampling = false;
+        s_drain_cv.notify_one();
+    }
+
+    s_drain_thread.join();
+
+    std::lock_guard<std::mutex> lock(s_mutex);
+    write_report();
+}
+
+// Each sampled thread gets its own timer on its own cpu time, delivered to it alone:
+// a process wide ITIMER_PROF would also interrupt the blocking system calls of every
+// other thread (io_getevents isn't restarted by SA_RESTART).
+void SampleThisThread()
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+
+    const pid_t tid = syscall(SYS_gettid);
+    if (!s_sampling || s_thread_timers.count(tid))
+        return;
+
+    sigevent sev;
+    memset(&sev, 0, sizeof(sev));
+    sev.sigev_notify = SIGEV_THREAD_ID;
+    sev.sigev_signo = SIGPROF;
+    sev.sigev_notify_thread_id = tid;
+
+    itimerspec its;
+    its.it_interval = s_sample_interval;
+    its.it_value = s_sample_interval;
+
+    timer_t timer;
+    if (timer_create(CLOCK_THREAD_CPUTIME_ID, &sev, &timer) != 0)
+        return;
+
+    if (timer_settime(timer, 0, &its, nullptr) != 0) {
+        timer_delete(timer);
+        return;
+    }
+
+    s_thread_timers[tid] = timer;
+}
+
+void StopSamplingThisThread()
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+
+    auto it = s_thread_timers.find(syscall(SYS_gettid));
+    if (it == s_thread_timers.end())
+        return;
+
+    timer_delete(it->second);
+    s_thread_timers.erase(it);
+}
+
+void SetGame(u32 crc)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+
+    if (!s_sampling || crc == s_game)
+        return;
+
+    write_report();
+
+    s_block_hits.clear();
+    s_zone_hits.clear();
+    s_host_hits = 0;
+    s_sample_lost = 0;
+    s_game = crc;
+}
+
+static void jit_map(const char *symbol, uptr x86, u32 size)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+
+    // The whole recompiler caches are registered too, only dump the small zones.
+    if (size < _64kb)
+        jitdump_load(symbol, x86, size);
+
+    // Dispatchers are generated again at every reset, at the same address
+    auto it = std::find_if(s_zones.begin(), s_zones.end(), [x86](const Zone &zone) { return zone.x86 == x86; });
+    if (it != s_zones.end())
+        *it = {x86, size, symbol};
+    else
+        s_zones.push_back({x86, size, symbol});
+}
+
+static void jit_map(const char *prefix, uptr x86, u32 size, u32 pc)
+{
+    if (!s_jitdump && !s_sampling)
+        return;
+
+    std::lock_guard<std::mutex> lock(s_mutex);
+
+    if (s_jitdump) {
+        char name[32];
+        snprintf(name, sizeof(name), "%s_0x%08x", prefix, pc);
+        jitdump_load(name, x86, size);
+    }
+
+    if (s_sampling) {
+        drain();
+        s_blocks.erase(s_blocks.lower_bound(x86), s_blocks.lower_bound(x86 + std::max<u32>(size, 1)));
+        s_blocks[x86] = {size, pc, prefix};
+    }
+}
+
+static void jit_reset(const char *prefix)
+{
+    if (!s_sampling)
+        return;
+
+    std::lock_guard<std::mutex> lock(s_mutex);
+
+    drain();
+
+    for (auto it = s_blocks.begin(); it != s_blocks.end();) {
+        if (it->second.prefix == prefix)
+            it = s_blocks.erase(it);
+        else
+            ++it;
+    }
+}
+
+static void jit_dump()
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+
+    if (s_jitdump)
+        fflush(s_jitdump);
+
+    if (s_sampling)
+        write_report();
+}
+
+#else
+
+bool EnableJitDump() { return false; }
+bool StartSampling(const char *dir, int hz, size_t top) { return false; }
+void StopSampling() {}
+void SampleThisThread() {}
+void StopSamplingThisThread() {}
+void SetGame(u32 crc) {}
+
+static void jit_map(const char *symbol, uptr x86, u32 size) {}
+static void jit_map(const char *prefix, uptr x86, u32 size, u32 pc) {}
+static void jit_reset(const char *prefix) {}
+static void jit_dump() {}
+
+#endif
+
 // Perf is only supported on linux
 #if defined(__linux__) && (defined(ProfileWithPerf) || defined(ENABLE_VTUNE))
 
@@ -101,6 +570,8 @@ void InfoVector::map(uptr x86, u32 size, const char *symbol)
     u32 max_code_size = _1gb;
 #endif
 
+    jit_map(symbol, x86, size);
+
     if (size < max_code_size) {
         m_v.emplace_back(x86, size, symbol);
 
@@ -125,6 +596,8 @@ void InfoVector::map(uptr x86, u32 size, const char *symbol)
 
 void InfoVector::map(uptr x86, u32 size, u32 pc)
 {
+    jit_map(m_prefix, x86, size, pc);
+
 #ifndef MERGE_BLOCK_RESULT
     m_v.emplace_back(x86, size, m_prefix, pc);
 #endif
@@ -153,6 +626,8 @@ void InfoVector::map(uptr x86, u32 size, u32 pc)
 
 void InfoVector::reset()
 {
+    jit_reset(m_prefix);
+
     auto dynamic = std::remove_if(m_v.begin(), m_v.end(), [](Info i) { return i.m_dynamic; });
     m_v.erase(dynamic, m_v.end());
 }
@@ -174,6 +649,8 @@ void dump()
 
     if (fp)
         fclose(fp);
+
+    jit_dump();
 }
 
 void dump_and_reset()
@@ -195,13 +672,14 @@ void dump_and_reset()
 InfoVector::InfoVector(const char *prefix)
     : m_vtune_id(0)
 {
+    strncpy(m_prefix, prefix, sizeof(m_prefix));
 }
-void InfoVector::map(uptr x86, u32 size, const char *symbol) {}
-void InfoVector::map(uptr x86, u32 size, u32 pc) {}
-void InfoVector::reset() {}
+void InfoVector::map(uptr x86, u32 size, const char *symbol) { jit_map(symbol, x86, size); }
+void InfoVector::map(uptr x86, u32 size, u32 pc) { jit_map(m_prefix, x86, size, pc); }
+void InfoVector::reset() { jit_reset(m_prefix); }
 
-void dump() {}
-void dump_and_reset() {}
+void dump() { jit_dump(); }
+void dump_and_reset() { jit_dump(); }
 
 #endif
 }
@@ -0,0 +1,90 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+#include "internal.h"
+#include "tools.h"
+
+namespace x86Emitter
+{
+
+const xImplAVX_Move xVMOVUPS = {0x00, 0x10, 0x11};
+const xImplAVX_RVM xVANDPS = {0x00, 0x0F, 0x54};
+const xImplAVX_PMove xVPMOVSX = {0x20};
+const xImplAVX_PMove xVPMOVZX = {0x30};
+
+// The 2 bytes VEX prefix only fits instructions of the 0F map whose rm operand needs
+// neither the X nor the B bit.
+template <typename T1, typename T2, typename T3>
+static void xOpWriteVEX(u8 prefix, u8 opcode, const T1 &param1, const T2 &param2, const T3 &param3)
+{
+    if (VexXB(param3) == 0x60)
+        xOpWriteC5(prefix, opcode, param1, param2, param3);
+    else
+        xOpWriteC4(prefix, 0x0F, opcode, param1, param2, param3);
+}
+
+void xImplAVX_Move::operator()(const xRegisterYMM &to, const xRegisterYMM &from) const
+{
+    if (to != from)
+        xOpWriteVEX(Prefix, LoadOpcode, to, xRegisterSSE(xEmptyReg), from);
+}
+void xImplAVX_Move::operator()(const xRegisterYMM &to, const xIndirectVoid &from) const
+{
+    xOpWriteVEX(Prefix, LoadOpcode, to, xRegisterSSE(xEmptyReg), from);
+}
+void xImplAVX_Move::operator()(const xIndirectVoid &to, const xRegisterYMM &from) const
+{
+    xOpWriteVEX(Prefix, StoreOpcode, from, xRegisterSSE(xEmptyReg), to);
+}
+
+void xImplAVX_RVM::operator()(const xRegisterYMM &to, const xRegisterYMM &from1, const xRegisterYMM &from2) const
+{
+    if (MbPrefix == 0x0F)
+        xOpWriteVEX(Prefix, Opcode, to, from1, from2);
+    else
+        xOpWriteC4(Prefix, MbPrefix, Opcode, to, from1, from2);
+}
+void xImplAVX_RVM::operator()(const xRegisterYMM &to, const xRegisterYMM &from1, const xIndirectVoid &from2) const
+{
+    if (MbPrefix == 0x0F)
+        xOpWriteVEX(Prefix, Opcode, to, from1, from2);
+    else
+        xOpWriteC4(Prefix, MbPrefix, Opcode, to, from1, from2);
+}
+
+void xImplAVX_PMove::WD(const xRegisterYMM &to, const xRegisterSSE &from) const
+{
+    xOpWriteC4(0x66, 0x38, OpcodeBase + 3, to, xRegisterSSE(xEmptyReg), from);
+}
+void xImplAVX_PMove::WD(const xRegisterYMM &to, const xIndirectVoid &from) const
+{
+    xOpWriteC4(0x66, 0x38, OpcodeBase + 3, to, xRegisterSSE(xEmptyReg), from);
+}
+
+void xVINSERTI128(const xRegisterYMM &to, const xRegisterYMM &from1, const xIndirectVoid &from2, u8 imm8)
+{
+    xOpWriteC4(0x66, 0x3A, 0x38, to, from1, from2, 0, 1);
+    xWrite8(imm8);
+}
+
+void xVZEROUPPER()
+{
+    // VEX.128.0F 77
+    xWrite8(0xC5);
+    xWrite8(0xF8);
+    xWrite8(0x77);
+}
+}
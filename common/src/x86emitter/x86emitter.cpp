@@ -120,6 +120,16 @@ const xRegisterSSE
     xmm12(12), xmm13(13),
     xmm14(14), xmm15(15);
 
+const xRegisterYMM
+    ymm0(0), ymm1(1),
+    ymm2(2), ymm3(3),
+    ymm4(4), ymm5(5),
+    ymm6(6), ymm7(7),
+    ymm8(8), ymm9(9),
+    ymm10(10), ymm11(11),
+    ymm12(12), ymm13(13),
+    ymm14(14), ymm15(15);
+
 const xAddressReg
     rax(0), rbx(3),
     rcx(1), rdx(2),
@@ -228,6 +238,13 @@ const char *const x86_regnames_sse[] =
         "xmm8", "xmm9", "xmm10", "xmm11",
         "xmm12", "xmm13", "xmm14", "xmm15"};
 
+const char *const x86_regnames_avx[] =
+    {
+        "ymm0", "ymm1", "ymm2", "ymm3",
+        "ymm4", "ymm5", "ymm6", "ymm7",
+        "ymm8", "ymm9", "ymm10", "ymm11",
+        "ymm12", "ymm13", "ymm14", "ymm15"};
+
 const char *xRegisterBase::GetName()
 {
     if (Id == xRegId_Invalid)
@@ -253,6 +270,8 @@ const char *xRegisterBase::GetName()
 #endif
         case 16:
             return x86_regnames_sse[Id];
+        case 32:
+            return x86_regnames_avx[Id];
     }
 
     return "oops?";
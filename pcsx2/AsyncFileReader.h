@@ -76,6 +76,43 @@ class FlatFileReader : public AsyncFileReader
 #elif defined(__linux__)
 	int m_fd; // FIXME don't know if overlap as an equivalent on linux
 	io_context_t m_aio_context;
+	s64 m_filesize;
+
+	// Sequential readahead: while the caller consumes one request, the next
+	// few requests of the same size are already queued on the aio context.
+	// Slots are keyed by byte offset so block size/offset changes are harmless.
+	static const int ReadaheadSlots = 4;
+
+	struct ReadaheadSlot
+	{
+		struct iocb cb;
+		std::unique_ptr<u8[]> buffer;
+		u32 capacity;
+		u64 offset;
+		u32 length;
+		long result;
+		bool inFlight;
+		bool ready;
+		bool discard; // stream moved elsewhere while the read was in flight
+	} m_readahead[ReadaheadSlots];
+
+	struct iocb m_demand_cb;
+	bool m_demand_pending;
+	long m_demand_result;
+
+	// Set when the current request is served from a prefetched slot
+	ReadaheadSlot* m_demand_slot;
+	void* m_demand_buffer;
+	u64 m_demand_offset;
+	u32 m_demand_length;
+
+	u64 m_next_offset;   // end of the previous request, to detect sequential access
+	u64 m_readahead_end; // end of the furthest queued prefetch
+
+	int ReapEvents(int min_nr);
+	void SubmitDemand(void* pBuffer, u64 offset, u32 length);
+	void QueueReadahead(u64 from, u32 length);
+	void DropReadahead();
 #elif defined(__POSIX__)
 	int m_fd; // TODO OSX don't know if overlap as an equivalent on OSX
 	struct aiocb m_aiocb;
@@ -399,7 +399,7 @@ bool DoCDVDopen()
 	cdvdTD td;
 	CDVD->getTD(0, &td);
 
-	blockDumpFile.Create(temp, 2);
+	blockDumpFile.Create(temp, OUTPUTISO_BLOCKDUMP);
 
 	if (blockDumpFile.IsOpened())
 	{
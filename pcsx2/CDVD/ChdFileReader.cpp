@@ -122,8 +122,10 @@ bool ChdFileReader::Open(const wxString& fileName)
 	sector_size = header->unitbytes;
 	sector_count = header->unitcount;
 	sectors_per_hunk = header->hunkbytes / sector_size;
+	hunk_bytes = header->hunkbytes;
 	hunk_buffer = new u8[header->hunkbytes];
 	current_hunk = -1;
+	m_cache.SetChunkSize(hunk_bytes);
 
 	delete header;
 	return true;
@@ -140,11 +142,21 @@ int ChdFileReader::ReadSync(void* pBuffer, uint sector, uint count)
 	{
 		if (current_hunk != hunk)
 		{
-			error = chd_read(ChdFile, hunk, hunk_buffer);
-			if (error != CHDERR_NONE)
+			const PX_off_t hunk_offset = (PX_off_t)hunk * hunk_bytes;
+			if (m_cache.Read(hunk_buffer, hunk_offset, hunk_bytes) != (int)hunk_bytes)
 			{
-				Console.Error(L"chd_read return error: %s", chd_error_string(error));
-				// return i * m_blocksize;
+				error = chd_read(ChdFile, hunk, hunk_buffer);
+				if (error != CHDERR_NONE)
+				{
+					Console.Error(L"chd_read return error: %s", chd_error_string(error));
+					// return i * m_blocksize;
+				}
+				else
+				{
+					void* cached = malloc(hunk_bytes);
+					memcpy(cached, hunk_buffer, hunk_bytes);
+					m_cache.Take(cached, hunk_offset, hunk_bytes, hunk_bytes);
+				}
 			}
 			current_hunk = hunk;
 		}
@@ -172,6 +184,10 @@ int ChdFileReader::FinishRead()
 
 void ChdFileReader::Close()
 {
+	m_cache.LogStats(L"CHD");
+	m_cache.Clear();
+	m_cache.ResetStats();
+
 	if (hunk_buffer != NULL)
 	{
 		//free(hunk_buffer);
@@ -200,6 +216,7 @@ u32 ChdFileReader::GetBlockCount() const
 	return sector_count;
 }
 ChdFileReader::ChdFileReader(void)
+	: m_cache(CHD_CACHE_SIZE_MB)
 {
 	ChdFile = NULL;
 	hunk_buffer = NULL;
@@ -15,8 +15,11 @@
 
 #pragma once
 #include "AsyncFileReader.h"
+#include "ChunksCache.h"
 #include "libchdr/chd.h"
 
+static const uint CHD_CACHE_SIZE_MB = 64;
+
 class ChdFileReader : public AsyncFileReader
 {
 	DeclareNoncopyableObject(ChdFileReader);
@@ -45,6 +48,9 @@ private:
 	u32 sector_size;
 	u32 sector_count;
 	u32 sectors_per_hunk;
+	u32 hunk_bytes;
 	u32 current_hunk;
 	u32 async_read;
+	// Recently decompressed hunks, keyed by hunk index
+	ChunksCache m_cache;
 };
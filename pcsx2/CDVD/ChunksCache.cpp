@@ -22,21 +22,70 @@ void ChunksCache::SetLimit(uint megabytes)
 	MatchLimit();
 }
 
+// Changing the chunk size invalidates every key, so this also empties the cache.
+void ChunksCache::SetChunkSize(uint bytes)
+{
+	pxAssert(bytes > 0);
+	Clear();
+	m_chunkSize = bytes;
+}
+
+void ChunksCache::Link(CacheEntry* e)
+{
+	e->prev = NULL;
+	e->next = m_mru;
+	if (m_mru)
+		m_mru->prev = e;
+	m_mru = e;
+	if (!m_lru)
+		m_lru = e;
+}
+
+void ChunksCache::Unlink(CacheEntry* e)
+{
+	if (e->prev)
+		e->prev->next = e->next;
+	else
+		m_mru = e->next;
+
+	if (e->next)
+		e->next->prev = e->prev;
+	else
+		m_lru = e->prev;
+
+	e->prev = e->next = NULL;
+}
+
+void ChunksCache::Evict(CacheEntry* e)
+{
+	Unlink(e);
+	m_entries.erase(e->offset / m_chunkSize);
+	m_size -= e->size;
+	delete e;
+}
+
 void ChunksCache::MatchLimit(bool removeAll)
 {
-	std::list<CacheEntry*>::reverse_iterator rit;
-	while (!m_entries.empty() && (removeAll || m_size > m_limit))
+	while (m_lru && (removeAll || m_size > m_limit))
 	{
-		rit = m_entries.rbegin();
-		m_size -= (*rit)->size;
-		delete (*rit);
-		m_entries.pop_back();
+		if (!removeAll)
+			m_stats.evictions++;
+		Evict(m_lru);
 	}
 }
 
 void ChunksCache::Take(void* pMallocedSrc, PX_off_t offset, int length, int coverage)
 {
-	m_entries.push_front(new CacheEntry(pMallocedSrc, offset, length, coverage));
+	pxAssertDev(offset % m_chunkSize == 0 && (uint)coverage <= m_chunkSize,
+				"ChunksCache entries must be chunk aligned and fit in a single chunk");
+
+	auto it = m_entries.find(offset / m_chunkSize);
+	if (it != m_entries.end())
+		Evict(it->second);
+
+	CacheEntry* e = new CacheEntry(pMallocedSrc, offset, length, coverage);
+	m_entries[offset / m_chunkSize] = e;
+	Link(e);
 	m_size += length;
 	MatchLimit();
 }
@@ -44,15 +93,33 @@ void ChunksCache::Take(void* pMallocedSrc, PX_off_t offset, int length, int cove
 // By design, succeed only if the entire request is in a single cached chunk
 int ChunksCache::Read(void* pDest, PX_off_t offset, int length)
 {
-	for (auto it = m_entries.begin(); it != m_entries.end(); it++)
+	auto it = m_entries.find(offset / m_chunkSize);
+	if (it != m_entries.end())
 	{
-		CacheEntry* e = *it;
-		if (e && offset >= e->offset && (offset + length) <= (e->offset + e->coverage))
+		CacheEntry* e = it->second;
+		if ((offset + length) <= (e->offset + e->coverage))
 		{
-			if (it != m_entries.begin())
-				m_entries.splice(m_entries.begin(), m_entries, it); // Move to top (MRU)
+			if (e != m_mru)
+			{
+				// Move to top (MRU)
+				Unlink(e);
+				Link(e);
+			}
+			m_stats.hits++;
 			return CopyAvailable(e->data, e->offset, e->size, pDest, offset, length);
 		}
 	}
+
+	m_stats.misses++;
 	return -1;
 }
+
+void ChunksCache::LogStats(const wxChar* name) const
+{
+	u64 lookups = m_stats.hits + m_stats.misses;
+	if (!lookups)
+		return;
+
+	DevCon.WriteLn(Color_Gray, L"%s cache: %llu hits, %llu misses (%.1f%% hit rate), %llu evictions",
+				   name, m_stats.hits, m_stats.misses, 100.0 * m_stats.hits / lookups, m_stats.evictions);
+}
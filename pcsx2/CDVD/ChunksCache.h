@@ -16,23 +16,45 @@
 #pragma once
 
 #include "zlib_indexed.h"
+#include <unordered_map>
 
 #define CLAMP(val, minval, maxval) (std::min(maxval, std::max(minval, val)))
 
+// Cache of decompressed data, addressed in fixed size chunks.
+// Every entry must start at a chunk boundary and cover at most one chunk, which
+// lets Read() find its entry with a single hash lookup instead of a list scan.
+// Entries are kept in an intrusive MRU list and evicted from the LRU end.
 class ChunksCache
 {
 public:
-	ChunksCache(uint initialLimitMb)
-		: m_entries(0)
+	struct Stats
+	{
+		u64 hits;
+		u64 misses;
+		u64 evictions;
+	};
+
+	ChunksCache(uint initialLimitMb, uint chunkSize = 256 * 1024)
+		: m_mru(NULL)
+		, m_lru(NULL)
+		, m_chunkSize(chunkSize)
 		, m_size(0)
-		, m_limit(initialLimitMb * 1024 * 1024){};
+		, m_limit(initialLimitMb * 1024 * 1024)
+	{
+		ResetStats();
+	};
 	~ChunksCache() { Clear(); };
 	void SetLimit(uint megabytes);
+	void SetChunkSize(uint bytes);
 	void Clear() { MatchLimit(true); };
 
 	void Take(void* pMallocedSrc, PX_off_t offset, int length, int coverage);
 	int Read(void* pDest, PX_off_t offset, int length);
 
+	const Stats& GetStats() const { return m_stats; }
+	void ResetStats() { memzero(m_stats); }
+	void LogStats(const wxChar* name) const;
+
 	static int CopyAvailable(void* pSrc, PX_off_t srcOffset, int srcSize,
 							 void* pDst, PX_off_t dstOffset, int maxCopySize)
 	{
@@ -49,7 +71,9 @@ private:
 			: data(pMallocedSrc)
 			, offset(offset)
 			, coverage(coverage)
-			, size(length){};
+			, size(length)
+			, prev(NULL)
+			, next(NULL){};
 
 		~CacheEntry()
 		{
@@ -61,12 +85,25 @@ private:
 		PX_off_t offset;
 		int coverage;
 		int size;
+
+		// MRU list links
+		CacheEntry* prev;
+		CacheEntry* next;
 	};
 
-	std::list<CacheEntry*> m_entries;
+	void Link(CacheEntry* e);
+	void Unlink(CacheEntry* e);
+	void Evict(CacheEntry* e);
 	void MatchLimit(bool removeAll = false);
+
+	// chunk index -> entry
+	std::unordered_map<PX_off_t, CacheEntry*> m_entries;
+	CacheEntry* m_mru;
+	CacheEntry* m_lru;
+	uint m_chunkSize;
 	PX_off_t m_size;
 	PX_off_t m_limit;
+	Stats m_stats;
 };
 
 #undef CLAMP
@@ -95,6 +95,7 @@ bool CsoFileReader::Open(const wxString& fileName)
 	if (m_src && ReadFileHeader() && InitializeBuffers())
 	{
 		success = true;
+		StartDecodeAhead();
 	}
 
 	if (!success)
@@ -141,6 +142,7 @@ bool CsoFileReader::InitializeBuffers()
 {
 	// Round up, since part of a frame requires a full frame.
 	u32 numFrames = (u32)((m_totalSize + m_frameSize - 1) / m_frameSize);
+	m_numFrames = numFrames;
 
 	// We might read a bit of alignment too, so be prepared.
 	if (m_frameSize + (1 << m_indexShift) < CSO_READ_BUFFER_SIZE)
@@ -156,6 +158,10 @@ bool CsoFileReader::InitializeBuffers()
 	m_zlibBuffer = new u8[m_frameSize + (1 << m_indexShift)];
 	m_zlibBufferFrame = numFrames;
 
+#if CSO_USE_CHUNKSCACHE
+	m_cache.SetChunkSize(m_frameSize);
+#endif
+
 	const u32 indexSize = numFrames + 1;
 	m_index = new u32[indexSize];
 	if (fread(m_index, sizeof(u32), indexSize, m_src) != indexSize)
@@ -179,9 +185,14 @@ bool CsoFileReader::InitializeBuffers()
 
 void CsoFileReader::Close()
 {
+	// The workers use the file name and index, stop them first.
+	StopDecodeAhead();
+
 	m_filename.Empty();
 #if CSO_USE_CHUNKSCACHE
+	m_cache.LogStats(L"CSO");
 	m_cache.Clear();
+	m_cache.ResetStats();
 #endif
 
 	if (m_src)
@@ -230,29 +241,11 @@ int CsoFileReader::ReadSync(void* pBuffer, uint sector, uint count)
 
 	while (remaining > 0)
 	{
-		int readBytes;
-
-#if CSO_USE_CHUNKSCACHE
-		// Try first to read from the cache.
-		readBytes = m_cache.Read(dest + bytes, pos + bytes, remaining);
-#else
-		readBytes = -1;
-#endif
-		if (readBytes < 0)
+		int readBytes = ReadFromFrame(dest + bytes, pos + bytes, remaining);
+		if (readBytes == 0)
 		{
-			readBytes = ReadFromFrame(dest + bytes, pos + bytes, remaining);
-			if (readBytes == 0)
-			{
-				// We hit EOF.
-				break;
-			}
-
-#if CSO_USE_CHUNKSCACHE
-			// Add the bytes into the cache.  We need to allocate a buffer for it.
-			void* cached = malloc(readBytes);
-			memcpy(cached, dest + bytes, readBytes);
-			m_cache.Take(cached, pos + bytes, readBytes, readBytes);
-#endif
+			// We hit EOF.
+			break;
 		}
 
 		bytes += readBytes;
@@ -299,18 +292,37 @@ int CsoFileReader::ReadFromFrame(u8* dest, u64 pos, int maxBytes)
 		// We don't need to decompress if we already did this same frame last time.
 		if (m_zlibBufferFrame != frame)
 		{
-			if (PX_fseeko(m_src, m_dataoffset + frameRawPos, SEEK_SET) != 0)
-			{
-				Console.Error("Unable to seek to compressed CSO data.");
-				return 0;
-			}
-			// This might be less bytes than frameRawSize in case of padding on the last frame.
-			// This is because the index positions must be aligned.
-			const u32 readRawBytes = fread(m_readBuffer, 1, frameRawSize, m_src);
-			if (!DecompressFrame(frame, readRawBytes))
+#if CSO_USE_CHUNKSCACHE
+			// Try the previously decompressed frames next.
+			if (m_cache.Read(dest, pos, bytes) == (int)bytes)
+				return bytes;
+#endif
+
+			// Then a frame the workers already inflated, or decompress it ourselves.
+			if (!TakeDecodedFrame(frame))
 			{
-				return 0;
+				if (PX_fseeko(m_src, m_dataoffset + frameRawPos, SEEK_SET) != 0)
+				{
+					Console.Error("Unable to seek to compressed CSO data.");
+					return 0;
+				}
+				// This might be less bytes than frameRawSize in case of padding on the last frame.
+				// This is because the index positions must be aligned.
+				const u32 readRawBytes = fread(m_readBuffer, 1, frameRawSize, m_src);
+				if (!DecompressFrame(frame, readRawBytes))
+				{
+					return 0;
+				}
 			}
+
+			QueueDecodeAhead(frame);
+
+#if CSO_USE_CHUNKSCACHE
+			// Keep a copy of the whole frame, later reads usually hit its other sectors.
+			void* cached = malloc(m_frameSize);
+			memcpy(cached, m_zlibBuffer, m_frameSize);
+			m_cache.Take(cached, (u64)frame << m_frameShift, m_frameSize, m_frameSize);
+#endif
 		}
 
 		// Now we just copy the offset data from the cache.
@@ -320,15 +332,23 @@ int CsoFileReader::ReadFromFrame(u8* dest, u64 pos, int maxBytes)
 	return bytes;
 }
 
-bool CsoFileReader::DecompressFrame(u32 frame, u32 readBufferSize)
+bool CsoFileReader::InflateFrame(z_stream* z, const u8* src, u32 srcSize, u8* dst) const
 {
-	m_z_stream->next_in = m_readBuffer;
-	m_z_stream->avail_in = readBufferSize;
-	m_z_stream->next_out = m_zlibBuffer;
-	m_z_stream->avail_out = m_frameSize;
+	z->next_in = const_cast<u8*>(src);
+	z->avail_in = srcSize;
+	z->next_out = dst;
+	z->avail_out = m_frameSize;
+
+	int status = inflate(z, Z_FINISH);
+	bool success = status == Z_STREAM_END && z->total_out == m_frameSize;
 
-	int status = inflate(m_z_stream, Z_FINISH);
-	bool success = status == Z_STREAM_END && m_z_stream->total_out == m_frameSize;
+	inflateReset(z);
+	return success;
+}
+
+bool CsoFileReader::DecompressFrame(u32 frame, u32 readBufferSize)
+{
+	bool success = InflateFrame(m_z_stream, m_readBuffer, readBufferSize, m_zlibBuffer);
 	if (success)
 	{
 		// Our buffer now contains this frame.
@@ -340,10 +360,178 @@ bool CsoFileReader::DecompressFrame(u32 frame, u32 readBufferSize)
 		m_zlibBufferFrame = (u32)-1;
 	}
 
-	inflateReset(m_z_stream);
 	return success;
 }
 
+void CsoFileReader::StartDecodeAhead()
+{
+	// Leave some cores for the EE/GS/VU threads.
+	const uint workers = std::min(CSO_DECODE_AHEAD_THREADS, std::max(1u, std::thread::hardware_concurrency() / 4));
+
+	m_decodeRing.resize(CSO_DECODE_AHEAD_FRAMES);
+	for (DecodedFrame& slot : m_decodeRing)
+	{
+		slot.state = DecodedFrame::Empty;
+		slot.frame = 0;
+		slot.buffer = new u8[m_frameSize];
+	}
+
+	m_decodeQuit = false;
+	for (uint i = 0; i < workers; i++)
+		m_decodeThreads.emplace_back(&CsoFileReader::DecodeAheadWorker, this);
+}
+
+void CsoFileReader::StopDecodeAhead()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_decodeMutex);
+		m_decodeQuit = true;
+	}
+	m_decodeWork.notify_all();
+
+	for (std::thread& thread : m_decodeThreads)
+		thread.join();
+	m_decodeThreads.clear();
+
+	for (DecodedFrame& slot : m_decodeRing)
+		delete[] slot.buffer;
+	m_decodeRing.clear();
+}
+
+// Queues the compressed frames following `frame`, recycling slots that fell
+// out of the window. Frames already queued or decoded are left alone.
+void CsoFileReader::QueueDecodeAhead(u32 frame)
+{
+	if (m_decodeThreads.empty())
+		return;
+
+	const u32 first = frame + 1;
+	const u32 last = std::min<u32>(frame + CSO_DECODE_AHEAD_FRAMES, m_numFrames - 1);
+	bool queued = false;
+
+	std::lock_guard<std::mutex> lock(m_decodeMutex);
+
+	for (u32 f = first; f <= last; f++)
+	{
+		// Uncompressed frames are read directly.
+		if (m_index[f] & 0x80000000)
+			continue;
+
+		DecodedFrame* reuse = NULL;
+		bool present = false;
+		for (DecodedFrame& slot : m_decodeRing)
+		{
+			if (slot.state != DecodedFrame::Empty && slot.state != DecodedFrame::Failed && slot.frame == f)
+			{
+				present = true;
+				break;
+			}
+
+			if (!reuse && slot.state != DecodedFrame::Decoding &&
+				(slot.state == DecodedFrame::Empty || slot.state == DecodedFrame::Failed ||
+				 slot.frame < first || slot.frame > last))
+				reuse = &slot;
+		}
+
+		if (present)
+			continue;
+		if (!reuse)
+			break;
+
+		reuse->frame = f;
+		reuse->state = DecodedFrame::Pending;
+		queued = true;
+	}
+
+	if (queued)
+		m_decodeWork.notify_all();
+}
+
+// Moves a frame decoded by the workers into m_zlibBuffer, waiting for it if
+// it is already queued. Returns false if the caller has to inflate it.
+bool CsoFileReader::TakeDecodedFrame(u32 frame)
+{
+	if (m_decodeThreads.empty())
+		return false;
+
+	std::unique_lock<std::mutex> lock(m_decodeMutex);
+
+	for (DecodedFrame& slot : m_decodeRing)
+	{
+		if (slot.frame != frame || slot.state == DecodedFrame::Empty)
+			continue;
+
+		m_decodeDone.wait(lock, [&slot, frame] {
+			return slot.frame != frame || slot.state == DecodedFrame::Ready || slot.state == DecodedFrame::Failed;
+		});
+
+		if (slot.frame != frame || slot.state != DecodedFrame::Ready)
+			return false;
+
+		memcpy(m_zlibBuffer, slot.buffer, m_frameSize);
+		m_zlibBufferFrame = frame;
+		slot.state = DecodedFrame::Empty;
+		return true;
+	}
+
+	return false;
+}
+
+void CsoFileReader::DecodeAheadWorker()
+{
+	FILE* src = PX_fopen_rb(m_filename);
+	std::unique_ptr<u8[]> raw(new u8[m_frameSize + (1 << m_indexShift)]);
+
+	z_stream z = {};
+	const bool ready = src && inflateInit2(&z, -15) == Z_OK;
+
+	std::unique_lock<std::mutex> lock(m_decodeMutex);
+	while (!m_decodeQuit)
+	{
+		DecodedFrame* job = NULL;
+		for (DecodedFrame& slot : m_decodeRing)
+		{
+			if (slot.state == DecodedFrame::Pending)
+			{
+				job = &slot;
+				break;
+			}
+		}
+
+		if (!job)
+		{
+			m_decodeWork.wait(lock);
+			continue;
+		}
+
+		job->state = DecodedFrame::Decoding;
+		const u32 frame = job->frame;
+		lock.unlock();
+
+		const u32 index0 = m_index[frame + 0] & 0x7FFFFFFF;
+		const u32 index1 = m_index[frame + 1] & 0x7FFFFFFF;
+		const u64 frameRawPos = (u64)index0 << m_indexShift;
+		const u32 frameRawSize = std::min<u32>((index1 - index0) << m_indexShift, m_frameSize + (1 << m_indexShift));
+
+		bool success = ready && PX_fseeko(src, m_dataoffset + frameRawPos, SEEK_SET) == 0;
+		if (success)
+		{
+			const u32 readRawBytes = fread(raw.get(), 1, frameRawSize, src);
+			success = InflateFrame(&z, raw.get(), readRawBytes, job->buffer);
+		}
+
+		lock.lock();
+		job->state = success ? DecodedFrame::Ready : DecodedFrame::Failed;
+		m_decodeDone.notify_all();
+	}
+	lock.unlock();
+
+	if (ready)
+		inflateEnd(&z);
+	if (src)
+		fclose(src);
+}
+
 void CsoFileReader::BeginRead(void* pBuffer, uint sector, uint count)
 {
 	// TODO: No async support yet, implement as sync.
@@ -15,22 +15,28 @@
 
 #pragma once
 
-// Based on testing, the overhead of using this cache is high.
+// Decompressed frames are kept in a ChunksCache keyed by frame index.
 //
-// The test was done with CSO files using a block size of 16KB.
-// Cache hit rates were observed in the range of 25%.
-// Cache overhead added 35% to the overall read time.
-//
-// For this reason, it's currently disabled.
-#define CSO_USE_CHUNKSCACHE 0
+// An earlier list based cache cached individual reads and was disabled because
+// its lookup overhead added 35% to the overall read time. Caching whole frames
+// with an O(1) lookup avoids that, and also serves every later sector of a frame.
+#define CSO_USE_CHUNKSCACHE 1
 
 #include "AsyncFileReader.h"
 #include "ChunksCache.h"
 
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 struct CsoHeader;
 typedef struct z_stream_s z_stream;
 
 static const uint CSO_CHUNKCACHE_SIZE_MB = 200;
+// Frames inflated ahead of the read position by the worker threads.
+static const uint CSO_DECODE_AHEAD_FRAMES = 8;
+static const uint CSO_DECODE_AHEAD_THREADS = 4;
 
 class CsoFileReader : public AsyncFileReader
 {
@@ -48,6 +54,8 @@ public:
 		, m_totalSize(0)
 		, m_src(0)
 		, m_z_stream(0)
+		, m_numFrames(0)
+		, m_decodeQuit(false)
 		,
 #if CSO_USE_CHUNKSCACHE
 		m_cache(CSO_CHUNKCACHE_SIZE_MB)
@@ -85,6 +93,13 @@ private:
 	bool InitializeBuffers();
 	int ReadFromFrame(u8* dest, u64 pos, int maxBytes);
 	bool DecompressFrame(u32 frame, u32 readBufferSize);
+	bool InflateFrame(z_stream* z, const u8* src, u32 srcSize, u8* dst) const;
+
+	void StartDecodeAhead();
+	void StopDecodeAhead();
+	void QueueDecodeAhead(u32 frame);
+	bool TakeDecodedFrame(u32 frame);
+	void DecodeAheadWorker();
 
 	u32 m_frameSize;
 	u8 m_frameShift;
@@ -97,6 +112,32 @@ private:
 	// The actual source cso file handle.
 	FILE* m_src;
 	z_stream* m_z_stream;
+	u32 m_numFrames;
+
+	// Decode-ahead: workers inflate the frames following the last one read into
+	// this ring, each with its own file handle and z_stream. Slot states and
+	// frame numbers are protected by m_decodeMutex, a slot buffer belongs to the
+	// worker while it is Decoding and to the reader once it is Ready.
+	struct DecodedFrame
+	{
+		enum State
+		{
+			Empty,
+			Pending,
+			Decoding,
+			Ready,
+			Failed,
+		} state;
+		u32 frame;
+		u8* buffer;
+	};
+
+	std::vector<DecodedFrame> m_decodeRing;
+	std::vector<std::thread> m_decodeThreads;
+	std::mutex m_decodeMutex;
+	std::condition_variable m_decodeWork; // a slot became Pending, or shutdown
+	std::condition_variable m_decodeDone; // a slot became Ready or Failed
+	bool m_decodeQuit;
 
 #if CSO_USE_CHUNKSCACHE
 	ChunksCache m_cache;
@@ -73,6 +73,7 @@ public:
 
 	isoType GetType() const { return m_type; }
 	uint GetBlockCount() const { return m_blocks; }
+	uint GetBlockSize() const { return m_blocksize; }
 	int GetBlockOffset() const { return m_blockofs; }
 
 	const wxString& GetFilename() const
@@ -97,10 +98,24 @@ protected:
 	void FindParts();
 };
 
+// OutputIsoFile versions (the `mode` passed to Create)
+enum OutputIsoVersion
+{
+	OUTPUTISO_FLAT = 0,      // plain image, sectors written at their offset
+	OUTPUTISO_BLOCKDUMP = 2, // BDV2 blockdump with a per-sector lsn table
+	OUTPUTISO_XZ = 3,        // multi-block .xz stream, sectors written in order
+};
+
+// Size of the uncompressed data in each block of an OUTPUTISO_XZ image. Every
+// random read of the image decodes one block, so keep this small.
+static const uint OUTPUTISO_XZ_BLOCK_SIZE = 1024 * 1024;
+
 class OutputIsoFile
 {
 	DeclareNoncopyableObject(OutputIsoFile);
 
+	struct XzEncoder;
+
 protected:
 	wxString m_filename;
 
@@ -118,6 +133,10 @@ protected:
 
 	std::unique_ptr<wxFileOutputStream> m_outstream;
 
+	// OUTPUTISO_XZ state
+	std::unique_ptr<XzEncoder> m_xz;
+	u32 m_xz_next_lsn;
+
 public:
 	OutputIsoFile();
 	virtual ~OutputIsoFile();
@@ -131,6 +150,7 @@ public:
 	}
 
 	void Create(const wxString& filename, int mode);
+	void Finish();
 	void Close();
 
 	void WriteHeader(int blockofs, uint blocksize, uint blocks);
@@ -141,6 +161,8 @@ protected:
 	void _init();
 
 	void WriteBuffer(const void* src, size_t size);
+	void WriteXz(const void* src, size_t size);
+	void FlushXz(bool finish);
 
 	template <typename T>
 	void WriteValue(const T& data)
@@ -148,3 +170,7 @@ protected:
 		WriteBuffer(&data, sizeof(data));
 	}
 };
+
+// Writes every sector of srcfile into a seekable, multi-block .xz image that
+// XzFileReader can open. Throws on read or write errors.
+extern void ConvertIsoToXz(const wxString& srcfile, const wxString& dstfile);
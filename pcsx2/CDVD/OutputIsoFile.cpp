@@ -19,6 +19,14 @@
 #include "IsoFileFormats.h"
 
 #include <errno.h>
+#include <lzma.h>
+
+struct OutputIsoFile::XzEncoder
+{
+	lzma_stream strm;
+	u32 blockBytes; // uncompressed bytes in the current xz block
+	u8 out[64 * 1024];
+};
 
 void pxStream_OpenCheck(const wxStreamBase& stream, const wxString& fname, const wxString& mode)
 {
@@ -48,6 +56,8 @@ void OutputIsoFile::_init()
 	m_blockofs = 0;
 	m_blocksize = 0;
 	m_blocks = 0;
+
+	m_xz_next_lsn = 0;
 }
 
 void OutputIsoFile::Create(const wxString& filename, int version)
@@ -63,6 +73,19 @@ void OutputIsoFile::Create(const wxString& filename, int version)
 	m_outstream = std::make_unique<wxFileOutputStream>(m_filename);
 	pxStream_OpenCheck(*m_outstream, m_filename, L"writing");
 
+	if (m_version == OUTPUTISO_XZ)
+	{
+		m_xz = std::make_unique<XzEncoder>();
+		m_xz->strm = LZMA_STREAM_INIT;
+		m_xz->blockBytes = 0;
+
+		if (lzma_easy_encoder(&m_xz->strm, LZMA_PRESET_DEFAULT, LZMA_CHECK_CRC32) != LZMA_OK)
+		{
+			m_xz.reset();
+			throw Exception::RuntimeError().SetDiagMsg(L"Unable to initialize the xz encoder");
+		}
+	}
+
 	Console.WriteLn("isoFile create ok: %s ", WX_STR(m_filename));
 }
 
@@ -77,7 +100,7 @@ void OutputIsoFile::WriteHeader(int _blockofs, uint _blocksize, uint _blocks)
 	Console.WriteLn("blocksize   = %u", m_blocksize);
 	Console.WriteLn("blocks	     = %u", m_blocks);
 
-	if (m_version == 2)
+	if (m_version == OUTPUTISO_BLOCKDUMP)
 	{
 		WriteBuffer("BDV2", 4);
 		WriteValue(m_blocksize);
@@ -88,7 +111,25 @@ void OutputIsoFile::WriteHeader(int _blockofs, uint _blocksize, uint _blocks)
 
 void OutputIsoFile::WriteSector(const u8* src, uint lsn)
 {
-	if (m_version == 2)
+	if (m_version == OUTPUTISO_XZ)
+	{
+		// xz images are written as one stream, so sectors have to arrive in order.
+		// Gaps (unreadable sectors) are filled with zeros.
+		if (lsn < m_xz_next_lsn)
+			return;
+
+		if (lsn > m_xz_next_lsn)
+		{
+			std::vector<u8> zeros(m_blocksize);
+			for (; m_xz_next_lsn < lsn; m_xz_next_lsn++)
+				WriteXz(zeros.data(), m_blocksize);
+		}
+
+		WriteXz(src + m_blockofs, m_blocksize);
+		m_xz_next_lsn++;
+		return;
+	}
+	else if (m_version == OUTPUTISO_BLOCKDUMP)
 	{
 		// Find and ignore blocks that have already been dumped:
 		if (std::any_of(std::begin(m_dtable), std::end(m_dtable), [=](const u32 entry) { return entry == lsn; }))
@@ -108,8 +149,24 @@ void OutputIsoFile::WriteSector(const u8* src, uint lsn)
 	WriteBuffer(src + m_blockofs, m_blocksize);
 }
 
+// Completes the image.  xz images need this to write their last block, the index and the
+// stream footer; one closed without it is left without an index, so readers reject it.
+void OutputIsoFile::Finish()
+{
+	if (m_xz)
+		FlushXz(true);
+}
+
+// Doesn't throw, so it's safe to call while unwinding from a failed conversion.
 void OutputIsoFile::Close()
 {
+	if (m_xz)
+	{
+		lzma_end(&m_xz->strm);
+		m_xz.reset();
+		m_outstream->Close();
+	}
+
 	m_dtable.clear();
 
 	_init();
@@ -130,6 +187,55 @@ void OutputIsoFile::WriteBuffer(const void* src, size_t size)
 	}
 }
 
+// Compresses one sector worth of data, starting a new xz block every
+// OUTPUTISO_XZ_BLOCK_SIZE bytes so readers can seek by block.
+void OutputIsoFile::WriteXz(const void* src, size_t size)
+{
+	lzma_stream& strm = m_xz->strm;
+	strm.next_in = (const u8*)src;
+	strm.avail_in = size;
+
+	while (strm.avail_in > 0)
+	{
+		strm.next_out = m_xz->out;
+		strm.avail_out = sizeof(m_xz->out);
+
+		if (lzma_code(&strm, LZMA_RUN) != LZMA_OK)
+			throw Exception::BadStream(m_filename).SetDiagMsg(L"xz compression failed");
+
+		WriteBuffer(m_xz->out, sizeof(m_xz->out) - strm.avail_out);
+	}
+
+	m_xz->blockBytes += size;
+	if (m_xz->blockBytes >= OUTPUTISO_XZ_BLOCK_SIZE)
+		FlushXz(false);
+}
+
+// Ends the current xz block (LZMA_FULL_FLUSH) or the whole stream (LZMA_FINISH).
+void OutputIsoFile::FlushXz(bool finish)
+{
+	lzma_stream& strm = m_xz->strm;
+	const lzma_action action = finish ? LZMA_FINISH : LZMA_FULL_FLUSH;
+	lzma_ret ret;
+
+	strm.next_in = NULL;
+	strm.avail_in = 0;
+
+	do
+	{
+		strm.next_out = m_xz->out;
+		strm.avail_out = sizeof(m_xz->out);
+
+		ret = lzma_code(&strm, action);
+		if (ret != LZMA_OK && ret != LZMA_STREAM_END)
+			throw Exception::BadStream(m_filename).SetDiagMsg(L"xz compression failed");
+
+		WriteBuffer(m_xz->out, sizeof(m_xz->out) - strm.avail_out);
+	} while (ret != LZMA_STREAM_END);
+
+	m_xz->blockBytes = 0;
+}
+
 bool OutputIsoFile::IsOpened() const
 {
 	return m_outstream && m_outstream->IsOk();
@@ -139,3 +245,43 @@ u32 OutputIsoFile::GetBlockSize() const
 {
 	return m_blocksize;
 }
+
+void ConvertIsoToXz(const wxString& srcfile, const wxString& dstfile)
+{
+	InputIsoFile src;
+	src.Open(srcfile);
+
+	const uint blocks = src.GetBlockCount();
+	const int blockofs = src.GetBlockOffset();
+
+	OutputIsoFile dst;
+	dst.Create(dstfile, OUTPUTISO_XZ);
+
+	try
+	{
+		dst.WriteHeader(blockofs, src.GetBlockSize(), blocks);
+
+		u8 sector[CD_FRAMESIZE_RAW];
+		for (uint lsn = 0; lsn < blocks; lsn++)
+		{
+			if (src.ReadSync(sector, lsn) < 0)
+				throw Exception::BadStream(srcfile).SetDiagMsg(pxsFmt(L"Unable to read sector %u", lsn));
+
+			dst.WriteSector(sector, lsn);
+		}
+
+		dst.Finish();
+	}
+	catch (...)
+	{
+		// Don't leave a truncated image behind
+		dst.Close();
+		wxRemoveFile(dstfile);
+		throw;
+	}
+
+	dst.Close();
+	src.Close();
+
+	Console.WriteLn("isoFile: converted %s to %s (%u blocks)", WX_STR(srcfile), WX_STR(dstfile), blocks);
+}
@@ -0,0 +1,350 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+#include "AsyncFileReader.h"
+#include "CompressedFileReaderUtils.h"
+#include "XzFileReader.h"
+
+static const u8 XZ_MAGIC[6] = {0xFD, '7', 'z', 'X', 'Z', 0x00};
+
+XzFileReader::XzFileReader(void)
+	: m_src(NULL)
+	, m_index(NULL)
+	, m_totalSize(0)
+	, m_readBufferSize(0)
+	, m_blockBufferSize(0)
+	, m_blockStart(0)
+	, m_blockSize(0)
+	, m_blockValid(false)
+	, m_bytesRead(0)
+{
+	m_blocksize = 2048;
+}
+
+bool XzFileReader::CanHandle(const wxString& fileName)
+{
+	bool supported = false;
+	if (wxFileName::FileExists(fileName) && fileName.Lower().EndsWith(L".xz"))
+	{
+		FILE* fp = PX_fopen_rb(fileName);
+		u8 magic[sizeof(XZ_MAGIC)];
+		if (fp)
+		{
+			if (fread(magic, 1, sizeof(magic), fp) == sizeof(magic))
+			{
+				supported = memcmp(magic, XZ_MAGIC, sizeof(magic)) == 0;
+			}
+			fclose(fp);
+		}
+	}
+	return supported;
+}
+
+bool XzFileReader::Open(const wxString& fileName)
+{
+	Close();
+	m_filename = fileName;
+	m_src = PX_fopen_rb(m_filename);
+
+	if (!m_src || !ReadIndex())
+	{
+		Close();
+		return false;
+	}
+
+	m_totalSize = lzma_index_uncompressed_size(m_index);
+
+	// A single huge block means every read decodes from the start of the image.
+	lzma_index_iter iter;
+	lzma_index_iter_init(&iter, m_index);
+	while (!lzma_index_iter_next(&iter, LZMA_INDEX_ITER_BLOCK))
+	{
+		if (iter.block.uncompressed_size > XZFILE_MAX_BLOCK_SIZE)
+		{
+			Console.Error(L"xz image has blocks larger than %u MB, recompress it with a smaller block size (xz --block-size).",
+						  (uint)(XZFILE_MAX_BLOCK_SIZE / _1mb));
+			Close();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Decodes the index of every stream in the file, walking backwards from the
+// last stream footer the same way `xz --list` does.
+bool XzFileReader::ReadIndex()
+{
+	if (PX_fseeko(m_src, 0, SEEK_END) != 0)
+		return false;
+
+	PX_off_t pos = PX_ftello(m_src);
+	if (pos < 2 * LZMA_STREAM_HEADER_SIZE)
+		return false;
+
+	lzma_index* combined = NULL;
+	bool success = true;
+
+	while (success && pos > 0)
+	{
+		u8 footer[LZMA_STREAM_HEADER_SIZE];
+		u8 header[LZMA_STREAM_HEADER_SIZE];
+		lzma_stream_flags footer_flags;
+		lzma_stream_flags header_flags;
+
+		// Skip stream padding, which comes in multiples of four null bytes.
+		u64 padding = 0;
+		while (true)
+		{
+			if (pos < LZMA_STREAM_HEADER_SIZE || PX_fseeko(m_src, pos - 4, SEEK_SET) != 0)
+			{
+				success = false;
+				break;
+			}
+
+			u32 word;
+			if (fread(&word, 1, 4, m_src) != 4)
+			{
+				success = false;
+				break;
+			}
+			if (word != 0)
+				break;
+
+			pos -= 4;
+			padding += 4;
+		}
+		if (!success)
+			break;
+
+		pos -= LZMA_STREAM_HEADER_SIZE;
+		if (PX_fseeko(m_src, pos, SEEK_SET) != 0 || fread(footer, 1, sizeof(footer), m_src) != sizeof(footer) ||
+			lzma_stream_footer_decode(&footer_flags, footer) != LZMA_OK)
+		{
+			Console.Error(L"Unable to read xz stream footer.");
+			success = false;
+			break;
+		}
+
+		const u64 indexSize = footer_flags.backward_size;
+		if ((u64)pos < indexSize + LZMA_STREAM_HEADER_SIZE)
+		{
+			success = false;
+			break;
+		}
+		pos -= indexSize;
+
+		std::unique_ptr<u8[]> indexData(new u8[indexSize]);
+		if (PX_fseeko(m_src, pos, SEEK_SET) != 0 || fread(indexData.get(), 1, indexSize, m_src) != indexSize)
+		{
+			Console.Error(L"Unable to read xz index.");
+			success = false;
+			break;
+		}
+
+		lzma_index* index = NULL;
+		u64 memlimit = UINT64_MAX;
+		size_t inPos = 0;
+		if (lzma_index_buffer_decode(&index, &memlimit, NULL, indexData.get(), &inPos, indexSize) != LZMA_OK)
+		{
+			Console.Error(L"Unable to decode xz index.");
+			success = false;
+			break;
+		}
+
+		// Locate the matching stream header from the size the index records.
+		const u64 streamSize = lzma_index_stream_size(index);
+		const PX_off_t streamStart = pos + indexSize + LZMA_STREAM_HEADER_SIZE - streamSize;
+		if (streamStart < 0 || PX_fseeko(m_src, streamStart, SEEK_SET) != 0 ||
+			fread(header, 1, sizeof(header), m_src) != sizeof(header) ||
+			lzma_stream_header_decode(&header_flags, header) != LZMA_OK ||
+			lzma_stream_flags_compare(&header_flags, &footer_flags) != LZMA_OK)
+		{
+			Console.Error(L"xz stream header does not match its footer.");
+			lzma_index_end(index, NULL);
+			success = false;
+			break;
+		}
+
+		lzma_index_stream_flags(index, &footer_flags);
+		lzma_index_stream_padding(index, padding);
+
+		if (combined && lzma_index_cat(index, combined, NULL) != LZMA_OK)
+		{
+			lzma_index_end(index, NULL);
+			success = false;
+			break;
+		}
+
+		combined = index;
+		pos = streamStart;
+	}
+
+	if (!success)
+	{
+		if (combined)
+			lzma_index_end(combined, NULL);
+		return false;
+	}
+
+	m_index = combined;
+	return true;
+}
+
+bool XzFileReader::DecodeBlock(const lzma_index_iter& iter)
+{
+	const u64 compressedSize = iter.block.total_size;
+	const u64 uncompressedSize = iter.block.uncompressed_size;
+
+	if (m_readBufferSize < compressedSize)
+	{
+		m_readBuffer.reset(new u8[compressedSize]);
+		m_readBufferSize = compressedSize;
+	}
+	if (m_blockBufferSize < uncompressedSize)
+	{
+		m_blockBuffer.reset(new u8[uncompressedSize]);
+		m_blockBufferSize = uncompressedSize;
+	}
+
+	m_blockValid = false;
+
+	if (PX_fseeko(m_src, iter.block.compressed_file_offset, SEEK_SET) != 0 ||
+		fread(m_readBuffer.get(), 1, compressedSize, m_src) != compressedSize)
+	{
+		Console.Error("Unable to read xz block.");
+		return false;
+	}
+
+	lzma_filter filters[LZMA_FILTERS_MAX + 1];
+	lzma_block block = {};
+	block.version = 0;
+	block.check = iter.stream.flags->check;
+	block.filters = filters;
+	block.header_size = lzma_block_header_size_decode(m_readBuffer[0]);
+
+	if (block.header_size > compressedSize || lzma_block_header_decode(&block, NULL, m_readBuffer.get()) != LZMA_OK)
+	{
+		Console.Error("Unable to decode xz block header.");
+		return false;
+	}
+
+	size_t inPos = block.header_size;
+	size_t outPos = 0;
+	lzma_ret ret = lzma_block_compressed_size(&block, iter.block.unpadded_size);
+	if (ret == LZMA_OK)
+		ret = lzma_block_buffer_decode(&block, NULL, m_readBuffer.get(), &inPos, compressedSize,
+									   m_blockBuffer.get(), &outPos, uncompressedSize);
+
+	for (int i = 0; filters[i].id != LZMA_VLI_UNKNOWN; i++)
+		free(filters[i].options);
+
+	if (ret != LZMA_OK || outPos != uncompressedSize)
+	{
+		Console.Error("Unable to decompress xz block.");
+		return false;
+	}
+
+	m_blockStart = iter.block.uncompressed_file_offset;
+	m_blockSize = uncompressedSize;
+	m_blockValid = true;
+	return true;
+}
+
+int XzFileReader::ReadFromBlock(u8* dest, u64 pos, int maxBytes)
+{
+	if (pos >= m_totalSize)
+	{
+		// Can't read anything passed the end.
+		return 0;
+	}
+
+	if (!m_blockValid || pos < m_blockStart || pos >= m_blockStart + m_blockSize)
+	{
+		lzma_index_iter iter;
+		lzma_index_iter_init(&iter, m_index);
+		if (lzma_index_iter_locate(&iter, pos) || !DecodeBlock(iter))
+			return 0;
+	}
+
+	const int bytes = (int)std::min<u64>(maxBytes, m_blockStart + m_blockSize - pos);
+	memcpy(dest, m_blockBuffer.get() + (pos - m_blockStart), bytes);
+	return bytes;
+}
+
+int XzFileReader::ReadSync(void* pBuffer, uint sector, uint count)
+{
+	if (!m_src)
+	{
+		return 0;
+	}
+
+	u8* dest = (u8*)pBuffer;
+	u64 pos = (u64)sector * (u64)m_blocksize + m_dataoffset;
+	int remaining = count * m_blocksize;
+	int bytes = 0;
+
+	while (remaining > 0)
+	{
+		int readBytes = ReadFromBlock(dest + bytes, pos + bytes, remaining);
+		if (readBytes == 0)
+		{
+			// We hit EOF.
+			break;
+		}
+
+		bytes += readBytes;
+		remaining -= readBytes;
+	}
+
+	return bytes;
+}
+
+void XzFileReader::BeginRead(void* pBuffer, uint sector, uint count)
+{
+	// TODO: No async support yet, implement as sync.
+	m_bytesRead = ReadSync(pBuffer, sector, count);
+}
+
+int XzFileReader::FinishRead()
+{
+	int res = m_bytesRead;
+	m_bytesRead = -1;
+	return res;
+}
+
+void XzFileReader::Close()
+{
+	m_filename.Empty();
+
+	if (m_src)
+	{
+		fclose(m_src);
+		m_src = NULL;
+	}
+	if (m_index)
+	{
+		lzma_index_end(m_index, NULL);
+		m_index = NULL;
+	}
+
+	m_readBuffer.reset();
+	m_readBufferSize = 0;
+	m_blockBuffer.reset();
+	m_blockBufferSize = 0;
+	m_blockValid = false;
+	m_totalSize = 0;
+}
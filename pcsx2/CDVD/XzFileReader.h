@@ -0,0 +1,76 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "AsyncFileReader.h"
+#include <lzma.h>
+
+// Largest decoded xz block we are willing to hold in memory.
+static const u64 XZFILE_MAX_BLOCK_SIZE = 64 * 1024 * 1024;
+
+// Reads ISO images stored as multi-block .xz streams (xz --block-size, or
+// ConvertIsoToXz). The index at the end of every xz stream maps uncompressed
+// offsets to blocks, so a random read only decodes the block containing it
+// and no index has to be built on first open.
+class XzFileReader : public AsyncFileReader
+{
+	DeclareNoncopyableObject(XzFileReader);
+
+public:
+	XzFileReader(void);
+
+	virtual ~XzFileReader(void) { Close(); };
+
+	static bool CanHandle(const wxString& fileName);
+	virtual bool Open(const wxString& fileName);
+
+	virtual int ReadSync(void* pBuffer, uint sector, uint count);
+
+	virtual void BeginRead(void* pBuffer, uint sector, uint count);
+	virtual int FinishRead(void);
+	virtual void CancelRead(void){};
+
+	virtual void Close(void);
+
+	virtual uint GetBlockCount(void) const
+	{
+		return (m_totalSize - m_dataoffset) / m_blocksize;
+	};
+
+	virtual void SetBlockSize(uint bytes) { m_blocksize = bytes; }
+	virtual void SetDataOffset(int bytes) { m_dataoffset = bytes; }
+
+private:
+	bool ReadIndex();
+	bool DecodeBlock(const lzma_index_iter& iter);
+	int ReadFromBlock(u8* dest, u64 pos, int maxBytes);
+
+	FILE* m_src;
+	lzma_index* m_index;
+	u64 m_totalSize;
+
+	// Compressed input and decoded output of the most recently used block
+	std::unique_ptr<u8[]> m_readBuffer;
+	u64 m_readBufferSize;
+	std::unique_ptr<u8[]> m_blockBuffer;
+	u64 m_blockBufferSize;
+	u64 m_blockStart;
+	u64 m_blockSize;
+	bool m_blockValid;
+
+	// The result of a read is stored here between BeginRead() and FinishRead().
+	int m_bytesRead;
+};
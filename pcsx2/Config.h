@@ -239,6 +239,8 @@ struct Pcsx2Config
 				PreBlockCheckIOP:1;
 			bool
 				EnableEECache   :1;
+			bool
+				EnableVUCache   :1;		// Remember the microprograms of each game and recompile them at boot
 		BITFIELD_END
 
 		RecompilerOptions();
@@ -289,6 +291,8 @@ struct Pcsx2Config
 		bool	SynchronousMTGS;
 
 		int		VsyncQueueSize;
+		bool	VsyncQueueAdaptive;	// Adapt the queue size to the GS load, within VsyncQueueLatency (unless VsyncQueueSize is 0)
+		int		VsyncQueueLatency;	// Latency budget of the queued frames, in milliseconds
 
 		bool		FrameLimitEnable;
 		bool		FrameSkipEnable;
@@ -311,6 +315,8 @@ struct Pcsx2Config
 			return
 				OpEqu( SynchronousMTGS )		&&
 				OpEqu( VsyncQueueSize )			&&
+				OpEqu( VsyncQueueAdaptive )		&&
+				OpEqu( VsyncQueueLatency )		&&
 				
 				OpEqu( FrameSkipEnable )		&&
 				OpEqu( FrameLimitEnable )		&&
@@ -440,6 +446,34 @@ struct Pcsx2Config
 		}
 	};
 
+	// ------------------------------------------------------------------------
+	// Options for the in-memory rewind ring (see StateCopy_Rewind).  The newest snapshot
+	// is kept whole; older snapshots are kept as compressed deltas against the next one.
+	struct RewindOptions
+	{
+		BITFIELD32()
+			bool
+				Enabled		:1;		// captures snapshots while the VM runs
+		BITFIELD_END
+
+		u32 FrameInterval;			// frames between two snapshots
+		u32 MaxSnapshots;			// older snapshots kept in the ring
+		u32 MaxMemoryMb;			// memory budget of the older snapshots, in MB
+
+		RewindOptions();
+		void LoadSave( IniInterface& conf );
+
+		bool operator ==( const RewindOptions& right ) const
+		{
+			return OpEqu( bitset ) && OpEqu( FrameInterval ) && OpEqu( MaxSnapshots ) && OpEqu( MaxMemoryMb );
+		}
+
+		bool operator !=( const RewindOptions& right ) const
+		{
+			return !this->operator ==( right );
+		}
+	};
+
 	BITFIELD32()
 		bool
 			CdvdVerboseReads	:1,		// enables cdvd read activity verbosely dumped to the console
@@ -455,6 +489,8 @@ struct Pcsx2Config
 		// when enabled uses BOOT2 injection, skipping sony bios splashes
 			UseBOOT2Injection	:1,
 			BackupSavestate		:1,
+		// saves states as page deltas against the last full state saved or loaded
+			DeltaSavestates		:1,
 		// enables simulated ejection of memory cards when loading savestates
 			McdEnableEjection	:1,
 			McdFolderAutoManage	:1,
@@ -473,10 +509,12 @@ struct Pcsx2Config
 	GamefixOptions		Gamefixes;
 	ProfilerOptions		Profiler;
 	DebugOptions		Debugger;
+	RewindOptions		Rewind;
 
 	TraceLogFilters		Trace;
 
 	wxFileName			BiosFilename;
+	wxFileName			VUCacheFolder;		// Where EnableVUCache keeps its files, set by the host
 
 	Pcsx2Config();
 	void LoadSave( IniInterface& ini );
@@ -497,8 +535,10 @@ struct Pcsx2Config
 			OpEqu( Speedhacks )	&&
 			OpEqu( Gamefixes )	&&
 			OpEqu( Profiler )	&&
+			OpEqu( Rewind )		&&
 			OpEqu( Trace )		&&
-			OpEqu( BiosFilename );
+			OpEqu( BiosFilename )	&&
+			OpEqu( VUCacheFolder );
 	}
 
 	bool operator !=( const Pcsx2Config& right ) const
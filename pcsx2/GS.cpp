@@ -425,6 +425,7 @@ void gsPostVsyncStart()
 {
 	//gifUnit.FlushToMTGS();  // Needed for some (broken?) homebrew game loaders
 	
+	Gif_AdaptBuffers();
 	GetMTGS().PostVsyncStart();
 }
 
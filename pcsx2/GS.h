@@ -305,6 +305,26 @@ struct MTGS_FreezeData
 	s32			retval;		// value returned from the call, valid only after an mtgsWaitGS()
 };
 
+// --------------------------------------------------------------------------------------
+//  MTGS_FrameStats
+// --------------------------------------------------------------------------------------
+// Frame pacing telemetry of one vsync, times are in microseconds.  The EE fields are filled
+// when the EE posts the vsync, the GS fields when the MTGS thread processes it.
+struct MTGS_FrameStats
+{
+	u64 frame;       // Vsync number since the last GS reset
+	u32 eeTime;      // EE thread time since the previous vsync (excluding eeWait)
+	u32 eeWait;      // EE thread time blocked on the vsync queue limit
+	u32 gsTime;      // MTGS thread time since the previous vsync (excluding gsIdle)
+	u32 gsIdle;      // MTGS thread time spent waiting for work
+	u32 queueDepth;  // Frames already queued when the EE posted the vsync
+	u32 queueLimit;  // Vsync queue limit in effect for the frame
+	bool gsDone;     // GS fields are valid
+};
+
+// Number of frames kept for GetFrameStats()
+static const uint MTGS_FrameStatsCount = 256;
+
 // --------------------------------------------------------------------------------------
 //  SysMtgsThread
 // --------------------------------------------------------------------------------------
@@ -324,6 +344,7 @@ public:
 
 	std::atomic<int>	m_QueuedFrameCount;
 	std::atomic<bool>	m_VsyncSignalListener;
+	std::atomic<int>	m_VsyncQueueLimit;	// EmuConfig.GS.VsyncQueueSize, or the adaptive limit (see UpdateVsyncQueueLimit)
 
 	Mutex			m_mtx_RingBufferBusy;  // Is obtained while processing ring-buffer data
 	Mutex			m_mtx_RingBufferBusy2; // This one gets released on semaXGkick waiting...
@@ -349,6 +370,23 @@ public:
 	uint			m_packet_size;		// size of the packet (data only, ie. not including the 16 byte command!)
 	uint			m_packet_writepos;	// index of the data location in the ringbuffer.
 
+	// Frame pacing telemetry, the EE side is only used by the EE thread and the GS side
+	// by the MTGS thread.  m_FrameStats is shared and protected by m_mtx_FrameStats.
+	Mutex			m_mtx_FrameStats;
+	MTGS_FrameStats	m_FrameStats[MTGS_FrameStatsCount];
+	u64				m_eeVsyncCount;		// Vsyncs posted by the EE thread
+	u64				m_eeVsyncTick;		// Tick of the previous vsync posted by the EE thread
+	u64				m_eeWaitTick;		// EE ticks blocked on the queue limit during the previous frame
+	u64				m_gsVsyncCount;		// Vsyncs processed by the MTGS thread
+	u64				m_gsVsyncTick;		// Tick of the previous vsync processed by the MTGS thread
+	u64				m_gsIdleTick;		// MTGS ticks spent waiting for work during the current frame
+
+	// Adaptive vsync queue, accumulated over a window of frames
+	int				m_PacingFrames;		// Frames in the window
+	int				m_PacingEEWaits;	// Frames where the EE blocked on the queue limit
+	u64				m_PacingPeriod;		// Sum of the frame periods (ticks)
+	std::atomic<int> m_PacingGSIdle;	// Frames where the MTGS was waiting for work
+
 #ifdef RINGBUF_DEBUG_STACK
 	Threading::Mutex m_lock_Stack;
 #endif
@@ -376,6 +414,10 @@ public:
 	void SetEvent();
 	void PostVsyncStart();
 
+	// Copies the stats of the last count frames (oldest first), returns the number copied
+	size_t GetFrameStats(MTGS_FrameStats* dest, size_t count);
+	int GetVsyncQueueLimit() const { return m_VsyncQueueLimit.load(std::memory_order_relaxed); }
+
 	bool IsGSOpened() const { return m_Opened; }
 
 protected:
@@ -392,6 +434,10 @@ protected:
 
 	void GenericStall( uint size );
 
+	void ResetFrameStats();
+	void UpdateVsyncQueueLimit();
+	void PostFrameStatsInThread();
+
 	// Used internally by SendSimplePacket type functions
 	void _FinishSimplePacket();
 	void ExecuteTaskInThread();
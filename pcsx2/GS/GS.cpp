@@ -363,6 +363,64 @@ int _GSopen(void** dsp, const char* title, GSRendererType renderer, int threads
 	return 0;
 }
 
+// Opens the SW or Null renderer on a null device without any window, for batch replays.
+// Returns the renderer so the caller can read its perfmon and local memory.
+GSRenderer* _GSopenHeadless(GSRendererType renderer, int threads)
+{
+	if (renderer != GSRendererType::OGL_SW && renderer != GSRendererType::Null)
+	{
+		fprintf(stderr, "GS: renderer %d cannot run headless\n", static_cast<int>(renderer));
+		return nullptr;
+	}
+
+	if (threads == -1)
+	{
+		threads = theApp.GetConfigI("extrathreads");
+	}
+
+	try
+	{
+		delete s_gs;
+
+		s_gs = NULL;
+
+		theApp.SetCurrentRendererType(renderer);
+
+		if (renderer == GSRendererType::OGL_SW)
+		{
+			s_gs = new GSRendererSW(threads);
+			s_renderer_name = "SW";
+		}
+		else
+		{
+			s_gs = new GSRendererNull();
+			s_renderer_name = "NULL";
+		}
+
+		s_gs->m_wnd = std::make_shared<GSWndNull>(theApp.GetConfigI("ModeWidth"), theApp.GetConfigI("ModeHeight"));
+	}
+	catch (std::exception& ex)
+	{
+		printf("GS error: Exception caught in GSopen: %s", ex.what());
+		return nullptr;
+	}
+
+	s_gs->SetRegsMem(s_basemem);
+	s_gs->SetIrqCallback(s_irq);
+	s_gs->SetVSync(0);
+
+	if (!s_gs->CreateDevice(new GSDeviceNull()))
+	{
+		GSclose();
+
+		return nullptr;
+	}
+
+	gsopen_done = true;
+
+	return s_gs;
+}
+
 void GSosdLog(const char* utf8, uint32 color)
 {
 	if (s_gs && s_gs->m_dev)
@@ -1628,6 +1686,7 @@ void GSApp::Init()
 	m_default_configuration["force_texture_clear"]                        = "0";
 	m_default_configuration["fxaa"]                                       = "0";
 	m_default_configuration["interlace"]                                  = "7";
+	m_default_configuration["jit_cache"]                                  = "1";
 	m_default_configuration["conservative_framebuffer"]                   = "1";
 	m_default_configuration["linear_present"]                             = "1";
 	m_default_configuration["MaxAnisotropy"]                              = "0";
@@ -1784,6 +1843,15 @@ void GSApp::SetConfigDir()
 	m_ini = GetSettingsFolder().Combine(iniName).GetFullPath();
 }
 
+std::string GSApp::GetCacheDir(const char* name)
+{
+	wxDirName dir(GetSettingsFolder().Combine(wxDirName(name)));
+
+	dir.Mkdir();
+
+	return std::string(dir.GetPath(wxPATH_GET_VOLUME | wxPATH_GET_SEPARATOR).ToUTF8());
+}
+
 std::string GSApp::GetConfigS(const char* entry)
 {
 	char buff[4096] = {0};
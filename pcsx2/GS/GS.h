@@ -1810,6 +1810,7 @@ int GSinit();
 void GSshutdown();
 void GSclose();
 int _GSopen(void** dsp, const char* title, GSRendererType renderer, int threads);
+class GSRenderer* _GSopenHeadless(GSRendererType renderer, int threads);
 void GSosdLog(const char* utf8, uint32 color);
 void GSosdMonitor(const char* key, const char* value, uint32 color);
 int GSopen2(void** dsp, uint32 flags);
@@ -1865,6 +1866,9 @@ public:
 	void BuildConfigurationMap(const char* lpFileName);
 	void ReloadConfig();
 
+	// Folder next to GS.ini, created on demand, returned with a trailing separator
+	std::string GetCacheDir(const char* name);
+
 	size_t GetIniString(const char* lpAppName, const char* lpKeyName, const char* lpDefault, char* lpReturnedString, size_t nSize, const char* lpFileName);
 	bool WriteIniString(const char* lpAppName, const char* lpKeyName, const char* pString, const char* lpFileName);
 	int GetIniInt(const char* lpAppName, const char* lpKeyName, int nDefault, const char* lpFileName);
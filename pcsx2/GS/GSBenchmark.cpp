@@ -0,0 +1,484 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021 PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+#include "GSBenchmark.h"
+#include "GSLzma.h"
+#include "Renderers/Common/GSRenderer.h"
+
+#include <algorithm>
+#include <chrono>
+
+struct GSBenchmarkPacket
+{
+	uint8 type, param;
+	uint32 size, addr;
+	std::vector<uint8> buff;
+};
+
+struct GSBenchmarkFrame
+{
+	int loop, frame;
+	double wall_us;
+	uint64 main_ticks, sync_ticks, worker_ticks;
+	double draws, prims, swizzle, unswizzle, sync_points, fillrate;
+	uint32 hash;
+};
+
+struct GSBenchmarkDump
+{
+	uint32 crc;
+	std::vector<uint8> state;
+	std::vector<uint8> regs;
+	std::vector<GSBenchmarkPacket> packets;
+};
+
+static const int s_output_pitch = 1024 * 4;
+static const int s_output_height = 1024;
+
+// Same layout GSReplay reads, but everything is kept in memory up front so the
+// replay loop doesn't measure decompression.
+static bool LoadDump(const std::string& filename, GSBenchmarkDump& dump)
+{
+	const bool is_xz = filename.size() >= 3 && filename.compare(filename.size() - 3, 3, ".xz") == 0;
+
+	std::vector<char> name(filename.begin(), filename.end());
+	name.push_back(0);
+
+	try
+	{
+		std::unique_ptr<GSDumpFile> file;
+
+		if (is_xz)
+			file.reset(new GSDumpLzma(name.data(), nullptr));
+		else
+			file.reset(new GSDumpRaw(name.data(), nullptr));
+
+		uint32 size;
+
+		if (!file->Read(&dump.crc, 4) || !file->Read(&size, 4))
+			return false;
+
+		dump.state.resize(size);
+		dump.regs.resize(0x2000);
+
+		if (!file->Read(dump.state.data(), size) || !file->Read(dump.regs.data(), 0x2000))
+			return false;
+
+		uint8 type;
+
+		while (file->Read(&type, 1))
+		{
+			dump.packets.emplace_back();
+
+			GSBenchmarkPacket& p = dump.packets.back();
+
+			p.type = type;
+			p.param = 0;
+			p.size = 0;
+			p.addr = 0;
+
+			bool ok;
+
+			switch (type)
+			{
+				case 0:
+					ok = file->Read(&p.param, 1) && file->Read(&p.size, 4);
+
+					if (!ok)
+						break;
+
+					switch (p.param)
+					{
+						case 0:
+							ok = p.size <= 0x4000;
+
+							if (ok)
+							{
+								p.buff.resize(0x4000);
+								p.addr = 0x4000 - p.size;
+								ok = file->Read(p.buff.data() + p.addr, p.size);
+							}
+
+							break;
+						case 1:
+						case 2:
+						case 3:
+							p.buff.resize(p.size);
+							ok = file->Read(p.buff.data(), p.size);
+							break;
+					}
+
+					break;
+
+				case 1:
+					ok = file->Read(&p.param, 1);
+					break;
+
+				case 2:
+					ok = file->Read(&p.size, 4);
+					break;
+
+				case 3:
+					p.buff.resize(0x2000);
+					ok = file->Read(p.buff.data(), 0x2000);
+					break;
+
+				default:
+					ok = false;
+					break;
+			}
+
+			// A partial dump would benchmark something else than what was recorded
+			if (!ok)
+			{
+				fprintf(stderr, "GS benchmark: %s is truncated or corrupted at packet %zu\n", filename.c_str(), dump.packets.size() - 1);
+				return false;
+			}
+		}
+	}
+	catch (...)
+	{
+		// GSDumpFile already printed the reason
+		return false;
+	}
+
+	return true;
+}
+
+// crc32 of the enabled read circuits, read back the same way GSRendererSW::GetOutput does
+static uint32 HashOutput(GSRenderer* gs, uint8* buff)
+{
+	uint32 hash = crc32(0L, Z_NULL, 0);
+
+	for (int i = 0; i < 2; i++)
+	{
+		if (!gs->IsEnabled(i))
+			continue;
+
+		const GSRegDISPFB& DISPFB = gs->m_regs->DISP[i].DISPFB;
+		const GSLocalMemory::psm_t& psm = GSLocalMemory::m_psm[DISPFB.PSM];
+
+		int w = std::min<int>(DISPFB.FBW * 64, s_output_pitch / 4);
+		int h = std::min<int>(gs->GetFramebufferHeight(), s_output_height);
+
+		if (w <= 0 || h <= 0)
+			continue;
+
+		GSVector4i r(0, 0, w, h);
+
+		(gs->m_mem.*psm.rtx)(gs->m_mem.GetOffset(DISPFB.Block(), DISPFB.FBW, DISPFB.PSM), r.ralign<Align_Outside>(psm.bs), buff, s_output_pitch, gs->m_env.TEXA);
+
+		for (int y = 0; y < h; y++)
+		{
+			hash = crc32(hash, buff + y * s_output_pitch, w * 4);
+		}
+	}
+
+	return hash;
+}
+
+static std::string EscapeJson(const std::string& s)
+{
+	std::string out;
+
+	for (char c : s)
+	{
+		if (c == '"' || c == '\\')
+		{
+			out += '\\';
+			out += c;
+		}
+		else if ((unsigned char)c < 0x20)
+		{
+			char buf[8];
+			snprintf(buf, sizeof(buf), "\\u%04x", (unsigned char)c);
+			out += buf;
+		}
+		else
+		{
+			out += c;
+		}
+	}
+
+	return out;
+}
+
+static bool WriteReport(const GSBenchmarkOptions& options, const char* renderer, const std::vector<GSBenchmarkFrame>& frames)
+{
+	const std::string& fn = options.report;
+	const bool json = fn.size() >= 5 && fn.compare(fn.size() - 5, 5, ".json") == 0;
+
+	FILE* fp = fopen(fn.c_str(), "w");
+
+	if (fp == nullptr)
+	{
+		fprintf(stderr, "GS benchmark: failed to open %s\n", fn.c_str());
+		return false;
+	}
+
+	if (json)
+	{
+		fprintf(fp, "{\n\t\"dump\": \"%s\",\n\t\"renderer\": \"%s\",\n\t\"threads\": %d,\n\t\"loops\": %d,\n\t\"frames\": [\n",
+			EscapeJson(options.dump).c_str(), renderer, options.threads, options.loops);
+
+		for (size_t i = 0; i < frames.size(); i++)
+		{
+			const GSBenchmarkFrame& f = frames[i];
+
+			fprintf(fp, "\t\t{\"loop\": %d, \"frame\": %d, \"wall_us\": %.1f, \"main_cycles\": %llu, \"sync_cycles\": %llu, \"worker_cycles\": %llu, "
+						"\"draws\": %.0f, \"prims\": %.0f, \"swizzle_bytes\": %.0f, \"unswizzle_bytes\": %.0f, \"sync_points\": %.0f, \"fillrate\": %.0f",
+				f.loop, f.frame, f.wall_us, (unsigned long long)f.main_ticks, (unsigned long long)f.sync_ticks, (unsigned long long)f.worker_ticks,
+				f.draws, f.prims, f.swizzle, f.unswizzle, f.sync_points, f.fillrate);
+
+			if (options.hash)
+				fprintf(fp, ", \"hash\": \"%08x\"", f.hash);
+
+			fprintf(fp, "}%s\n", i + 1 < frames.size() ? "," : "");
+		}
+
+		fprintf(fp, "\t]\n}\n");
+	}
+	else
+	{
+		fprintf(fp, "loop,frame,wall_us,main_cycles,sync_cycles,worker_cycles,draws,prims,swizzle_bytes,unswizzle_bytes,sync_points,fillrate%s\n",
+			options.hash ? ",hash" : "");
+
+		for (const GSBenchmarkFrame& f : frames)
+		{
+			fprintf(fp, "%d,%d,%.1f,%llu,%llu,%llu,%.0f,%.0f,%.0f,%.0f,%.0f,%.0f",
+				f.loop, f.frame, f.wall_us, (unsigned long long)f.main_ticks, (unsigned long long)f.sync_ticks, (unsigned long long)f.worker_ticks,
+				f.draws, f.prims, f.swizzle, f.unswizzle, f.sync_points, f.fillrate);
+
+			if (options.hash)
+				fprintf(fp, ",%08x", f.hash);
+
+			fprintf(fp, "\n");
+		}
+	}
+
+	fclose(fp);
+
+	return true;
+}
+
+int GSBenchmark(const GSBenchmarkOptions& options)
+{
+	GSBenchmarkDump dump;
+
+	if (!LoadDump(options.dump, dump))
+	{
+		fprintf(stderr, "GS benchmark: failed to load %s\n", options.dump.c_str());
+		return 1;
+	}
+
+	if (GSinit() != 0)
+	{
+		fprintf(stderr, "GS benchmark: GSinit failed\n");
+		return 1;
+	}
+
+	uint8* regs = (uint8*)_aligned_malloc(0x2000, 32);
+	uint8* output = (uint8*)_aligned_malloc(s_output_pitch * s_output_height, 32);
+
+	memcpy(regs, dump.regs.data(), 0x2000);
+
+	GSsetBaseMem(regs);
+
+	GSRenderer* gs = _GSopenHeadless(options.renderer, options.threads);
+
+	if (gs == nullptr)
+	{
+		fprintf(stderr, "GS benchmark: failed to open the renderer\n");
+
+		GSshutdown();
+
+		_aligned_free(output);
+		_aligned_free(regs);
+
+		return 1;
+	}
+
+	const char* renderer = options.renderer == GSRendererType::Null ? "Null" : "SW";
+
+	GSsetGameCRC(dump.crc, 0);
+
+	std::vector<GSBenchmarkFrame> frames;
+	std::vector<uint8> fifo;
+
+	for (int loop = 0; loop < options.loops; loop++)
+	{
+		// Restart from the dump's initial state so every loop renders the same frames
+
+		freezeData fd;
+		fd.size = (int)dump.state.size();
+		fd.data = (s8*)dump.state.data();
+
+		GSfreeze(FREEZE_LOAD, &fd);
+
+		memcpy(regs, dump.regs.data(), 0x2000);
+
+		GSvsync(1);
+
+		GSPerfMon& pm = gs->m_perfmon;
+
+		auto start = std::chrono::steady_clock::now();
+
+		uint64 main = pm.GetTicks(GSPerfMon::Main);
+		uint64 sync = pm.GetTicks(GSPerfMon::Sync);
+		uint64 worker = 0;
+		double counters[GSPerfMon::CounterLast];
+
+		for (int i = 0; i < 16; i++)
+			worker += pm.GetTicks(GSPerfMon::WorkerDraw0 + i);
+
+		for (int i = 0; i < GSPerfMon::CounterLast; i++)
+			counters[i] = pm.GetTotal((GSPerfMon::counter_t)i);
+
+		int frame = 0;
+
+		for (GSBenchmarkPacket& p : dump.packets)
+		{
+			switch (p.type)
+			{
+				case 0:
+					switch (p.param)
+					{
+						case 0: GSgifTransfer1(p.buff.data(), p.addr); break;
+						case 1: GSgifTransfer2(p.buff.data(), p.size / 16); break;
+						case 2: GSgifTransfer3(p.buff.data(), p.size / 16); break;
+						case 3: GSgifTransfer(p.buff.data(), p.size / 16); break;
+					}
+					break;
+
+				case 1:
+				{
+					GSvsync(p.param);
+
+					auto now = std::chrono::steady_clock::now();
+
+					GSBenchmarkFrame f;
+
+					f.loop = loop;
+					f.frame = frame++;
+					f.wall_us = std::chrono::duration<double, std::micro>(now - start).count();
+
+					uint64 t = 0;
+
+					for (int i = 0; i < 16; i++)
+						t += pm.GetTicks(GSPerfMon::WorkerDraw0 + i);
+
+					f.main_ticks = pm.GetTicks(GSPerfMon::Main) - main;
+					f.sync_ticks = pm.GetTicks(GSPerfMon::Sync) - sync;
+					f.worker_ticks = t - worker;
+
+					main += f.main_ticks;
+					sync += f.sync_ticks;
+					worker = t;
+
+					double c[GSPerfMon::CounterLast];
+
+					for (int i = 0; i < GSPerfMon::CounterLast; i++)
+					{
+						c[i] = pm.GetTotal((GSPerfMon::counter_t)i) - counters[i];
+						counters[i] += c[i];
+					}
+
+					f.draws = c[GSPerfMon::Draw];
+					f.prims = c[GSPerfMon::Prim];
+					f.swizzle = c[GSPerfMon::Swizzle];
+					f.unswizzle = c[GSPerfMon::Unswizzle];
+					f.sync_points = c[GSPerfMon::SyncPoint];
+					f.fillrate = c[GSPerfMon::Fillrate];
+					f.hash = options.hash ? HashOutput(gs, output) : 0;
+
+					frames.push_back(f);
+
+					// hashing isn't part of the frame time
+					start = std::chrono::steady_clock::now();
+
+					break;
+				}
+
+				case 2:
+					if (fifo.size() < p.size)
+						fifo.resize(p.size);
+
+					GSreadFIFO2(fifo.data(), p.size / 16);
+					break;
+
+				case 3:
+					memcpy(regs, p.buff.data(), 0x2000);
+					break;
+			}
+		}
+	}
+
+	GSclose();
+	GSshutdown();
+
+	_aligned_free(output);
+	_aligned_free(regs);
+
+	// Summary
+
+	int result = 0;
+
+	std::vector<double> times;
+
+	for (const GSBenchmarkFrame& f : frames)
+		times.push_back(f.wall_us);
+
+	if (!times.empty())
+	{
+		double total = 0;
+
+		for (double t : times)
+			total += t;
+
+		std::sort(times.begin(), times.end());
+
+		printf("GS benchmark: %s, %s, %zu frames, %.3f s, %.2f fps, frame ms avg %.3f min %.3f max %.3f p99 %.3f\n",
+			options.dump.c_str(), renderer, times.size(), total / 1e6, times.size() * 1e6 / total,
+			total / times.size() / 1e3, times.front() / 1e3, times.back() / 1e3, times[(times.size() - 1) * 99 / 100] / 1e3);
+	}
+	else
+	{
+		printf("GS benchmark: %s has no frames\n", options.dump.c_str());
+	}
+
+	if (options.hash && options.loops > 1)
+	{
+		size_t per_loop = frames.size() / options.loops;
+		size_t mismatches = 0;
+
+		for (size_t i = per_loop; i < frames.size(); i++)
+		{
+			if (frames[i].hash != frames[i % per_loop].hash)
+				mismatches++;
+		}
+
+		if (mismatches > 0)
+		{
+			fprintf(stderr, "GS benchmark: %zu frame hashes differ between loops\n", mismatches);
+			result = 2;
+		}
+	}
+
+	if (!options.report.empty() && !WriteReport(options, renderer, frames))
+		result = 1;
+
+	return result;
+}
@@ -0,0 +1,33 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021 PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "GS.h"
+
+struct GSBenchmarkOptions
+{
+	std::string dump;   // .gs or .gs.xz file
+	std::string report; // per frame report, JSON when the name ends with .json, CSV otherwise
+	GSRendererType renderer = GSRendererType::OGL_SW; // OGL_SW or Null
+	int threads = -1;   // SW rasterizer threads, -1 uses the GS.ini setting
+	int loops = 1;
+	bool hash = false;  // crc32 of the displayed framebuffers after each vsync
+};
+
+// Replays a GS dump on a null device without any window and reports per frame timings.
+// Returns 0 on success, 1 when the dump or the renderer couldn't be opened and 2 when
+// the frame hashes differ between loops.
+int GSBenchmark(const GSBenchmarkOptions& options);
@@ -27,6 +27,8 @@ GSDumpBase::GSDumpBase(const std::string& fn)
 
 GSDumpBase::~GSDumpBase()
 {
+	ASSERT(!m_queue);
+
 	if (m_gs)
 		fclose(m_gs);
 }
@@ -87,6 +89,55 @@ void GSDumpBase::Write(const void* data, size_t size)
 		fprintf(stderr, "GSDump: Error failed to write data\n");
 }
 
+void GSDumpBase::AppendRawData(const void* data, size_t size)
+{
+	if (!m_gs)
+		return;
+
+	if (!m_buff)
+	{
+		m_buff = std::make_shared<std::vector<uint8>>();
+		m_buff->reserve(CHUNK_SIZE);
+	}
+
+	const uint8* src = static_cast<const uint8*>(data);
+
+	m_buff->insert(m_buff->end(), src, src + size);
+
+	if (m_buff->size() >= CHUNK_SIZE)
+		Flush();
+}
+
+void GSDumpBase::AppendRawData(uint8 c)
+{
+	AppendRawData(&c, 1);
+}
+
+void GSDumpBase::Flush()
+{
+	if (!m_buff || m_buff->empty())
+		return;
+
+	if (!m_queue)
+	{
+		m_queue = std::unique_ptr<GSJobQueue<Chunk, 16>>(new GSJobQueue<Chunk, 16>([this](Chunk& item) {
+			Encode(item->data(), item->size());
+		}));
+	}
+
+	m_queue->Push(m_buff);
+
+	m_buff.reset();
+}
+
+void GSDumpBase::Close()
+{
+	Flush();
+
+	// Drains the queue and joins the thread
+	m_queue.reset();
+}
+
 //////////////////////////////////////////////////////////////////////
 // GSDump implementation
 //////////////////////////////////////////////////////////////////////
@@ -97,14 +148,14 @@ GSDump::GSDump(const std::string& fn, uint32 crc, const freezeData& fd, const GS
 	AddHeader(crc, fd, regs);
 }
 
-void GSDump::AppendRawData(const void* data, size_t size)
+GSDump::~GSDump()
 {
-	Write(data, size);
+	Close();
 }
 
-void GSDump::AppendRawData(uint8 c)
+void GSDump::Encode(const uint8* data, size_t size)
 {
-	Write(&c, 1);
+	Write(data, size);
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -113,9 +164,22 @@ void GSDump::AppendRawData(uint8 c)
 
 GSDumpXz::GSDumpXz(const std::string& fn, uint32 crc, const freezeData& fd, const GSPrivRegSet* regs)
 	: GSDumpBase(fn + ".gs.xz")
+	, m_out_buff(1024 * 1024)
 {
 	m_strm = LZMA_STREAM_INIT;
+
+#if LZMA_VERSION >= 50020002
+	// Leave some cores to the emulation, and keep the encoder memory reasonable
+	// (each thread buffers about 3 dictionaries).
+	lzma_mt mt = {};
+	mt.threads = std::min(std::max(std::thread::hardware_concurrency() / 2, 1u), 4u);
+	mt.preset = 6;
+	mt.check = LZMA_CHECK_CRC64;
+
+	lzma_ret ret = lzma_stream_encoder_mt(&m_strm, &mt);
+#else
 	lzma_ret ret = lzma_easy_encoder(&m_strm, 6 /*level*/, LZMA_CHECK_CRC64);
+#endif
 	if (ret != LZMA_OK)
 	{
 		fprintf(stderr, "GSDumpXz: Error initializing LZMA encoder ! (error code %u)\n", ret);
@@ -127,65 +191,47 @@ GSDumpXz::GSDumpXz(const std::string& fn, uint32 crc, const freezeData& fd, cons
 
 GSDumpXz::~GSDumpXz()
 {
-	Flush();
+	Close();
 
 	// Finish the stream
 	m_strm.avail_in = 0;
-	Compress(LZMA_FINISH, LZMA_STREAM_END);
+	Compress(LZMA_FINISH);
 
 	lzma_end(&m_strm);
 }
 
-void GSDumpXz::AppendRawData(const void* data, size_t size)
+void GSDumpXz::Encode(const uint8* data, size_t size)
 {
-	size_t old_size = m_in_buff.size();
-	m_in_buff.resize(old_size + size);
-	memcpy(&m_in_buff[old_size], data, size);
+	m_strm.next_in = data;
+	m_strm.avail_in = size;
 
-	// Enough data was accumulated, time to write/compress it.  If compression
-	// is enabled, it will freeze PCSX2. 1GB should be enough for long dump.
-	//
-	// Note: long dumps are currently not supported so this path won't be executed
-	if (m_in_buff.size() > 1024 * 1024 * 1024)
-		Flush();
+	Compress(LZMA_RUN);
 }
 
-void GSDumpXz::AppendRawData(uint8 c)
+void GSDumpXz::Compress(lzma_action action)
 {
-	m_in_buff.push_back(c);
-}
-
-void GSDumpXz::Flush()
-{
-	if (m_in_buff.empty())
-		return;
-
-	m_strm.next_in = m_in_buff.data();
-	m_strm.avail_in = m_in_buff.size();
-
-	Compress(LZMA_RUN, LZMA_OK);
-
-	m_in_buff.clear();
-}
-
-void GSDumpXz::Compress(lzma_action action, lzma_ret expected_status)
-{
-	std::vector<uint8> out_buff(1024 * 1024);
-	do
+	while (true)
 	{
-		m_strm.next_out = out_buff.data();
-		m_strm.avail_out = out_buff.size();
+		m_strm.next_out = m_out_buff.data();
+		m_strm.avail_out = m_out_buff.size();
 
 		lzma_ret ret = lzma_code(&m_strm, action);
 
-		if (ret != expected_status)
+		if (ret != LZMA_OK && ret != LZMA_STREAM_END)
 		{
 			fprintf(stderr, "GSDumpXz: Error %d\n", (int)ret);
 			return;
 		}
 
-		size_t write_size = out_buff.size() - m_strm.avail_out;
-		Write(out_buff.data(), write_size);
+		size_t write_size = m_out_buff.size() - m_strm.avail_out;
+		Write(m_out_buff.data(), write_size);
+
+		// The threaded encoder can return with input left and room in the output
+		// buffer, so keep going until everything was consumed (or the stream ended).
+		if (ret == LZMA_STREAM_END)
+			return;
 
-	} while (m_strm.avail_out == 0);
+		if (action == LZMA_RUN && m_strm.avail_in == 0 && m_strm.avail_out != 0)
+			return;
+	}
 }
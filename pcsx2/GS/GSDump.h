@@ -16,6 +16,7 @@
 #pragma once
 
 #include "GS.h"
+#include "GSThread_CXX11.h"
 #include "Renderers/SW/GSVertexSW.h"
 #include <lzma.h>
 
@@ -40,16 +41,40 @@ Regs data (id == 3)
 
 class GSDumpBase
 {
+public:
+	using Chunk = std::shared_ptr<std::vector<uint8>>;
+
+private:
+	enum : size_t
+	{
+		CHUNK_SIZE = 4 * 1024 * 1024,
+	};
+
 	int m_frames;
 	int m_extra_frames;
 	FILE* m_gs;
 
+	// The GS thread only appends to m_buff, full chunks are written (and compressed)
+	// by the dump thread.  The queue is bounded so a slow disk throttles the GS thread
+	// instead of eating all the memory.
+	Chunk m_buff;
+	std::unique_ptr<GSJobQueue<Chunk, 16>> m_queue;
+
+	void Flush();
+
 protected:
 	void AddHeader(uint32 crc, const freezeData& fd, const GSPrivRegSet* regs);
 	void Write(const void* data, size_t size);
 
-	virtual void AppendRawData(const void* data, size_t size) = 0;
-	virtual void AppendRawData(uint8 c) = 0;
+	void AppendRawData(const void* data, size_t size);
+	void AppendRawData(uint8 c);
+
+	// Runs on the dump thread, in the order the data was appended
+	virtual void Encode(const uint8* data, size_t size) = 0;
+
+	// Writes the pending data and stops the dump thread, the derived
+	// destructors must call it before releasing what Encode uses.
+	void Close();
 
 public:
 	GSDumpBase(const std::string& fn);
@@ -62,24 +87,21 @@ public:
 
 class GSDump final : public GSDumpBase
 {
-	void AppendRawData(const void* data, size_t size) final;
-	void AppendRawData(uint8 c) final;
+	void Encode(const uint8* data, size_t size) final;
 
 public:
 	GSDump(const std::string& fn, uint32 crc, const freezeData& fd, const GSPrivRegSet* regs);
-	virtual ~GSDump() = default;
+	virtual ~GSDump();
 };
 
 class GSDumpXz final : public GSDumpBase
 {
 	lzma_stream m_strm;
 
-	std::vector<uint8> m_in_buff;
+	std::vector<uint8> m_out_buff;
 
-	void Flush();
-	void Compress(lzma_action action, lzma_ret expected_status);
-	void AppendRawData(const void* data, size_t size);
-	void AppendRawData(uint8 c);
+	void Compress(lzma_action action);
+	void Encode(const uint8* data, size_t size) final;
 
 public:
 	GSDumpXz(const std::string& fn, uint32 crc, const freezeData& fd, const GSPrivRegSet* regs);
@@ -55,6 +55,10 @@ GSDumpFile::~GSDumpFile()
 /******************************************************************/
 GSDumpLzma::GSDumpLzma(char* filename, const char* repack_filename)
 	: GSDumpFile(filename, repack_filename)
+	, m_done(false)
+	, m_error(false)
+	, m_exit(false)
+	, m_start(0)
 {
 
 	memset(&m_strm, 0, sizeof(lzma_stream));
@@ -67,59 +71,134 @@ GSDumpLzma::GSDumpLzma(char* filename, const char* repack_filename)
 		throw "BAD"; // Just exit the program
 	}
 
-	m_buff_size = 1024*1024;
-	m_area      = (uint8_t*)_aligned_malloc(m_buff_size, 32);
-	m_inbuf     = (uint8_t*)_aligned_malloc(BUFSIZ, 32);
-	m_avail     = 0;
-	m_start     = 0;
+	m_inbuf = (uint8_t*)_aligned_malloc(BUFSIZ, 32);
 
 	m_strm.avail_in  = 0;
 	m_strm.next_in   = m_inbuf;
 
-	m_strm.avail_out = m_buff_size;
-	m_strm.next_out  = m_area;
+	m_thread = std::thread(&GSDumpLzma::DecodeThread, this);
 }
 
-void GSDumpLzma::Decompress()
+// Fills out as much as possible, returns false once the stream is over
+bool GSDumpLzma::Decompress(std::vector<uint8_t>& out, size_t& size, bool& error)
 {
-	lzma_action action = LZMA_RUN;
+	m_strm.next_out  = out.data();
+	m_strm.avail_out = out.size();
 
-	m_strm.next_out  = m_area;
-	m_strm.avail_out = m_buff_size;
+	bool more = true;
 
-	// Nothing left in the input buffer. Read data from the file
-	if (m_strm.avail_in == 0 && !feof(m_fp))
+	while (m_strm.avail_out > 0)
 	{
-		m_strm.next_in   = m_inbuf;
-		m_strm.avail_in  = fread(m_inbuf, 1, BUFSIZ, m_fp);
+		// Nothing left in the input buffer. Read data from the file
+		if (m_strm.avail_in == 0)
+		{
+			if (feof(m_fp))
+			{
+				more = false;
+				break;
+			}
+
+			m_strm.next_in   = m_inbuf;
+			m_strm.avail_in  = fread(m_inbuf, 1, BUFSIZ, m_fp);
+
+			if (ferror(m_fp))
+			{
+				fprintf(stderr, "Read error: %s\n", strerror(errno));
+				error = true;
+				more = false;
+				break;
+			}
+		}
+
+		lzma_ret ret = lzma_code(&m_strm, LZMA_RUN);
 
-		if (ferror(m_fp))
+		if (ret != LZMA_OK)
 		{
-			fprintf(stderr, "Read error: %s\n", strerror(errno));
-			throw "BAD"; // Just exit the program
+			if (ret == LZMA_STREAM_END)
+				fprintf(stderr, "LZMA decoder finished without error\n\n");
+			else
+			{
+				fprintf(stderr, "Decoder error: (error code %u)\n", ret);
+				error = true;
+			}
+
+			more = false;
+			break;
 		}
 	}
 
-	lzma_ret ret = lzma_code(&m_strm, action);
+	size = out.size() - m_strm.avail_out;
 
-	if (ret != LZMA_OK)
+	return more;
+}
+
+void GSDumpLzma::DecodeThread()
+{
+	bool more = true;
+
+	while (more)
 	{
-		if (ret == LZMA_STREAM_END)
-			fprintf(stderr, "LZMA decoder finished without error\n\n");
-		else
-		{
-			fprintf(stderr, "Decoder error: (error code %u)\n", ret);
+		std::vector<uint8_t> block(BLOCK_SIZE);
+		size_t size = 0;
+		bool error = false;
+
+		more = Decompress(block, size, error);
+
+		block.resize(size);
+
+		std::unique_lock<std::mutex> l(m_lock);
+
+		while (m_blocks.size() >= MAX_BLOCKS && !m_exit)
+			m_cv.wait(l);
+
+		if (m_exit)
+			return;
+
+		if (size > 0)
+			m_blocks.push_back(std::move(block));
+
+		m_done = !more;
+		m_error = error;
+
+		m_cv.notify_all();
+	}
+}
+
+bool GSDumpLzma::NextBlock()
+{
+	std::unique_lock<std::mutex> l(m_lock);
+
+	while (m_blocks.empty() && !m_done)
+		m_cv.wait(l);
+
+	if (m_blocks.empty())
+	{
+		if (m_error)
 			throw "BAD"; // Just exit the program
-		}
+
+		return false;
 	}
 
+	m_area = std::move(m_blocks.front());
+	m_blocks.pop_front();
 	m_start = 0;
-	m_avail = m_buff_size - m_strm.avail_out;
+
+	m_cv.notify_all();
+
+	return true;
 }
 
 bool GSDumpLzma::IsEof()
 {
-	return feof(m_fp) && m_avail == 0 && m_strm.avail_in == 0;
+	if (m_start < m_area.size())
+		return false;
+
+	std::unique_lock<std::mutex> l(m_lock);
+
+	while (m_blocks.empty() && !m_done)
+		m_cv.wait(l);
+
+	return m_blocks.empty();
 }
 
 bool GSDumpLzma::Read(void* ptr, size_t size)
@@ -127,16 +206,13 @@ bool GSDumpLzma::Read(void* ptr, size_t size)
 	size_t off = 0;
 	uint8_t* dst = (uint8_t*)ptr;
 	size_t full_size = size;
-	while (size && !IsEof())
+	while (size)
 	{
-		if (m_avail == 0)
-		{
-			Decompress();
-		}
+		if (m_start == m_area.size() && !NextBlock())
+			break;
 
-		size_t l = std::min(size, m_avail);
-		memcpy(dst + off, m_area + m_start, l);
-		m_avail -= l;
+		size_t l = std::min(size, m_area.size() - m_start);
+		memcpy(dst + off, m_area.data() + m_start, l);
 		size    -= l;
 		m_start += l;
 		off     += l;
@@ -153,12 +229,18 @@ bool GSDumpLzma::Read(void* ptr, size_t size)
 
 GSDumpLzma::~GSDumpLzma()
 {
+	{
+		std::lock_guard<std::mutex> l(m_lock);
+		m_exit = true;
+	}
+	m_cv.notify_all();
+
+	m_thread.join();
+
 	lzma_end(&m_strm);
 
 	if (m_inbuf)
 		_aligned_free(m_inbuf);
-	if (m_area)
-		_aligned_free(m_area);
 }
 
 /******************************************************************/
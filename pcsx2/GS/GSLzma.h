@@ -14,6 +14,10 @@
  */
 
 #include <lzma.h>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 
 class GSDumpFile
 {
@@ -34,16 +38,31 @@ public:
 
 class GSDumpLzma : public GSDumpFile
 {
-	lzma_stream m_strm;
+	enum : size_t
+	{
+		BLOCK_SIZE = 1024 * 1024,
+		MAX_BLOCKS = 16,
+	};
 
-	size_t m_buff_size;
-	uint8_t* m_area;
+	lzma_stream m_strm;
 	uint8_t* m_inbuf;
 
-	size_t m_avail;
+	// Blocks are decoded ahead by a dedicated thread so the replay doesn't wait on
+	// lzma, the queue is bounded to keep the memory usage in check.
+	std::thread m_thread;
+	std::mutex m_lock;
+	std::condition_variable m_cv;
+	std::deque<std::vector<uint8_t>> m_blocks;
+	bool m_done;
+	bool m_error;
+	bool m_exit;
+
+	std::vector<uint8_t> m_area;
 	size_t m_start;
 
-	void Decompress();
+	bool Decompress(std::vector<uint8_t>& out, size_t& size, bool& error);
+	void DecodeThread();
+	bool NextBlock();
 
 public:
 	GSDumpLzma(char* filename, const char* repack_filename);
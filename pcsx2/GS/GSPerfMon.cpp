@@ -24,7 +24,9 @@ GSPerfMon::GSPerfMon()
 {
 	memset(m_counters, 0, sizeof(m_counters));
 	memset(m_stats, 0, sizeof(m_stats));
+	memset(m_totals, 0, sizeof(m_totals));
 	memset(m_total, 0, sizeof(m_total));
+	memset(m_ticks, 0, sizeof(m_ticks));
 	memset(m_begin, 0, sizeof(m_begin));
 }
 
@@ -55,6 +57,7 @@ void GSPerfMon::Put(counter_t c, double val)
 	else
 	{
 		m_counters[c] += val;
+		m_totals[c] += val;
 	}
 #endif
 }
@@ -93,7 +96,10 @@ void GSPerfMon::Stop(int timer)
 #ifndef DISABLE_PERF_MON
 	if (m_start[timer] > 0)
 	{
-		m_total[timer] += __rdtsc() - m_start[timer];
+		uint64 ticks = __rdtsc() - m_start[timer];
+
+		m_total[timer] += ticks;
+		m_ticks[timer] += ticks;
 		m_start[timer] = 0;
 	}
 #endif
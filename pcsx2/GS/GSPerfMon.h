@@ -45,7 +45,9 @@ public:
 protected:
 	double m_counters[CounterLast];
 	double m_stats[CounterLast];
+	double m_totals[CounterLast]; // running totals, not cleared by Update()
 	uint64 m_begin[TimerLast], m_total[TimerLast], m_start[TimerLast];
+	uint64 m_ticks[TimerLast]; // running totals, not cleared by CPU()
 	uint64 m_frame;
 	clock_t m_lastframe;
 	int m_count;
@@ -60,6 +62,8 @@ public:
 
 	void Put(counter_t c, double val = 0);
 	double Get(counter_t c) { return m_stats[c]; }
+	double GetTotal(counter_t c) { return m_totals[c]; }
+	uint64 GetTicks(int timer) { return m_ticks[timer]; }
 	void Update();
 
 	void Start(int timer = Main);
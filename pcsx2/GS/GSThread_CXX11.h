@@ -18,46 +18,88 @@
 #include "GS.h"
 #include "Utilities/boost_spsc_queue.hpp"
 
+// Single producer, single consumer job queue with a dedicated worker thread.
+//
+// Both sides spin for a while before sleeping, and only touch the mutex and condition
+// variables when the other side actually went to sleep, so a busy queue never makes a
+// system call.  The spin lengths adapt: each side's grows when spinning paid off and
+// shrinks when it had to sleep anyway, so neither burns MAX_SPIN pauses on a queue that
+// keeps it waiting longer than that.
 template <class T, int CAPACITY>
 class GSJobQueue final
 {
 private:
+	enum : int
+	{
+		MIN_SPIN = 64,
+		MAX_SPIN = 16384,
+	};
+
 	std::thread m_thread;
 	std::function<void(T&)> m_func;
-	bool m_exit;
+	std::atomic<bool> m_exit;
 	ringbuffer_base<T, CAPACITY> m_queue;
 
 	std::mutex m_lock;
-	std::mutex m_wait_lock;
 	std::condition_variable m_empty;
 	std::condition_variable m_notempty;
+	std::atomic<bool> m_worker_sleeping;
+	std::atomic<bool> m_waiter_sleeping;
+	int m_spin;      // worker thread only
+	int m_wait_spin; // waiting thread only
 
-	void ThreadProc()
+	template <class Pred>
+	static bool Spin(int count, Pred pred)
 	{
-		std::unique_lock<std::mutex> l(m_lock);
+		for (int i = 0; i < count; i++)
+		{
+			if (pred())
+				return true;
+
+			_mm_pause();
+		}
 
+		return pred();
+	}
+
+	void ThreadProc()
+	{
 		while (true)
 		{
+			while (m_queue.consume_one(*this))
+				;
+
+			// Pairs with the fence in Wait(): either the waiter sees the queue empty, or
+			// we see it sleeping.
+			std::atomic_thread_fence(std::memory_order_seq_cst);
 
-			while (m_queue.empty())
+			if (m_waiter_sleeping.load(std::memory_order_relaxed))
 			{
-				if (m_exit)
-					return;
+				std::lock_guard<std::mutex> l(m_lock);
+				m_empty.notify_one();
+			}
 
-				m_notempty.wait(l);
+			if (Spin(m_spin, [this] { return !m_queue.empty() || m_exit.load(std::memory_order_relaxed); }))
+			{
+				m_spin = std::min<int>(m_spin * 2, MAX_SPIN);
 			}
+			else
+			{
+				m_spin = std::max<int>(m_spin / 2, MIN_SPIN);
 
-			l.unlock();
+				std::unique_lock<std::mutex> l(m_lock);
 
-			while (m_queue.consume_one(*this))
-				;
+				m_worker_sleeping.store(true, std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
 
-			{
-				std::lock_guard<std::mutex> wait_guard(m_wait_lock);
+				while (m_queue.empty() && !m_exit)
+					m_notempty.wait(l);
+
+				m_worker_sleeping.store(false, std::memory_order_relaxed);
 			}
-			m_empty.notify_one();
 
-			l.lock();
+			if (m_exit && m_queue.empty())
+				return;
 		}
 	}
 
@@ -65,6 +107,10 @@ public:
 	GSJobQueue(std::function<void(T&)> func)
 		: m_func(func)
 		, m_exit(false)
+		, m_worker_sleeping(false)
+		, m_waiter_sleeping(false)
+		, m_spin(MIN_SPIN)
+		, m_wait_spin(MIN_SPIN)
 	{
 		m_thread = std::thread(&GSJobQueue::ThreadProc, this);
 	}
@@ -90,21 +136,37 @@ public:
 		while (!m_queue.push(item))
 			std::this_thread::yield();
 
+		// Pairs with the fence in ThreadProc(): either the worker sees the new item, or
+		// we see it sleeping.
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		if (m_worker_sleeping.load(std::memory_order_relaxed))
 		{
 			std::lock_guard<std::mutex> l(m_lock);
+			m_notempty.notify_one();
 		}
-		m_notempty.notify_one();
 	}
 
 	void Wait()
 	{
-		if (IsEmpty())
+		if (Spin(m_wait_spin, [this] { return IsEmpty(); }))
+		{
+			m_wait_spin = std::min<int>(m_wait_spin * 2, MAX_SPIN);
 			return;
+		}
+
+		m_wait_spin = std::max<int>(m_wait_spin / 2, MIN_SPIN);
+
+		std::unique_lock<std::mutex> l(m_lock);
+
+		m_waiter_sleeping.store(true, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
 
-		std::unique_lock<std::mutex> l(m_wait_lock);
 		while (!IsEmpty())
 			m_empty.wait(l);
 
+		m_waiter_sleeping.store(false, std::memory_order_relaxed);
+
 		assert(IsEmpty());
 	}
 
@@ -83,24 +83,50 @@ void GSDrawScanline::BeginDraw(const GSRasterizerData* data)
 		m_dr = NULL;
 	}
 
-	// doesn't need all bits => less functions generated
+	m_sp = m_sp_map[GetSetupPrimSelector(m_global.sel)];
+}
+
+void GSDrawScanline::Prepare(uint64 key)
+{
+	GSScanlineSelector sel;
+
+	sel.key = key;
+
+	m_ds_map[sel];
+
+	if (sel.aa1)
+	{
+		GSScanlineSelector edge;
+
+		edge.key = sel.key;
+		edge.zwrite = 0;
+		edge.edge = 1;
+
+		m_ds_map[edge];
+	}
 
+	m_sp_map[GetSetupPrimSelector(sel)];
+}
+
+// doesn't need all bits => less functions generated
+uint64 GSDrawScanline::GetSetupPrimSelector(const GSScanlineSelector& global)
+{
 	GSScanlineSelector sel;
 
 	sel.key = 0;
 
-	sel.iip = m_global.sel.iip;
-	sel.tfx = m_global.sel.tfx;
-	sel.tcc = m_global.sel.tcc;
-	sel.fst = m_global.sel.fst;
-	sel.fge = m_global.sel.fge;
-	sel.prim = m_global.sel.prim;
-	sel.fb = m_global.sel.fb;
-	sel.zb = m_global.sel.zb;
-	sel.zoverflow = m_global.sel.zoverflow;
-	sel.notest = m_global.sel.notest;
-
-	m_sp = m_sp_map[sel];
+	sel.iip = global.iip;
+	sel.tfx = global.tfx;
+	sel.tcc = global.tcc;
+	sel.fst = global.fst;
+	sel.fge = global.fge;
+	sel.prim = global.prim;
+	sel.fb = global.fb;
+	sel.zb = global.zb;
+	sel.zoverflow = global.zoverflow;
+	sel.notest = global.notest;
+
+	return sel.key;
 }
 
 void GSDrawScanline::EndDraw(uint64 frame, uint64 ticks, int actual, int total)
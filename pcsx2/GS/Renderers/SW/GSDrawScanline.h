@@ -37,6 +37,8 @@ protected:
 	GSCodeGeneratorFunctionMap<GSSetupPrimCodeGenerator, uint64, SetupPrimPtr> m_sp_map;
 	GSCodeGeneratorFunctionMap<GSDrawScanlineCodeGenerator, uint64, DrawScanlinePtr> m_ds_map;
 
+	static uint64 GetSetupPrimSelector(const GSScanlineSelector& global);
+
 	template <class T, bool masked>
 	void DrawRectT(const int* RESTRICT row, const int* RESTRICT col, const GSVector4i& r, uint32 c, uint32 m);
 
@@ -63,6 +65,7 @@ public:
 
 	void BeginDraw(const GSRasterizerData* data);
 	void EndDraw(uint64 frame, uint64 ticks, int actual, int total);
+	void Prepare(uint64 key);
 
 	void DrawRect(const GSVector4i& r, const GSVertexSW& v);
 
@@ -20,6 +20,9 @@
 
 int GSRasterizerData::s_counter = 0;
 
+// Below this, binning a draw costs more than having every worker walk it.
+#define MIN_BINNED_PRIMS 64
+
 static int compute_best_thread_height(int threads)
 {
 	// - for more threads screen segments should be smaller to better distribute the pixels
@@ -116,6 +119,14 @@ void GSRasterizer::Queue(const std::shared_ptr<GSRasterizerData>& data)
 	Draw(data.get());
 }
 
+void GSRasterizer::Prepare(const std::vector<uint64>& keys)
+{
+	for (uint64 key : keys)
+	{
+		m_ds->Prepare(key);
+	}
+}
+
 int GSRasterizer::GetPixels(bool reset)
 {
 	int pixels = m_pixels.sum;
@@ -132,6 +143,12 @@ void GSRasterizer::Draw(GSRasterizerData* data)
 {
 	GSPerfMonAutoTimer pmat(m_perfmon, GSPerfMon::WorkerDraw0 + m_id);
 
+	if (!data->prepare.empty())
+	{
+		Prepare(data->prepare);
+		return;
+	}
+
 	if (data->vertex != NULL && data->vertex_count == 0 || data->index != NULL && data->index_count == 0)
 		return;
 
@@ -156,7 +173,27 @@ void GSRasterizer::Draw(GSRasterizerData* data)
 	m_fscissor_x = GSVector4(data->scissor).xzxz();
 	m_fscissor_y = GSVector4(data->scissor).ywyw();
 
-	switch (data->primclass)
+	if (!data->bin_start.empty())
+	{
+		const uint32* prim = &data->bin[data->bin_start[m_id]];
+		const uint32* prim_end = prim + (data->bin_start[m_id + 1] - data->bin_start[m_id]);
+		const int n = data->primclass == GS_TRIANGLE_CLASS ? 3 : 2;
+
+		for (; prim < prim_end; prim++)
+		{
+			const GSVertexSW* v = index != NULL ? vertex : vertex + *prim * n;
+			const uint32* i = index != NULL ? index + *prim * n : tmp_index;
+
+			switch (data->primclass)
+			{
+				case GS_LINE_CLASS: DrawLine(v, i); break;
+				case GS_TRIANGLE_CLASS: DrawTriangle(v, i); break;
+				case GS_SPRITE_CLASS: DrawSprite(v, i); break;
+				default: __assume(0);
+			}
+		}
+	}
+	else switch (data->primclass)
 	{
 		case GS_POINT_CLASS:
 
@@ -1199,12 +1236,119 @@ void GSRasterizerList::Queue(const std::shared_ptr<GSRasterizerData>& data)
 	int top = r.top >> m_thread_height;
 	int bottom = std::min<int>((r.bottom + (1 << m_thread_height) - 1) >> m_thread_height, top + m_workers.size());
 
+	if (bottom - top > 1 && data->primclass != GS_POINT_CLASS)
+	{
+		const int n = data->primclass == GS_TRIANGLE_CLASS ? 3 : 2;
+		const int prims = (data->index != NULL ? data->index_count : data->vertex_count) / n;
+
+		if (prims >= MIN_BINNED_PRIMS)
+		{
+			Bin(data.get(), r);
+
+			for (size_t i = 0; i < m_workers.size(); i++)
+			{
+				if (data->bin_start[i] != data->bin_start[i + 1])
+				{
+					m_workers[i]->Push(data);
+				}
+			}
+
+			return;
+		}
+	}
+
 	while (top < bottom)
 	{
 		m_workers[m_scanline[top++]]->Push(data);
 	}
 }
 
+// The code maps of each rasterizer are only ever touched from its own thread, so the
+// selectors are handed to every worker as a job that draws nothing.
+void GSRasterizerList::Prepare(const std::vector<uint64>& keys)
+{
+	if (keys.empty())
+		return;
+
+	std::shared_ptr<GSRasterizerData> data(new GSRasterizerData());
+
+	data->prepare = keys;
+
+	for (size_t i = 0; i < m_workers.size(); i++)
+	{
+		m_workers[i]->Push(data);
+	}
+}
+
+// Sorts the primitives of a draw by the workers owning the scanlines they cover, so that
+// each worker only walks its own primitives instead of testing all of them.  The ranges
+// are conservative; the rasterizer still clips every primitive to its own scanlines.
+void GSRasterizerList::Bin(GSRasterizerData* data, const GSVector4i& r)
+{
+	const int workers = (int)m_workers.size();
+	const int n = data->primclass == GS_TRIANGLE_CLASS ? 3 : 2;
+	const int prims = (data->index != NULL ? data->index_count : data->vertex_count) / n;
+
+	m_bins.resize(workers);
+
+	for (auto& b : m_bins)
+	{
+		b.clear();
+	}
+
+	for (int i = 0; i < prims; i++)
+	{
+		float ymin = FLT_MAX;
+		float ymax = -FLT_MAX;
+
+		for (int j = 0; j < n; j++)
+		{
+			float y = data->vertex[data->index != NULL ? data->index[i * n + j] : i * n + j].p.y;
+			ymin = std::min(ymin, y);
+			ymax = std::max(ymax, y);
+		}
+
+		int b0 = std::max<int>((int)ymin - 1, r.top) >> m_thread_height;
+		int b1 = std::min<int>((int)ymax + 2, r.bottom - 1) >> m_thread_height;
+
+		if (b0 > b1)
+		{
+			continue;
+		}
+
+		if (b1 - b0 + 1 >= workers)
+		{
+			for (auto& b : m_bins)
+			{
+				b.push_back(i);
+			}
+		}
+		else
+		{
+			// consecutive bands belong to different workers
+			for (int band = b0; band <= b1; band++)
+			{
+				m_bins[m_scanline[band]].push_back(i);
+			}
+		}
+	}
+
+	data->bin_start.resize(workers + 1);
+	data->bin_start[0] = 0;
+
+	for (int i = 0; i < workers; i++)
+	{
+		data->bin_start[i + 1] = data->bin_start[i] + (int)m_bins[i].size();
+	}
+
+	data->bin.resize(data->bin_start[workers]);
+
+	for (int i = 0; i < workers; i++)
+	{
+		std::copy(m_bins[i].begin(), m_bins[i].end(), data->bin.begin() + data->bin_start[i]);
+	}
+}
+
 void GSRasterizerList::Sync()
 {
 	if (!IsSynced())
@@ -40,6 +40,15 @@ public:
 	int pixels;
 	int counter;
 
+	// Primitives touching the scanlines of each worker, filled by GSRasterizerList for
+	// draws worth binning.  Worker i draws bin[bin_start[i]] to bin[bin_start[i + 1] - 1];
+	// when bin_start is empty every worker walks every primitive.
+	std::vector<uint32> bin;
+	std::vector<int> bin_start;
+
+	// Scanline selectors to generate code for ahead of time, nothing is drawn.
+	std::vector<uint64> prepare;
+
 	GSRasterizerData()
 		: scissor(GSVector4i::zero())
 		, bbox(GSVector4i::zero())
@@ -88,6 +97,7 @@ public:
 
 	virtual void BeginDraw(const GSRasterizerData* data) = 0;
 	virtual void EndDraw(uint64 frame, uint64 ticks, int actual, int total) = 0;
+	virtual void Prepare(uint64 key) {}
 
 #ifdef ENABLE_JIT_RASTERIZER
 
@@ -117,6 +127,7 @@ public:
 	virtual ~IRasterizer() {}
 
 	virtual void Queue(const std::shared_ptr<GSRasterizerData>& data) = 0;
+	virtual void Prepare(const std::vector<uint64>& keys) = 0;
 	virtual void Sync() = 0;
 	virtual bool IsSynced() const = 0;
 	virtual int GetPixels(bool reset = true) = 0;
@@ -173,6 +184,7 @@ public:
 	// IRasterizer
 
 	void Queue(const std::shared_ptr<GSRasterizerData>& data);
+	void Prepare(const std::vector<uint64>& keys);
 	void Sync() {}
 	bool IsSynced() const { return true; }
 	int GetPixels(bool reset);
@@ -190,9 +202,12 @@ protected:
 	std::vector<std::unique_ptr<GSWorker>> m_workers;
 	uint8* m_scanline;
 	int m_thread_height;
+	std::vector<std::vector<uint32>> m_bins;
 
 	GSRasterizerList(int threads, GSPerfMon* perfmon);
 
+	void Bin(GSRasterizerData* data, const GSVector4i& r);
+
 public:
 	virtual ~GSRasterizerList();
 
@@ -222,6 +237,7 @@ public:
 	// IRasterizer
 
 	void Queue(const std::shared_ptr<GSRasterizerData>& data);
+	void Prepare(const std::vector<uint64>& keys);
 	void Sync();
 	bool IsSynced() const;
 	int GetPixels(bool reset);
@@ -27,6 +27,7 @@ CONSTINIT const GSVector8 GSRendererSW::m_pos_scale2 = GSVector8::cxpr(1.0f / 16
 
 GSRendererSW::GSRendererSW(int threads)
 	: m_fzb(NULL)
+	, m_jit_saved(0)
 {
 	m_nativeres = true; // ignore ini, sw is always native
 
@@ -64,6 +65,8 @@ GSRendererSW::GSRendererSW(int threads)
 
 	m_dump_root = root_sw;
 
+	m_jit_cache = theApp.GetConfigB("jit_cache");
+
 	// Reset handler with the auto flush hack enabled on the SW renderer.
 	// Some games run better without the hack so rely on ini/gui option.
 	if (!GLLoader::in_replayer && theApp.GetConfigB("autoflush_sw"))
@@ -82,6 +85,8 @@ GSRendererSW::~GSRendererSW()
 		delete m_texture[i];
 	}
 
+	SaveJitKeys();
+
 	delete m_rl;
 
 	_aligned_free(m_output);
@@ -137,9 +142,116 @@ void GSRendererSW::VSync(int field)
 
 	m_tc->IncAge();
 
+	if ((m_perfmon.GetFrame() & 0xfff) == 0)
+	{
+		SaveJitKeys();
+	}
+
 	// if((m_perfmon.GetFrame() & 255) == 0) m_rl->PrintStats();
 }
 
+void GSRendererSW::SetGameCRC(uint32 crc, int options)
+{
+	bool changed = crc != m_crc;
+
+	if (changed)
+	{
+		SaveJitKeys();
+	}
+
+	GSRenderer::SetGameCRC(crc, options);
+
+	if (changed)
+	{
+		LoadJitKeys();
+	}
+}
+
+// Only the selectors are kept, the generated code embeds the address of the local data
+// of each rasterizer and has to be generated again by every one of them.
+
+struct GSJitKeysHeader
+{
+	char magic[4];
+	uint32 version;
+	uint32 sse;
+	uint32 count;
+};
+
+static const uint32 JIT_KEYS_VERSION = 1;
+
+static std::string GetJitKeysPath(uint32 crc)
+{
+	return theApp.GetCacheDir("gs_jit") + format("%08X.bin", crc);
+}
+
+void GSRendererSW::LoadJitKeys()
+{
+	m_jit_keys.clear();
+	m_jit_saved = 0;
+
+	if (!m_jit_cache || m_crc == 0)
+		return;
+
+	FILE* fp = px_fopen(GetJitKeysPath(m_crc), "rb");
+
+	if (fp == NULL)
+		return;
+
+	GSJitKeysHeader header;
+	std::vector<uint64> keys;
+
+	if (fread(&header, sizeof(header), 1, fp) == 1
+		&& memcmp(header.magic, "GSJK", 4) == 0
+		&& header.version == JIT_KEYS_VERSION
+		&& header.sse == _M_SSE
+		&& header.count <= 0x10000)
+	{
+		keys.resize(header.count);
+
+		if (fread(keys.data(), sizeof(uint64), keys.size(), fp) != keys.size())
+		{
+			keys.clear();
+		}
+	}
+
+	fclose(fp);
+
+	m_jit_keys.insert(keys.begin(), keys.end());
+	m_jit_saved = m_jit_keys.size();
+
+	m_rl->Prepare(keys);
+}
+
+void GSRendererSW::SaveJitKeys()
+{
+	if (!m_jit_cache || m_crc == 0 || m_jit_keys.size() == m_jit_saved)
+		return;
+
+	FILE* fp = px_fopen(GetJitKeysPath(m_crc), "wb");
+
+	if (fp == NULL)
+	{
+		fprintf(stderr, "GS: failed to save the JIT cache of %08X\n", m_crc);
+		return;
+	}
+
+	GSJitKeysHeader header;
+
+	memcpy(header.magic, "GSJK", 4);
+	header.version = JIT_KEYS_VERSION;
+	header.sse = _M_SSE;
+	header.count = (uint32)m_jit_keys.size();
+
+	std::vector<uint64> keys(m_jit_keys.begin(), m_jit_keys.end());
+
+	fwrite(&header, sizeof(header), 1, fp);
+	fwrite(keys.data(), sizeof(uint64), keys.size(), fp);
+	fclose(fp);
+
+	m_jit_saved = m_jit_keys.size();
+}
+
 void GSRendererSW::ResetDevice()
 {
 	for (size_t i = 0; i < countof(m_texture); i++)
@@ -384,6 +496,11 @@ void GSRendererSW::Draw()
 		return;
 	}
 
+	if (m_jit_cache)
+	{
+		m_jit_keys.insert(sd->global.sel.key);
+	}
+
 	if (0) if (LOG)
 	{
 		int n = GSUtil::GetVertexCount(PRIM->PRIM);
@@ -649,15 +766,7 @@ void GSRendererSW::InvalidateVideoMem(const GIFRegBITBLTBUF& BITBLTBUF, const GS
 
 	if (!m_rl->IsSynced())
 	{
-		for (uint32* RESTRICT p = m_tmp_pages; *p != GSOffset::EOP; p++)
-		{
-			if (m_fzb_pages[*p] | m_tex_pages[*p])
-			{
-				Sync(6);
-
-				break;
-			}
-		}
+		WaitPages(m_tmp_pages, true, 6);
 	}
 
 	m_tc->InvalidatePages(m_tmp_pages, off->psm); // if texture update runs on a thread and Sync(5) happens then this must come later
@@ -677,16 +786,47 @@ void GSRendererSW::InvalidateLocalMem(const GIFRegBITBLTBUF& BITBLTBUF, const GS
 
 		off->GetPages(r, m_tmp_pages);
 
-		for (uint32* RESTRICT p = m_tmp_pages; *p != GSOffset::EOP; p++)
-		{
-			if (m_fzb_pages[*p])
-			{
-				Sync(7);
+		WaitPages(m_tmp_pages, false, 7);
+	}
+}
 
-				break;
-			}
+// Waits for the queued draws using any of the pages as a target (or also as a texture) to
+// finish, while the draws not touching them keep running.  The page counters drop as soon
+// as the last rasterizer thread is done with a draw, see SharedData::ReleasePages.
+void GSRendererSW::WaitPages(const uint32* pages, bool tex, int reason)
+{
+	const uint32* p = pages;
+
+	while (*p != GSOffset::EOP && !(m_fzb_pages[*p] | (tex ? m_tex_pages[*p].load() : 0)))
+	{
+		p++;
+	}
+
+	if (*p == GSOffset::EOP)
+	{
+		return;
+	}
+
+	GSPerfMonAutoTimer pmat(&m_perfmon, GSPerfMon::Sync);
+
+	uint64 t = __rdtsc();
+
+	for (int spin = 0; *p != GSOffset::EOP; p++)
+	{
+		while (m_fzb_pages[*p] | (tex ? m_tex_pages[*p].load() : 0))
+		{
+			if (++spin < 4096)
+				_mm_pause();
+			else
+				std::this_thread::yield();
 		}
 	}
+
+	if (LOG)
+	{
+		fprintf(s_fp, "wait n=%d r=%d t=%llu\n", s_n, reason, __rdtsc() - t);
+		fflush(s_fp);
+	}
 }
 
 void GSRendererSW::UsePages(const uint32* pages, const int type)
@@ -78,6 +78,15 @@ protected:
 	std::atomic<uint16> m_tex_pages[512];
 	uint32 m_tmp_pages[512 + 1];
 
+	// Scanline selectors drawn by the current game, saved per crc so that the next boot
+	// can generate their code before the first draw needs it.
+	std::unordered_set<uint64> m_jit_keys;
+	size_t m_jit_saved;
+	bool m_jit_cache;
+
+	void LoadJitKeys();
+	void SaveJitKeys();
+
 	void Reset();
 	void VSync(int field);
 	void ResetDevice();
@@ -87,6 +96,7 @@ protected:
 	void Draw();
 	void Queue(std::shared_ptr<GSRasterizerData>& item);
 	void Sync(int reason);
+	void WaitPages(const uint32* pages, bool tex, int reason);
 	void InvalidateVideoMem(const GIFRegBITBLTBUF& BITBLTBUF, const GSVector4i& r);
 	void InvalidateLocalMem(const GIFRegBITBLTBUF& BITBLTBUF, const GSVector4i& r, bool clut = false);
 
@@ -101,4 +111,6 @@ protected:
 public:
 	GSRendererSW(int threads);
 	virtual ~GSRendererSW();
+
+	void SetGameCRC(uint32 crc, int options);
 };
@@ -52,6 +52,38 @@ public:
 	virtual void SetVSync(int vsync) {}
 };
 
+// Window without any surface, used to run the renderers headless (GS dump benchmark)
+class GSWndNull final : public GSWnd
+{
+	int m_width;
+	int m_height;
+
+public:
+	GSWndNull(int w = 640, int h = 480)
+		: m_width(w)
+		, m_height(h)
+	{
+	}
+
+	bool Create(const std::string& title, int w, int h)
+	{
+		m_width = w;
+		m_height = h;
+		return true;
+	}
+	bool Attach(void* handle, bool managed = true) { return true; }
+	void Detach() {}
+
+	void* GetDisplay() { return nullptr; }
+	void* GetHandle() { return nullptr; }
+	GSVector4i GetClientRect() { return GSVector4i(0, 0, m_width, m_height); }
+	bool SetWindowText(const char* title) { return true; }
+
+	void Show() {}
+	void Hide() {}
+	void HideFrame() {}
+};
+
 class GSWndGL : public GSWnd
 {
 protected:
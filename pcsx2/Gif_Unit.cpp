@@ -235,6 +235,28 @@ void Gif_MTGS_Wait(bool isMTVU)
 	GetMTGS().WaitGS(false, true, isMTVU);
 }
 
+// Called on vsync: doubles the buffers of the paths which had to wait on the MTGS during
+// the last frame because the frame's data didn't fit in them. The MTGS reads the packets
+// straight from the path buffers, so it must be idle while a buffer is reallocated.
+// MTVU path 1 is filled by the VU thread and keeps its size.
+void Gif_AdaptBuffers()
+{
+	for (Gif_Path& path : gifUnit.gifPath)
+	{
+		if (path.isMTVU())
+			continue;
+		Gif_Path_Stats& stats = path.stats;
+		if (stats.stalls && stats.frameBytes > path.buffLimit / 2 && path.buffSize < Gif_PathMaxSize)
+		{
+			GetMTGS().WaitGS(false);
+			DevCon.WriteLn("Gif Path[%d] - Growing buffer to %umb [frame=%ukb, stalls=%u]",
+				path.idx + 1, path.buffSize * 2 / _1mb, stats.frameBytes / _1kb, stats.stalls);
+			path.Grow(path.buffSize * 2);
+		}
+		stats.Reset();
+	}
+}
+
 void SaveStateBase::gifPathFreeze(u32 path)
 {
 
@@ -250,11 +272,20 @@ void SaveStateBase::gifPathFreeze(u32 path)
 			gifPath.RealignPacket(); // May add readAmount which we need to clear on load
 		}
 	}
-	u8* bufferPtr = gifPath.buffer; // Backup current buffer ptr
+	u8* bufferPtr = gifPath.buffer; // Backup current buffer ptr and size (see Gif_AdaptBuffers)
+	u32 buffSize = gifPath.buffSize;
+	u32 buffLimit = gifPath.buffLimit;
 	Freeze(gifPath.mtvu.fakePackets);
-	FreezeMem(&gifPath, sizeof(gifPath) - sizeof(gifPath.mtvu));
-	FreezeMem(bufferPtr, gifPath.curSize);
+	FreezeMem(&gifPath, (u8*)&gifPath.mtvu - (u8*)&gifPath);
 	gifPath.buffer = bufferPtr;
+	gifPath.buffSize = buffSize;
+	gifPath.buffLimit = buffLimit;
+	if (!IsSaving() && gifPath.curSize > gifPath.buffSize)
+	{ // State saved with a bigger buffer
+		gifPath.readAmount = 0;
+		gifPath.Grow(Gif_PathMaxSize);
+	}
+	FreezeMem(gifPath.buffer, gifPath.curSize);
 	if (!IsSaving())
 	{
 		gifPath.readAmount = 0;
@@ -25,6 +25,7 @@
 
 struct GS_Packet;
 extern void Gif_MTGS_Wait(bool isMTVU);
+extern void Gif_AdaptBuffers();
 extern void Gif_FinishIRQ();
 extern bool Gif_HandlerAD(u8* pMem);
 extern bool Gif_HandlerAD_MTVU(u8* pMem);
@@ -188,6 +189,17 @@ struct Gif_Path_MTVU
 	}
 };
 
+// Path buffer usage since the last vsync, used to grow the buffers (see Gif_AdaptBuffers)
+struct Gif_Path_Stats
+{
+	u32 frameBytes; // GS packet data copied to the buffer
+	u32 stalls;     // Times the buffer was full and the path waited on the MTGS
+	void Reset() { memzero(*this); }
+};
+
+// Path buffers are grown up to this size when a frame doesn't fit in them
+static const u32 Gif_PathMaxSize = _1mb * 72;
+
 struct Gif_Path
 {
 	std::atomic<int> readAmount; // Amount of data MTGS still needs to read
@@ -201,7 +213,8 @@ struct Gif_Path
 	GS_Packet gsPack;            // Current GS Packet info
 	GIF_PATH idx;                // Gif Path Index
 	GIF_PATH_STATE state;        // Path State
-	Gif_Path_MTVU mtvu;          // Must be last for saved states
+	Gif_Path_MTVU mtvu;          // Must be last of the saved fields
+	Gif_Path_Stats stats;        // Not saved
 
 	Gif_Path() { Reset(); }
 	~Gif_Path() { _aligned_free(buffer); }
@@ -228,6 +241,7 @@ struct Gif_Path
 			return;
 		}
 		mtvu.Reset();
+		stats.Reset();
 		curSize = 0;
 		curOffset = 0;
 		readAmount = 0;
@@ -243,6 +257,7 @@ struct Gif_Path
 	// Waits on the MTGS to process gs packets
 	void mtgsReadWait()
 	{
+		stats.stalls++;
 		if (IsDevBuild)
 		{
 			DevCon.WriteLn(Color_Red, "Gif Path[%d] - MTGS Wait! [r=0x%x]", idx + 1, getReadAmount());
@@ -253,6 +268,20 @@ struct Gif_Path
 		Gif_MTGS_Wait(isMTVU());
 	}
 
+	// Reallocates the buffer with a bigger size, keeping its data at the same offsets.
+	// The MTGS must not have packets pending on this path (readAmount == 0).
+	void Grow(u32 newSize)
+	{
+		pxAssertDev(!readAmount, "Gif Path readAmount should be 0!");
+		u32 safeZone = buffSize - buffLimit;
+		u8* newBuffer = (u8*)_aligned_malloc(newSize, 16);
+		memcpy(newBuffer, buffer, std::min(curSize, buffSize));
+		_aligned_free(buffer);
+		buffer = newBuffer;
+		buffSize = newSize;
+		buffLimit = newSize - safeZone;
+	}
+
 	// Moves packet data to start of buffer
 	void RealignPacket()
 	{
@@ -306,6 +335,7 @@ struct Gif_Path
 		pxAssertDev(curSize + size <= buffSize, "Gif Path Buffer Overflow!");
 		memcpy(&buffer[curSize], pMem, size);
 		curSize += size;
+		stats.frameBytes += size;
 	}
 
 	// If completed a GS packet (with EOP) then set done to true
@@ -17,6 +17,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <chrono>
 #include <thread>
 #include <sys/types.h>
 #if _WIN32
@@ -30,12 +31,17 @@
 #define read_portable(a, b, c) (read(a, b, c))
 #define write_portable(a, b, c) (write(a, b, c))
 #define close_portable(a) (close(a))
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/socket.h>
 #include <sys/un.h>
 #endif
 
 #include "Common.h"
 #include "Memory.h"
+#include "GS.h"
+#include "VUmicro.h"
+#include "vtlb.h"
 #include "gui/AppSaveStates.h"
 #include "gui/AppCoreThread.h"
 #include "System/SysThreads.h"
@@ -241,6 +247,12 @@ void SocketIPC::ExecuteTaskInThread()
 SocketIPC::~SocketIPC()
 {
 	m_end = true;
+	{
+		// wake up a client blocked on MsgWatchWait
+		std::lock_guard<std::mutex> lock(m_watch_mutex);
+		m_watch_active = false;
+	}
+	m_watch_cv.notify_all();
 #ifdef _WIN32
 	WSACleanup();
 #else
@@ -258,6 +270,121 @@ SocketIPC::~SocketIPC()
 	DESTRUCTOR_CATCHALL
 }
 
+u8* SocketIPC::GetRangePtr(const IPCRange& range, bool write)
+{
+	u8* base;
+	u32 limit;
+	switch ((IPCMemSpace)range.space)
+	{
+		case SpaceIOP:
+			base = iopMem->Main;
+			limit = Ps2MemSize::IopRam;
+			break;
+		case SpaceVU0:
+			base = vuRegs[0].Mem;
+			limit = VU0_MEMSIZE;
+			break;
+		case SpaceVU1:
+			base = vuRegs[1].Mem;
+			limit = VU1_MEMSIZE;
+			break;
+		case SpaceVU0Micro:
+			base = vuRegs[0].Micro;
+			limit = VU0_PROGSIZE;
+			break;
+		case SpaceVU1Micro:
+			base = vuRegs[1].Micro;
+			limit = VU1_PROGSIZE;
+			break;
+		case SpaceGS:
+			base = g_RealGSMem;
+			limit = Ps2MemSize::GSregs;
+			break;
+		default:
+			return nullptr;
+	}
+	// micro memory is cached by the microVU recompilers and the GS registers
+	// and IOP memory have side effects on write, so those stay read-only
+	if (write && range.space != SpaceVU0 && range.space != SpaceVU1)
+		return nullptr;
+	if (range.addr > limit || range.size > limit - range.addr)
+		return nullptr;
+	return base + range.addr;
+}
+
+bool SocketIPC::ReadRange(const IPCRange& range, char* dest)
+{
+	if (range.space == SpaceEE)
+		return vtlb_memReadBlock(range.addr, dest, range.size);
+	const u8* src = GetRangePtr(range, false);
+	if (src == nullptr)
+		return false;
+	memcpy(dest, src, range.size);
+	return true;
+}
+
+bool SocketIPC::WriteRange(const IPCRange& range, const char* src)
+{
+	if (range.space == SpaceEE)
+		return vtlb_memWriteBlock(range.addr, src, range.size);
+	u8* dest = GetRangePtr(range, true);
+	if (dest == nullptr)
+		return false;
+	memcpy(dest, src, range.size);
+	return true;
+}
+
+// EE ranges may only cover memory that can be read without side effects
+bool SocketIPC::IsReadableRange(const IPCRange& range)
+{
+	if (range.space == SpaceEE)
+		return vtlb_memIsDirect(range.addr, range.size);
+	return GetRangePtr(range, false) != nullptr;
+}
+
+bool SocketIPC::ParseRanges(char* buf, u32& buf_cnt, u32 buf_size, u32 reply_space, std::vector<IPCRange>& ranges)
+{
+	if ((u64)buf_cnt + 4 > buf_size)
+		return false;
+	const u32 count = FromArray<u32>(buf, buf_cnt);
+	buf_cnt += 4;
+	if ((u64)count * 9 > buf_size - buf_cnt)
+		return false;
+
+	u64 total = 0;
+	ranges.resize(count);
+	for (IPCRange& range : ranges)
+	{
+		range.space = FromArray<u8>(buf, buf_cnt);
+		range.addr = FromArray<u32>(buf, buf_cnt + 1);
+		range.size = FromArray<u32>(buf, buf_cnt + 5);
+		buf_cnt += 9;
+		total += range.size;
+		if (!IsReadableRange(range))
+			return false;
+	}
+	return total <= reply_space;
+}
+
+void SocketIPC::OnVsync()
+{
+	if (!m_watch_active)
+		return;
+	{
+		std::lock_guard<std::mutex> lock(m_watch_mutex);
+		u32 offset = 0;
+		for (const IPCRange& range : m_watch_list)
+		{
+			// the game may have remapped an EE range since it was set
+			if (!ReadRange(range, &m_watch_data[offset]))
+				memset(&m_watch_data[offset], 0, range.size);
+			offset += range.size;
+		}
+		m_watch_vsync++;
+	}
+	m_watch_cv.notify_all();
+}
+
 SocketIPC::IPCBuffer SocketIPC::ParseCommand(char* buf, char* ret_buffer, u32 buf_size)
 {
 	u32 ret_cnt = 5;
@@ -482,6 +609,87 @@ SocketIPC::IPCBuffer SocketIPC::ParseCommand(char* buf, char* ret_buffer, u32 bu
 				ret_cnt += 4;
 				break;
 			}
+			case MsgReadRange:
+			{
+				if (!m_vm->HasActiveMachine())
+					goto error;
+				if (!SafetyChecks(buf_cnt, 9, ret_cnt, 0, buf_size))
+					goto error;
+				const IPCRange range{FromArray<u8>(&buf[buf_cnt], 0), FromArray<u32>(&buf[buf_cnt], 1), FromArray<u32>(&buf[buf_cnt], 5)};
+				if (range.size >= MAX_IPC_RETURN_SIZE || !SafetyChecks(buf_cnt, 9, ret_cnt, range.size, buf_size))
+					goto error;
+				if (!ReadRange(range, &ret_buffer[ret_cnt]))
+					goto error;
+				ret_cnt += range.size;
+				buf_cnt += 9;
+				break;
+			}
+			case MsgWriteRange:
+			{
+				if (!m_vm->HasActiveMachine())
+					goto error;
+				if (!SafetyChecks(buf_cnt, 9, ret_cnt, 0, buf_size))
+					goto error;
+				const IPCRange range{FromArray<u8>(&buf[buf_cnt], 0), FromArray<u32>(&buf[buf_cnt], 1), FromArray<u32>(&buf[buf_cnt], 5)};
+				if (range.size >= MAX_IPC_SIZE || !SafetyChecks(buf_cnt, 9 + range.size, ret_cnt, 0, buf_size))
+					goto error;
+				if (!WriteRange(range, &buf[buf_cnt + 9]))
+					goto error;
+				buf_cnt += 9 + range.size;
+				break;
+			}
+			case MsgReadScatter:
+			{
+				if (!m_vm->HasActiveMachine())
+					goto error;
+				std::vector<IPCRange> ranges;
+				if (!ParseRanges(buf, buf_cnt, buf_size, MAX_IPC_RETURN_SIZE - 1 - ret_cnt, ranges))
+					goto error;
+				for (const IPCRange& range : ranges)
+				{
+					if (!ReadRange(range, &ret_buffer[ret_cnt]))
+						goto error;
+					ret_cnt += range.size;
+				}
+				break;
+			}
+			case MsgWatchSet:
+			{
+				std::vector<IPCRange> ranges;
+				// leaves room for the reply header and the vsync counter
+				if (!ParseRanges(buf, buf_cnt, buf_size, MAX_IPC_RETURN_SIZE - 1 - 5 - 4, ranges))
+					goto error;
+				u32 total = 0;
+				for (const IPCRange& range : ranges)
+					total += range.size;
+				std::lock_guard<std::mutex> lock(m_watch_mutex);
+				m_watch_list = std::move(ranges);
+				m_watch_data.assign(total, 0);
+				m_watch_delivered = m_watch_vsync;
+				m_watch_active = !m_watch_list.empty();
+				break;
+			}
+			case MsgWatchWait:
+			{
+				if (!SafetyChecks(buf_cnt, 4, ret_cnt, 4, buf_size))
+					goto error;
+				const u32 timeout = FromArray<u32>(&buf[buf_cnt], 0);
+				buf_cnt += 4;
+				std::unique_lock<std::mutex> lock(m_watch_mutex);
+				if (!SafetyChecks(buf_cnt, 0, ret_cnt, 4 + (int)m_watch_data.size(), buf_size))
+					goto error;
+				// replies with the latest sample, waiting for one if the client
+				// already got it; fails on timeout or when nothing is watched
+				if (!m_watch_cv.wait_for(lock, std::chrono::milliseconds(timeout), [this] {
+						return !m_watch_active || m_watch_vsync != m_watch_delivered;
+					}) || !m_watch_active)
+					goto error;
+				m_watch_delivered = m_watch_vsync;
+				ToArray(ret_buffer, m_watch_vsync, ret_cnt);
+				memcpy(&ret_buffer[ret_cnt + 4], m_watch_data.data(), m_watch_data.size());
+				ret_cnt += 4 + m_watch_data.size();
+				break;
+			}
 			default:
 			{
 			error:
@@ -491,3 +699,117 @@ SocketIPC::IPCBuffer SocketIPC::ParseCommand(char* buf, char* ret_buffer, u32 bu
 	}
 	return IPCBuffer{(int)ret_cnt, MakeOkIPC(ret_buffer, ret_cnt)};
 }
+
+SharedMemoryIPC::SharedMemoryIPC(unsigned int slot)
+{
+	const size_t ram_offset = (sizeof(IPCSharedHeader) + __pagesize - 1) & ~(size_t)(__pagesize - 1);
+	m_size = ram_offset + Ps2MemSize::MainRam;
+
+	std::string name = IPC_SHM_NAME;
+	if (slot != IPC_DEFAULT_SLOT)
+		name += "." + std::to_string(slot);
+
+#ifdef _WIN32
+	name = "Local\\" + name;
+	m_mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, (DWORD)m_size, name.c_str());
+	if (m_mapping == nullptr)
+	{
+		Console.WriteLn(Color_Red, "IPC: Cannot create shared memory! Shared memory transport disabled.");
+		return;
+	}
+	void* view = MapViewOfFile(m_mapping, FILE_MAP_ALL_ACCESS, 0, 0, m_size);
+	if (view == nullptr)
+	{
+		Console.WriteLn(Color_Red, "IPC: Cannot map shared memory! Shared memory transport disabled.");
+		return;
+	}
+#else
+	m_name = "/" + name;
+	// a stale region left by a crashed instance would keep its old state
+	shm_unlink(m_name.c_str());
+	m_fd = shm_open(m_name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+	if (m_fd < 0 || ftruncate(m_fd, m_size) != 0)
+	{
+		Console.WriteLn(Color_Red, "IPC: Cannot create shared memory! Shared memory transport disabled.");
+		return;
+	}
+	void* view = mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+	if (view == MAP_FAILED)
+	{
+		Console.WriteLn(Color_Red, "IPC: Cannot map shared memory! Shared memory transport disabled.");
+		return;
+	}
+#endif
+
+	// freshly created mappings are zero filled, which leaves every slot free.
+	m_header = new (view) IPCSharedHeader;
+	m_header->magic = IPC_SHM_MAGIC;
+	m_header->version = IPC_SHM_VERSION;
+	m_header->slot_count = IPC_SHM_SLOTS;
+	m_header->ram_offset = (u32)ram_offset;
+	m_header->ram_size = Ps2MemSize::MainRam;
+	m_ram = (u8*)view + ram_offset;
+}
+
+SharedMemoryIPC::~SharedMemoryIPC()
+{
+#ifdef _WIN32
+	if (m_header)
+		UnmapViewOfFile(m_header);
+	if (m_mapping)
+		CloseHandle(m_mapping);
+#else
+	if (m_header)
+		munmap(m_header, m_size);
+	if (m_fd >= 0)
+	{
+		close(m_fd);
+		shm_unlink(m_name.c_str());
+	}
+#endif
+}
+
+void SharedMemoryIPC::OnVsync()
+{
+	if (!m_header)
+		return;
+
+	bool mirror = false;
+	for (const IPCSharedMirrorRange& range : m_header->mirror_ranges)
+		mirror |= range.state.load(std::memory_order_acquire) == ShmMirrorActive;
+	bool pending = false;
+	for (IPCSharedSlot& slot : m_header->slots)
+		pending |= slot.state.load(std::memory_order_acquire) == ShmSlotPending;
+	if (!mirror && !pending)
+		return;
+
+	m_vsync++;
+	m_header->sequence.store(m_vsync * 2 - 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	if (mirror)
+	{
+		for (const IPCSharedMirrorRange& range : m_header->mirror_ranges)
+		{
+			if (range.state.load(std::memory_order_acquire) != ShmMirrorActive)
+				continue;
+			// read once, the client may change them at any time
+			const u32 addr = range.addr;
+			const u32 size = range.size;
+			if (addr < Ps2MemSize::MainRam && size <= Ps2MemSize::MainRam - addr)
+				memcpy(m_ram + addr, eeMem->Main + addr, size);
+		}
+	}
+
+	for (IPCSharedSlot& slot : m_header->slots)
+	{
+		if (slot.state.load(std::memory_order_acquire) != ShmSlotPending)
+			continue;
+		const SocketIPC::IPCRange range{(u8)slot.space, slot.addr, slot.size};
+		const bool ok = slot.space <= 0xFF && range.size <= IPC_SHM_SLOT_SIZE && SocketIPC::IsReadableRange(range) && SocketIPC::ReadRange(range, (char*)slot.data);
+		slot.vsync = m_vsync;
+		slot.state.store(ok ? ShmSlotDone : ShmSlotFailed, std::memory_order_release);
+	}
+
+	m_header->sequence.store(m_vsync * 2, std::memory_order_release);
+}
@@ -27,7 +27,11 @@
 
 #include "Utilities/PersistentThread.h"
 #include "System/SysThreads.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
 #include <string>
+#include <vector>
 #ifdef _WIN32
 #include <WinSock2.h>
 #include <windows.h>
@@ -40,6 +44,9 @@ class SocketIPC : public pxThread
 	// parent thread
 	typedef pxThread _parent;
 
+	// the shared memory transport reuses the range helpers.
+	friend class SharedMemoryIPC;
+
 protected:
 #ifdef _WIN32
 	// windows claim to have support for AF_UNIX sockets but that is a blatant lie,
@@ -105,6 +112,11 @@ protected:
 		MsgUUID = 0xD,          /**< Returns the game UUID. */
 		MsgGameVersion = 0xE,   /**< Returns the game verion. */
 		MsgStatus = 0xF,        /**< Returns the emulator status. */
+		MsgReadRange = 0x10,    /**< Reads a contiguous range of memory. */
+		MsgWriteRange = 0x11,   /**< Writes a contiguous range of memory. */
+		MsgReadScatter = 0x12,  /**< Reads a list of ranges in one reply. */
+		MsgWatchSet = 0x13,     /**< Sets the ranges sampled at every vsync. */
+		MsgWatchWait = 0x14,    /**< Waits for the next vsync sample. */
 		MsgUnimplemented = 0xFF /**< Unimplemented IPC message. */
 	};
 
@@ -119,6 +131,35 @@ protected:
 		Shutdown = 2 /**< Game is shutdown */
 	};
 
+	/**
+	 * Memory spaces addressable by the range commands.
+	 * EE addresses are virtual, all others are offsets into the given memory.
+	 * EE ranges must only cover pages mapped to memory (no I/O registers or
+	 * unmapped pages).
+	 * Only EE, VU0 and VU1 data memory can be written to.
+	 */
+	enum IPCMemSpace : unsigned char
+	{
+		SpaceEE = 0,       /**< EE virtual memory. */
+		SpaceIOP = 1,      /**< IOP main memory. */
+		SpaceVU0 = 2,      /**< VU0 data memory. */
+		SpaceVU1 = 3,      /**< VU1 data memory. */
+		SpaceVU0Micro = 4, /**< VU0 micro memory. */
+		SpaceVU1Micro = 5, /**< VU1 micro memory. */
+		SpaceGS = 6        /**< GS privileged registers. */
+	};
+
+	/**
+	 * A memory range as sent by the range commands.
+	 * format: [space u8][address u32][size u32]
+	 */
+	struct IPCRange
+	{
+		u8 space;
+		u32 addr;
+		u32 size;
+	};
+
 	/**
 	 * IPC message buffer. 
 	 * A list of all needed fields to store an IPC message.
@@ -144,6 +185,20 @@ protected:
 	// handle to the main vm thread
 	SysCoreThread* m_vm;
 
+	/**
+	 * Watched ranges, sampled on the core thread at every vsync so that a
+	 * client gets one consistent snapshot per frame instead of polling.
+	 * m_watch_vsync counts the samples taken, m_watch_delivered is the last
+	 * one sent back by MsgWatchWait.
+	 */
+	std::mutex m_watch_mutex;
+	std::condition_variable m_watch_cv;
+	std::vector<IPCRange> m_watch_list;
+	std::vector<char> m_watch_data;
+	u32 m_watch_vsync = 0;
+	u32 m_watch_delivered = 0;
+	std::atomic<bool> m_watch_active{false};
+
 	// Thread used to relay IPC commands.
 	void ExecuteTaskInThread();
 
@@ -166,6 +221,22 @@ protected:
 	static inline char* MakeOkIPC(char* ret_buffer, uint32_t size);
 	static inline char* MakeFailIPC(char* ret_buffer, uint32_t size);
 
+	/**
+	 * Parses a list of ranges of the form [count u32]{[space u8][addr u32][size u32]}.
+	 * return value: false if the list doesn't fit in the command, is invalid,
+	 *               or its data would not fit in a reply of reply_space bytes.
+	 */
+	static bool IsReadableRange(const IPCRange& range);
+	static bool ParseRanges(char* buf, u32& buf_cnt, u32 buf_size, u32 reply_space, std::vector<IPCRange>& ranges);
+
+	/**
+	 * Copies a range of emulated memory from or to a host buffer.
+	 * return value: false if the range is out of bounds or not writable.
+	 */
+	static u8* GetRangePtr(const IPCRange& range, bool write);
+	static bool ReadRange(const IPCRange& range, char* dest);
+	static bool WriteRange(const IPCRange& range, const char* src);
+
 	/**
 	 * Initializes an open socket for IPC communication.
 	 * return value: -1 if a fatal failure happened, 0 otherwise. 
@@ -221,4 +292,106 @@ public:
 	SocketIPC(SysCoreThread* vm, unsigned int slot = IPC_DEFAULT_SLOT);
 	virtual ~SocketIPC();
 
+	// Samples the watched ranges; called by the core thread at each vsync.
+	void OnVsync();
+
 }; // class SocketIPC
+
+// --------------------------------------------------------------------------------------
+//  Shared memory transport
+// --------------------------------------------------------------------------------------
+// Local clients that poll memory every frame can skip the socket entirely by mapping
+// the region exported under IPC_SHM_NAME (shm_open on POSIX, a named file mapping on
+// Windows, suffixed with the slot like the socket).  It holds a header, a ring of
+// request slots and a mirror of EE main memory.
+//
+// Everything is serviced by the core thread at vsync, so every reply is a consistent
+// snapshot of one frame:
+//  * sequence is a seqlock: it is odd while the emulator updates the mirror and slots,
+//    and sequence / 2 counts the frames published so far.  Clients copy what they need and retry if the
+//    sequence changed meanwhile.
+//  * the EE memory mirror is laid out like main memory, but only the ranges registered in
+//    mirror_ranges are refreshed, so the cost per frame follows what clients actually
+//    watch.  Entries move Free -> Claimed (client CAS) -> Active (client, after filling
+//    addr/size, an offset into EE main memory) -> Free (client, when done).  Clients
+//    should map the mirror read-only.
+//  * request slots move Free -> Claimed (client CAS) -> Pending (client, after filling
+//    space/addr/size) -> Done or Failed (emulator, with data and vsync filled) -> Free
+//    (client, once the reply is consumed).  Ranges use the IPCMemSpace numbering of
+//    the socket range commands and are read-only.
+
+#define IPC_SHM_NAME IPC_EMULATOR_NAME ".shm"
+#define IPC_SHM_MAGIC 0x4D485350 // "PSHM"
+#define IPC_SHM_VERSION 2
+#define IPC_SHM_SLOTS 64
+#define IPC_SHM_SLOT_SIZE 4096
+#define IPC_SHM_MIRROR_RANGES 64
+
+enum IPCSharedSlotState : u32
+{
+	ShmSlotFree = 0,
+	ShmSlotClaimed = 1,
+	ShmSlotPending = 2,
+	ShmSlotDone = 3,
+	ShmSlotFailed = 4
+};
+
+enum IPCSharedMirrorState : u32
+{
+	ShmMirrorFree = 0,
+	ShmMirrorClaimed = 1,
+	ShmMirrorActive = 2
+};
+
+struct IPCSharedMirrorRange
+{
+	std::atomic<u32> state;
+	u32 addr;
+	u32 size;
+};
+
+struct IPCSharedSlot
+{
+	std::atomic<u32> state;
+	u32 space;
+	u32 addr;
+	u32 size;
+	u32 vsync;
+	u8 data[IPC_SHM_SLOT_SIZE];
+};
+
+struct IPCSharedHeader
+{
+	u32 magic;
+	u32 version;
+	u32 slot_count;
+	u32 ram_offset; // offset of the EE memory mirror from the start of the region
+	u32 ram_size;
+	std::atomic<u32> sequence;
+	IPCSharedMirrorRange mirror_ranges[IPC_SHM_MIRROR_RANGES];
+	IPCSharedSlot slots[IPC_SHM_SLOTS];
+};
+
+class SharedMemoryIPC
+{
+protected:
+#ifdef _WIN32
+	HANDLE m_mapping = nullptr;
+#else
+	std::string m_name;
+	int m_fd = -1;
+#endif
+	size_t m_size = 0;
+	IPCSharedHeader* m_header = nullptr;
+	u8* m_ram = nullptr;
+	u32 m_vsync = 0;
+
+public:
+	SharedMemoryIPC(unsigned int slot = IPC_DEFAULT_SLOT);
+	virtual ~SharedMemoryIPC();
+
+	bool IsOk() const { return m_header != nullptr; }
+
+	// Publishes the current frame; called by the core thread at each vsync.
+	void OnVsync();
+};
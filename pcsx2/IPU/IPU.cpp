@@ -669,39 +669,14 @@ static void ipuSETTH(u32 val)
 // --------------------------------------------------------------------------------------
 __fi void ipu_csc(macroblock_8& mb8, macroblock_rgb32& rgb32, int sgn)
 {
-	int i;
-	u8* p = (u8*)&rgb32;
-
 	yuv2rgb();
 
-	if (s_thresh[0] > 0)
-	{
-		for (i = 0; i < 16*16; i++, p += 4)
-		{
-			if ((p[0] < s_thresh[0]) && (p[1] < s_thresh[0]) && (p[2] < s_thresh[0]))
-				*(u32*)p = 0;
-			else if ((p[0] < s_thresh[1]) && (p[1] < s_thresh[1]) && (p[2] < s_thresh[1]))
-				p[3] = 0x40;
-		}
-	}
-	else if (s_thresh[1] > 0)
-	{
-		for (i = 0; i < 16*16; i++, p += 4)
-		{
-			if ((p[0] < s_thresh[1]) && (p[1] < s_thresh[1]) && (p[2] < s_thresh[1]))
-				p[3] = 0x40;
-		}
-	}
-	if (sgn)
-	{
-		for (i = 0; i < 16*16; i++, p += 4)
-		{
-			*(u32*)p ^= 0x808080;
-		}
-	}
+	if (s_thresh[0] > 0 || s_thresh[1] > 0 || sgn)
+		ipu_csc_alpha(rgb32, s_thresh[0], s_thresh[1], sgn);
 }
 
-__fi void ipu_vq(macroblock_rgb16& rgb16, u8* indx4)
+// conforming implementation for reference, do not optimise
+void ipu_vq_reference(macroblock_rgb16& rgb16, u8* indx4)
 {
 	const auto closest_index = [&](int i, int j) {
 		u8 index = 0;
@@ -729,6 +704,98 @@ __fi void ipu_vq(macroblock_rgb16& rgb16, u8* indx4)
 			indx4[i * 8 + j] = closest_index(i, 2 * j + 1) << 4 | closest_index(i, 2 * j);
 }
 
+// Distances are at most 3 * 31^2, so they fit in 16 bits.  The first closest CLUT entry
+// wins, as in the reference.
+static __fi __m128i vq_closest_sse41(__m128i rgb16, const __m128i (&clut)[16][3])
+{
+	const __m128i mask5 = _mm_set1_epi16(0x1F);
+	const __m128i r = _mm_and_si128(rgb16, mask5);
+	const __m128i g = _mm_and_si128(_mm_srli_epi16(rgb16, 5), mask5);
+	const __m128i b = _mm_and_si128(_mm_srli_epi16(rgb16, 10), mask5);
+
+	__m128i min_distance = _mm_set1_epi16(0x7FFF);
+	__m128i index = _mm_setzero_si128();
+	for (int k = 0; k < 16; ++k)
+	{
+		const __m128i dr = _mm_sub_epi16(r, clut[k][0]);
+		const __m128i dg = _mm_sub_epi16(g, clut[k][1]);
+		const __m128i db = _mm_sub_epi16(b, clut[k][2]);
+		const __m128i distance = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(dr, dr), _mm_mullo_epi16(dg, dg)), _mm_mullo_epi16(db, db));
+
+		const __m128i closer = _mm_cmpgt_epi16(min_distance, distance);
+		min_distance = _mm_min_epi16(min_distance, distance);
+		index = _mm_blendv_epi8(index, _mm_set1_epi16(k), closer);
+	}
+
+	// Odd pixels in the high nibble
+	return _mm_and_si128(_mm_or_si128(index, _mm_srli_epi32(index, 12)), _mm_set1_epi32(0xFF));
+}
+
+static void ipu_vq_sse41(macroblock_rgb16& rgb16, u8* indx4)
+{
+	__m128i clut[16][3];
+	for (int k = 0; k < 16; ++k)
+	{
+		clut[k][0] = _mm_set1_epi16(vqclut[k].r);
+		clut[k][1] = _mm_set1_epi16(vqclut[k].g);
+		clut[k][2] = _mm_set1_epi16(vqclut[k].b);
+	}
+
+	for (int i = 0; i < 16; ++i)
+	{
+		const __m128i lo = vq_closest_sse41(_mm_load_si128(reinterpret_cast<const __m128i*>(&rgb16.c[i][0])), clut);
+		const __m128i hi = vq_closest_sse41(_mm_load_si128(reinterpret_cast<const __m128i*>(&rgb16.c[i][8])), clut);
+		const __m128i packed = _mm_packus_epi32(lo, hi);
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(indx4 + i * 8), _mm_packus_epi16(packed, packed));
+	}
+}
+
+static __ipu_avx2 void ipu_vq_avx2(macroblock_rgb16& rgb16, u8* indx4)
+{
+	__m256i clut[16][3];
+	for (int k = 0; k < 16; ++k)
+	{
+		clut[k][0] = _mm256_set1_epi16(vqclut[k].r);
+		clut[k][1] = _mm256_set1_epi16(vqclut[k].g);
+		clut[k][2] = _mm256_set1_epi16(vqclut[k].b);
+	}
+
+	const __m256i mask5 = _mm256_set1_epi16(0x1F);
+	for (int i = 0; i < 16; ++i)
+	{
+		const __m256i rgb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&rgb16.c[i][0]));
+		const __m256i r = _mm256_and_si256(rgb, mask5);
+		const __m256i g = _mm256_and_si256(_mm256_srli_epi16(rgb, 5), mask5);
+		const __m256i b = _mm256_and_si256(_mm256_srli_epi16(rgb, 10), mask5);
+
+		__m256i min_distance = _mm256_set1_epi16(0x7FFF);
+		__m256i index = _mm256_setzero_si256();
+		for (int k = 0; k < 16; ++k)
+		{
+			const __m256i dr = _mm256_sub_epi16(r, clut[k][0]);
+			const __m256i dg = _mm256_sub_epi16(g, clut[k][1]);
+			const __m256i db = _mm256_sub_epi16(b, clut[k][2]);
+			const __m256i distance = _mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(dr, dr), _mm256_mullo_epi16(dg, dg)), _mm256_mullo_epi16(db, db));
+
+			const __m256i closer = _mm256_cmpgt_epi16(min_distance, distance);
+			min_distance = _mm256_min_epi16(min_distance, distance);
+			index = _mm256_blendv_epi8(index, _mm256_set1_epi16(k), closer);
+		}
+
+		index = _mm256_and_si256(_mm256_or_si256(index, _mm256_srli_epi32(index, 12)), _mm256_set1_epi32(0xFF));
+		const __m128i packed = _mm_packus_epi32(_mm256_castsi256_si128(index), _mm256_extracti128_si256(index, 1));
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(indx4 + i * 8), _mm_packus_epi16(packed, packed));
+	}
+}
+
+__fi void ipu_vq(macroblock_rgb16& rgb16, u8* indx4)
+{
+	if (x86caps.hasAVX2)
+		ipu_vq_avx2(rgb16, indx4);
+	else
+		ipu_vq_sse41(rgb16, indx4);
+}
+
 
 // --------------------------------------------------------------------------------------
 //  Buffer reader
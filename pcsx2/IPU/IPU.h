@@ -23,6 +23,16 @@
 #define IPU_INT_TO( cycles )  if(!(cpuRegs.interrupt & (1<<4))) CPU_INT( DMAC_TO_IPU, cycles )
 #define IPU_INT_FROM( cycles )  CPU_INT( DMAC_FROM_IPU, cycles )
 
+// The AVX2 versions of the IPU routines are built for any CPU and only called when
+// x86caps.hasAVX2 is set.  MSVC accepts the AVX2 intrinsics without an attribute.
+// GCC can't inline them into code built without AVX2, so they must not be __fi or
+// __ri (which force inlining in release builds) unless only AVX2 code calls them.
+#ifdef _MSC_VER
+#define __ipu_avx2
+#else
+#define __ipu_avx2 __attribute__((target("avx2")))
+#endif
+
 //
 // Bitfield Structures
 //
@@ -23,10 +23,14 @@
 
 void ipu_dither_reference(const macroblock_rgb32 &rgb32, macroblock_rgb16 &rgb16, int dte);
 void ipu_dither_sse2(const macroblock_rgb32 &rgb32, macroblock_rgb16 &rgb16, int dte);
+static void ipu_dither_avx2(const macroblock_rgb32 &rgb32, macroblock_rgb16 &rgb16, int dte);
 
 __ri void ipu_dither(const macroblock_rgb32 &rgb32, macroblock_rgb16 &rgb16, int dte)
 {
-    ipu_dither_sse2(rgb32, rgb16, dte);
+    if (x86caps.hasAVX2)
+        ipu_dither_avx2(rgb32, rgb16, dte);
+    else
+        ipu_dither_sse2(rgb32, rgb16, dte);
 }
 
 __ri void ipu_dither_reference(const macroblock_rgb32 &rgb32, macroblock_rgb16 &rgb16, int dte)
@@ -120,3 +124,65 @@ __ri void ipu_dither_sse2(const macroblock_rgb32 &rgb32, macroblock_rgb16 &rgb16
         }
     }
 }
+
+// Same as ipu_dither_sse2, a whole row at a time: the low lane holds pixels 0-7 and the
+// high lane pixels 8-15.
+static __ipu_avx2 void ipu_dither_avx2(const macroblock_rgb32 &rgb32, macroblock_rgb16 &rgb16, int dte)
+{
+    const __m256i alpha_test = _mm256_set1_epi16(0x40);
+    const __m256i dither_add_matrix[] = {
+        _mm256_setr_epi32(0x00000000, 0x00000000, 0x00000000, 0x00010101, 0x00000000, 0x00000000, 0x00000000, 0x00010101),
+        _mm256_setr_epi32(0x00020202, 0x00000000, 0x00030303, 0x00000000, 0x00020202, 0x00000000, 0x00030303, 0x00000000),
+        _mm256_setr_epi32(0x00000000, 0x00010101, 0x00000000, 0x00000000, 0x00000000, 0x00010101, 0x00000000, 0x00000000),
+        _mm256_setr_epi32(0x00030303, 0x00000000, 0x00020202, 0x00000000, 0x00030303, 0x00000000, 0x00020202, 0x00000000),
+    };
+    const __m256i dither_sub_matrix[] = {
+        _mm256_setr_epi32(0x00040404, 0x00000000, 0x00030303, 0x00000000, 0x00040404, 0x00000000, 0x00030303, 0x00000000),
+        _mm256_setr_epi32(0x00000000, 0x00020202, 0x00000000, 0x00010101, 0x00000000, 0x00020202, 0x00000000, 0x00010101),
+        _mm256_setr_epi32(0x00030303, 0x00000000, 0x00040404, 0x00000000, 0x00030303, 0x00000000, 0x00040404, 0x00000000),
+        _mm256_setr_epi32(0x00000000, 0x00010101, 0x00000000, 0x00020202, 0x00000000, 0x00010101, 0x00000000, 0x00020202),
+    };
+    for (int i = 0; i < 16; ++i) {
+        const __m256i dither_add = dither_add_matrix[i & 3];
+        const __m256i dither_sub = dither_sub_matrix[i & 3];
+
+        __m256i rgba_8_0123 = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i *>(&rgb32.c[i][0]))),
+            _mm_load_si128(reinterpret_cast<const __m128i *>(&rgb32.c[i][8])), 1);
+        __m256i rgba_8_4567 = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i *>(&rgb32.c[i][4]))),
+            _mm_load_si128(reinterpret_cast<const __m128i *>(&rgb32.c[i][12])), 1);
+
+        // Dither and clamp
+        if (dte) {
+            rgba_8_0123 = _mm256_adds_epu8(rgba_8_0123, dither_add);
+            rgba_8_0123 = _mm256_subs_epu8(rgba_8_0123, dither_sub);
+            rgba_8_4567 = _mm256_adds_epu8(rgba_8_4567, dither_add);
+            rgba_8_4567 = _mm256_subs_epu8(rgba_8_4567, dither_sub);
+        }
+
+        // Split into channel components and extend to 16 bits
+        const __m256i rgba_16_0415 = _mm256_unpacklo_epi8(rgba_8_0123, rgba_8_4567);
+        const __m256i rgba_16_2637 = _mm256_unpackhi_epi8(rgba_8_0123, rgba_8_4567);
+        const __m256i rgba_32_0246 = _mm256_unpacklo_epi8(rgba_16_0415, rgba_16_2637);
+        const __m256i rgba_32_1357 = _mm256_unpackhi_epi8(rgba_16_0415, rgba_16_2637);
+        const __m256i rg_64_01234567 = _mm256_unpacklo_epi8(rgba_32_0246, rgba_32_1357);
+        const __m256i ba_64_01234567 = _mm256_unpackhi_epi8(rgba_32_0246, rgba_32_1357);
+
+        const __m256i zero = _mm256_setzero_si256();
+        __m256i r = _mm256_unpacklo_epi8(rg_64_01234567, zero);
+        __m256i g = _mm256_unpackhi_epi8(rg_64_01234567, zero);
+        __m256i b = _mm256_unpacklo_epi8(ba_64_01234567, zero);
+        __m256i a = _mm256_unpackhi_epi8(ba_64_01234567, zero);
+
+        // Create RGBA
+        r = _mm256_srli_epi16(r, 3);
+        g = _mm256_slli_epi16(_mm256_srli_epi16(g, 3), 5);
+        b = _mm256_slli_epi16(_mm256_srli_epi16(b, 3), 10);
+        a = _mm256_slli_epi16(_mm256_cmpeq_epi16(a, alpha_test), 15);
+
+        const __m256i rgba16 = _mm256_or_si256(_mm256_or_si256(r, g), _mm256_or_si256(b, a));
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(&rgb16.c[i][0]), rgba16);
+    }
+}
@@ -22,10 +22,6 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
  */
 
-// [TODO] : There are modern SSE versions of idct (idct_mmx.c) in the mpeg2 libs that we
-// should probably upgrade to.  They use their own raw-style intrinsics and not the intel
-// compiler-integrated ones.
-
 #include "PrecompiledHeader.h"
 
 #include "Common.h"
@@ -39,16 +35,6 @@
 #define W6 1108 /* 2048*sqrt (2)*cos (6*pi/16) */
 #define W7 565  /* 2048*sqrt (2)*cos (7*pi/16) */
 
-/*
- * In legal streams, the IDCT output should be between -384 and +384.
- * In corrupted streams, it is possible to force the IDCT output to go
- * to +-3826 - this is the worst case for a column IDCT where the
- * column inputs are 16-bit values.
- */
-static __aligned16 u8 clip_lut[1024];
-
-#define CLIP(i) ((clip_lut+384)[(i)])
-
 static __fi void BUTTERFLY(int& t0, int& t1, int w0, int w1, int d0, int d1)
 {
 #if 0
@@ -155,7 +141,8 @@ static __fi void idct_col (s16 * const block)
     block[8*7] = (a0 - b0) >> 17;
 }
 
-__ri void mpeg2_idct_copy(s16 * block, u8 * dest, const int stride)
+// conforming implementation for reference, do not optimise
+void mpeg2_idct_reference(s16 * block)
 {
     int i;
 
@@ -163,23 +150,220 @@ __ri void mpeg2_idct_copy(s16 * block, u8 * dest, const int stride)
 		idct_row (block + 8 * i);
     for (i = 0; i < 8; i++)
 		idct_col (block + i);
+}
 
-	__m128 zero = _mm_setzero_ps();
-    do {
-		dest[0] = CLIP (block[0]);
-		dest[1] = CLIP (block[1]);
-		dest[2] = CLIP (block[2]);
-		dest[3] = CLIP (block[3]);
-		dest[4] = CLIP (block[4]);
-		dest[5] = CLIP (block[5]);
-		dest[6] = CLIP (block[6]);
-		dest[7] = CLIP (block[7]);
+// The vectorized versions run the same integer arithmetic on 32 bit lanes, one row
+// (or column) per lane, so they are bit-exact with idct_row/idct_col.  The rows are
+// transposed before the row pass and back before the column pass.  The row pass
+// shortcut gives the same result as the full computation, so it isn't needed.
 
-		_mm_store_ps((float*)block, zero);
+static __fi void idct_transpose(__m128i (&r)[8])
+{
+	const __m128i a0 = _mm_unpacklo_epi16(r[0], r[1]);
+	const __m128i a1 = _mm_unpackhi_epi16(r[0], r[1]);
+	const __m128i a2 = _mm_unpacklo_epi16(r[2], r[3]);
+	const __m128i a3 = _mm_unpackhi_epi16(r[2], r[3]);
+	const __m128i a4 = _mm_unpacklo_epi16(r[4], r[5]);
+	const __m128i a5 = _mm_unpackhi_epi16(r[4], r[5]);
+	const __m128i a6 = _mm_unpacklo_epi16(r[6], r[7]);
+	const __m128i a7 = _mm_unpackhi_epi16(r[6], r[7]);
+
+	const __m128i b0 = _mm_unpacklo_epi32(a0, a2);
+	const __m128i b1 = _mm_unpackhi_epi32(a0, a2);
+	const __m128i b2 = _mm_unpacklo_epi32(a1, a3);
+	const __m128i b3 = _mm_unpackhi_epi32(a1, a3);
+	const __m128i b4 = _mm_unpacklo_epi32(a4, a6);
+	const __m128i b5 = _mm_unpackhi_epi32(a4, a6);
+	const __m128i b6 = _mm_unpacklo_epi32(a5, a7);
+	const __m128i b7 = _mm_unpackhi_epi32(a5, a7);
+
+	r[0] = _mm_unpacklo_epi64(b0, b4);
+	r[1] = _mm_unpackhi_epi64(b0, b4);
+	r[2] = _mm_unpacklo_epi64(b1, b5);
+	r[3] = _mm_unpackhi_epi64(b1, b5);
+	r[4] = _mm_unpacklo_epi64(b2, b6);
+	r[5] = _mm_unpackhi_epi64(b2, b6);
+	r[6] = _mm_unpacklo_epi64(b3, b7);
+	r[7] = _mm_unpackhi_epi64(b3, b7);
+}
+
+// w0 * d0 + w1 * d1 and w0 * d1 - w1 * d0, computed as BUTTERFLY does
+#define IDCT_BUTTERFLY(set1, add, sub, mul, t0, t1, w0, w1, d0, d1) \
+	{ \
+		const auto tmp = mul(set1(w0), add(d0, d1)); \
+		t0 = add(tmp, mul(set1((w1) - (w0)), d1)); \
+		t1 = sub(tmp, mul(set1((w1) + (w0)), d0)); \
+	}
 
-		dest += stride;
-		block += 8;
-    } while (--i);
+// One pass of 4 lanes.  x[k] holds input k of each lane, the results replace them.
+template <bool col>
+static __fi void idct_pass_sse41(__m128i (&x)[8])
+{
+	__m128i t0, t1, t2, t3;
+
+	const __m128i d0 = _mm_add_epi32(_mm_slli_epi32(x[0], 11), _mm_set1_epi32(col ? 65536 : 128));
+	const __m128i d2 = _mm_slli_epi32(x[2], 11);
+	t0 = _mm_add_epi32(d0, d2);
+	t1 = _mm_sub_epi32(d0, d2);
+	IDCT_BUTTERFLY(_mm_set1_epi32, _mm_add_epi32, _mm_sub_epi32, _mm_mullo_epi32, t2, t3, W6, W2, x[3], x[1]);
+	const __m128i a0 = _mm_add_epi32(t0, t2);
+	const __m128i a1 = _mm_add_epi32(t1, t3);
+	const __m128i a2 = _mm_sub_epi32(t1, t3);
+	const __m128i a3 = _mm_sub_epi32(t0, t2);
+
+	IDCT_BUTTERFLY(_mm_set1_epi32, _mm_add_epi32, _mm_sub_epi32, _mm_mullo_epi32, t0, t1, W7, W1, x[7], x[4]);
+	IDCT_BUTTERFLY(_mm_set1_epi32, _mm_add_epi32, _mm_sub_epi32, _mm_mullo_epi32, t2, t3, W3, W5, x[5], x[6]);
+	const __m128i b0 = _mm_add_epi32(t0, t2);
+	const __m128i b3 = _mm_add_epi32(t1, t3);
+	__m128i b1, b2;
+	if (col) {
+		t0 = _mm_srai_epi32(_mm_sub_epi32(t0, t2), 8);
+		t1 = _mm_srai_epi32(_mm_sub_epi32(t1, t3), 8);
+		b1 = _mm_mullo_epi32(_mm_add_epi32(t0, t1), _mm_set1_epi32(181));
+		b2 = _mm_mullo_epi32(_mm_sub_epi32(t0, t1), _mm_set1_epi32(181));
+	} else {
+		t0 = _mm_sub_epi32(t0, t2);
+		t1 = _mm_sub_epi32(t1, t3);
+		b1 = _mm_srai_epi32(_mm_mullo_epi32(_mm_add_epi32(t0, t1), _mm_set1_epi32(181)), 8);
+		b2 = _mm_srai_epi32(_mm_mullo_epi32(_mm_sub_epi32(t0, t1), _mm_set1_epi32(181)), 8);
+	}
+
+	const int shift = col ? 17 : 8;
+	x[0] = _mm_srai_epi32(_mm_add_epi32(a0, b0), shift);
+	x[1] = _mm_srai_epi32(_mm_add_epi32(a1, b1), shift);
+	x[2] = _mm_srai_epi32(_mm_add_epi32(a2, b2), shift);
+	x[3] = _mm_srai_epi32(_mm_add_epi32(a3, b3), shift);
+	x[4] = _mm_srai_epi32(_mm_sub_epi32(a3, b3), shift);
+	x[5] = _mm_srai_epi32(_mm_sub_epi32(a2, b2), shift);
+	x[6] = _mm_srai_epi32(_mm_sub_epi32(a1, b1), shift);
+	x[7] = _mm_srai_epi32(_mm_sub_epi32(a0, b0), shift);
+}
+
+// Truncates two vectors of 32 bit results to 16 bits, like storing them to a s16 does
+static __fi __m128i idct_pack_sse41(__m128i lo, __m128i hi)
+{
+	lo = _mm_srai_epi32(_mm_slli_epi32(lo, 16), 16);
+	hi = _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16);
+	return _mm_packs_epi32(lo, hi);
+}
+
+template <bool col>
+static __fi void idct_pass8_sse41(__m128i (&r)[8])
+{
+	__m128i lo[8], hi[8];
+	for (int k = 0; k < 8; k++) {
+		lo[k] = _mm_cvtepi16_epi32(r[k]);
+		hi[k] = _mm_cvtepi16_epi32(_mm_srli_si128(r[k], 8));
+	}
+	idct_pass_sse41<col>(lo);
+	idct_pass_sse41<col>(hi);
+	for (int k = 0; k < 8; k++)
+		r[k] = idct_pack_sse41(lo[k], hi[k]);
+}
+
+static __fi void mpeg2_idct_sse41(s16 * block, __m128i (&r)[8])
+{
+	for (int k = 0; k < 8; k++)
+		r[k] = _mm_load_si128(reinterpret_cast<const __m128i*>(block + 8 * k));
+
+	idct_transpose(r);
+	idct_pass8_sse41<false>(r);
+	idct_transpose(r);
+	idct_pass8_sse41<true>(r);
+}
+
+template <bool col>
+static __fi __ipu_avx2 void idct_pass_avx2(__m256i (&x)[8])
+{
+	__m256i t0, t1, t2, t3;
+
+	const __m256i d0 = _mm256_add_epi32(_mm256_slli_epi32(x[0], 11), _mm256_set1_epi32(col ? 65536 : 128));
+	const __m256i d2 = _mm256_slli_epi32(x[2], 11);
+	t0 = _mm256_add_epi32(d0, d2);
+	t1 = _mm256_sub_epi32(d0, d2);
+	IDCT_BUTTERFLY(_mm256_set1_epi32, _mm256_add_epi32, _mm256_sub_epi32, _mm256_mullo_epi32, t2, t3, W6, W2, x[3], x[1]);
+	const __m256i a0 = _mm256_add_epi32(t0, t2);
+	const __m256i a1 = _mm256_add_epi32(t1, t3);
+	const __m256i a2 = _mm256_sub_epi32(t1, t3);
+	const __m256i a3 = _mm256_sub_epi32(t0, t2);
+
+	IDCT_BUTTERFLY(_mm256_set1_epi32, _mm256_add_epi32, _mm256_sub_epi32, _mm256_mullo_epi32, t0, t1, W7, W1, x[7], x[4]);
+	IDCT_BUTTERFLY(_mm256_set1_epi32, _mm256_add_epi32, _mm256_sub_epi32, _mm256_mullo_epi32, t2, t3, W3, W5, x[5], x[6]);
+	const __m256i b0 = _mm256_add_epi32(t0, t2);
+	const __m256i b3 = _mm256_add_epi32(t1, t3);
+	__m256i b1, b2;
+	if (col) {
+		t0 = _mm256_srai_epi32(_mm256_sub_epi32(t0, t2), 8);
+		t1 = _mm256_srai_epi32(_mm256_sub_epi32(t1, t3), 8);
+		b1 = _mm256_mullo_epi32(_mm256_add_epi32(t0, t1), _mm256_set1_epi32(181));
+		b2 = _mm256_mullo_epi32(_mm256_sub_epi32(t0, t1), _mm256_set1_epi32(181));
+	} else {
+		t0 = _mm256_sub_epi32(t0, t2);
+		t1 = _mm256_sub_epi32(t1, t3);
+		b1 = _mm256_srai_epi32(_mm256_mullo_epi32(_mm256_add_epi32(t0, t1), _mm256_set1_epi32(181)), 8);
+		b2 = _mm256_srai_epi32(_mm256_mullo_epi32(_mm256_sub_epi32(t0, t1), _mm256_set1_epi32(181)), 8);
+	}
+
+	const int shift = col ? 17 : 8;
+	x[0] = _mm256_srai_epi32(_mm256_add_epi32(a0, b0), shift);
+	x[1] = _mm256_srai_epi32(_mm256_add_epi32(a1, b1), shift);
+	x[2] = _mm256_srai_epi32(_mm256_add_epi32(a2, b2), shift);
+	x[3] = _mm256_srai_epi32(_mm256_add_epi32(a3, b3), shift);
+	x[4] = _mm256_srai_epi32(_mm256_sub_epi32(a3, b3), shift);
+	x[5] = _mm256_srai_epi32(_mm256_sub_epi32(a2, b2), shift);
+	x[6] = _mm256_srai_epi32(_mm256_sub_epi32(a1, b1), shift);
+	x[7] = _mm256_srai_epi32(_mm256_sub_epi32(a0, b0), shift);
+}
+
+template <bool col>
+static __fi __ipu_avx2 void idct_pass8_avx2(__m128i (&r)[8])
+{
+	__m256i x[8];
+	for (int k = 0; k < 8; k++)
+		x[k] = _mm256_cvtepi16_epi32(r[k]);
+	idct_pass_avx2<col>(x);
+	for (int k = 0; k < 8; k++) {
+		const __m256i v = _mm256_srai_epi32(_mm256_slli_epi32(x[k], 16), 16);
+		r[k] = _mm_packs_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+	}
+}
+
+static __ipu_avx2 void mpeg2_idct_avx2(s16 * block, __m128i (&r)[8])
+{
+	for (int k = 0; k < 8; k++)
+		r[k] = _mm_load_si128(reinterpret_cast<const __m128i*>(block + 8 * k));
+
+	idct_transpose(r);
+	idct_pass8_avx2<false>(r);
+	idct_transpose(r);
+	idct_pass8_avx2<true>(r);
+}
+
+// Leaves the 8 rows of the transformed block in r and clears the block.
+static __fi void mpeg2_idct(s16 * block, __m128i (&r)[8])
+{
+	if (x86caps.hasAVX2)
+		mpeg2_idct_avx2(block, r);
+	else
+		mpeg2_idct_sse41(block, r);
+
+	const __m128i zero = _mm_setzero_si128();
+	for (int k = 0; k < 8; k++)
+		_mm_store_si128(reinterpret_cast<__m128i*>(block + 8 * k), zero);
+}
+
+__ri void mpeg2_idct_copy(s16 * block, u8 * dest, const int stride)
+{
+	__m128i r[8];
+	mpeg2_idct(block, r);
+
+	// Saturating to 0..255 is what the clipping table of the reference decoder did
+	for (int k = 0; k < 8; k += 2) {
+		const __m128i rows = _mm_packus_epi16(r[k], r[k + 1]);
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(dest), rows);
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(dest + stride), _mm_srli_si128(rows, 8));
+		dest += stride * 2;
+	}
 }
 
 
@@ -190,21 +374,11 @@ __ri void mpeg2_idct_add (const int last, s16 * block, s16 * dest, const int str
 
     if (last != 129 || (block[0] & 7) == 4)
     {
-		int i;
-		for (i = 0; i < 8; i++)
-			idct_row (block + 8 * i);
-		for (i = 0; i < 8; i++)
-			idct_col (block + i);
-
-		__m128 zero = _mm_setzero_ps();
-		do {
-			_mm_store_ps((float*)dest, _mm_load_ps((float*)block));
-			_mm_store_ps((float*)block, zero);
-
-			dest += stride;
-			block += 8;
-		} while (--i);
+		__m128i r[8];
+		mpeg2_idct(block, r);
 
+		for (int k = 0; k < 8; k++)
+			_mm_store_si128(reinterpret_cast<__m128i*>(dest + stride * k), r[k]);
     }
     else
     {
@@ -237,9 +411,6 @@ mpeg2_scan_pack::mpeg2_scan_pack()
 		53, 61, 22, 30,  7, 15, 23, 31, 38, 46, 54, 62, 39, 47, 55, 63
 	};
 
-	for (int i = -384; i < 640; i++)
-		clip_lut[i+384] = (i < 0) ? 0 : ((i > 255) ? 255 : i);
-
 	for (int i = 0; i < 64; i++) {
 		int j = mpeg2_scan_norm[i];
 		norm[i] = ((j & 0x36) >> 1) | ((j & 0x09) << 2);
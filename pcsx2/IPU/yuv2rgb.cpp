@@ -59,9 +59,6 @@ void yuv2rgb_reference(void)
 }
 
 // Suikoden Tactics FMV speed results: Reference - ~72fps, SSE2 - ~120fps
-// An AVX2 version is only slightly faster than an SSE2 version (+2-3fps)
-// (or I'm a poor optimiser), though it might be worth attempting again
-// once we've ported to 64 bits (the extra registers should help).
 __ri void yuv2rgb_sse2()
 {
 	const __m128i c_bias = _mm_set1_epi8(s8(IPU_C_BIAS));
@@ -149,3 +146,189 @@ __ri void yuv2rgb_sse2()
 		}
 	}
 }
+
+// Same as yuv2rgb_sse2, with the two rows sharing a chroma row converted together
+// (one row per 128 bit lane).
+static __ipu_avx2 void yuv2rgb_avx2()
+{
+	const __m256i c_bias = _mm256_set1_epi8(s8(IPU_C_BIAS));
+	const __m256i y_bias = _mm256_set1_epi8(IPU_Y_BIAS);
+	const __m256i y_mask = _mm256_set1_epi16(s16(0xFF00));
+	const __m256i round_1bit = _mm256_set1_epi16(0x0001);
+
+	const __m256i y_coefficient = _mm256_set1_epi16(s16(IPU_Y_COEFF << 2));
+	const __m256i gcr_coefficient = _mm256_set1_epi16(s16(u16(IPU_GCR_COEFF) << 2));
+	const __m256i gcb_coefficient = _mm256_set1_epi16(s16(u16(IPU_GCB_COEFF) << 2));
+	const __m256i rcr_coefficient = _mm256_set1_epi16(s16(IPU_RCR_COEFF << 2));
+	const __m256i bcb_coefficient = _mm256_set1_epi16(s16(IPU_BCB_COEFF << 2));
+
+	const __m256i& alpha = c_bias;
+
+	for (int n = 0; n < 8; ++n) {
+		__m256i cb = _mm256_broadcastsi128_si256(_mm_loadl_epi64(reinterpret_cast<__m128i*>(&decoder.mb8.Cb[n][0])));
+		__m256i cr = _mm256_broadcastsi128_si256(_mm_loadl_epi64(reinterpret_cast<__m128i*>(&decoder.mb8.Cr[n][0])));
+
+		// (Cb - 128) << 8, (Cr - 128) << 8
+		cb = _mm256_xor_si256(cb, c_bias);
+		cr = _mm256_xor_si256(cr, c_bias);
+		cb = _mm256_unpacklo_epi8(_mm256_setzero_si256(), cb);
+		cr = _mm256_unpacklo_epi8(_mm256_setzero_si256(), cr);
+
+		__m256i rc = _mm256_mulhi_epi16(cr, rcr_coefficient);
+		__m256i gc = _mm256_adds_epi16(_mm256_mulhi_epi16(cr, gcr_coefficient), _mm256_mulhi_epi16(cb, gcb_coefficient));
+		__m256i bc = _mm256_mulhi_epi16(cb, bcb_coefficient);
+
+		// Rows n * 2 and n * 2 + 1
+		__m256i y = _mm256_inserti128_si256(
+			_mm256_castsi128_si256(_mm_load_si128(reinterpret_cast<__m128i*>(&decoder.mb8.Y[n * 2][0]))),
+			_mm_load_si128(reinterpret_cast<__m128i*>(&decoder.mb8.Y[n * 2 + 1][0])), 1);
+		y = _mm256_subs_epu8(y, y_bias);
+		__m256i y_even = _mm256_slli_epi16(y, 8);
+		__m256i y_odd = _mm256_and_si256(y, y_mask);
+
+		y_even = _mm256_mulhi_epu16(y_even, y_coefficient);
+		y_odd  = _mm256_mulhi_epu16(y_odd,  y_coefficient);
+
+		__m256i r_even = _mm256_adds_epi16(rc, y_even);
+		__m256i r_odd  = _mm256_adds_epi16(rc, y_odd);
+		__m256i g_even = _mm256_adds_epi16(gc, y_even);
+		__m256i g_odd  = _mm256_adds_epi16(gc, y_odd);
+		__m256i b_even = _mm256_adds_epi16(bc, y_even);
+		__m256i b_odd  = _mm256_adds_epi16(bc, y_odd);
+
+		// round
+		r_even = _mm256_srai_epi16(_mm256_add_epi16(r_even, round_1bit), 1);
+		r_odd  = _mm256_srai_epi16(_mm256_add_epi16(r_odd,  round_1bit), 1);
+		g_even = _mm256_srai_epi16(_mm256_add_epi16(g_even, round_1bit), 1);
+		g_odd  = _mm256_srai_epi16(_mm256_add_epi16(g_odd,  round_1bit), 1);
+		b_even = _mm256_srai_epi16(_mm256_add_epi16(b_even, round_1bit), 1);
+		b_odd  = _mm256_srai_epi16(_mm256_add_epi16(b_odd,  round_1bit), 1);
+
+		// combine even and odd bytes in original order
+		__m256i r = _mm256_packus_epi16(r_even, r_odd);
+		__m256i g = _mm256_packus_epi16(g_even, g_odd);
+		__m256i b = _mm256_packus_epi16(b_even, b_odd);
+
+		r = _mm256_unpacklo_epi8(r, _mm256_shuffle_epi32(r, _MM_SHUFFLE(3, 2, 3, 2)));
+		g = _mm256_unpacklo_epi8(g, _mm256_shuffle_epi32(g, _MM_SHUFFLE(3, 2, 3, 2)));
+		b = _mm256_unpacklo_epi8(b, _mm256_shuffle_epi32(b, _MM_SHUFFLE(3, 2, 3, 2)));
+
+		__m256i rg_l = _mm256_unpacklo_epi8(r, g);
+		__m256i ba_l = _mm256_unpacklo_epi8(b, alpha);
+		__m256i rgba_ll = _mm256_unpacklo_epi16(rg_l, ba_l);
+		__m256i rgba_lh = _mm256_unpackhi_epi16(rg_l, ba_l);
+
+		__m256i rg_h = _mm256_unpackhi_epi8(r, g);
+		__m256i ba_h = _mm256_unpackhi_epi8(b, alpha);
+		__m256i rgba_hl = _mm256_unpacklo_epi16(rg_h, ba_h);
+		__m256i rgba_hh = _mm256_unpackhi_epi16(rg_h, ba_h);
+
+		// Back from one row per lane to one row per store pair
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(&decoder.rgb32.c[n * 2][0]), _mm256_permute2x128_si256(rgba_ll, rgba_lh, 0x20));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(&decoder.rgb32.c[n * 2][8]), _mm256_permute2x128_si256(rgba_hl, rgba_hh, 0x20));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(&decoder.rgb32.c[n * 2 + 1][0]), _mm256_permute2x128_si256(rgba_ll, rgba_lh, 0x31));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(&decoder.rgb32.c[n * 2 + 1][8]), _mm256_permute2x128_si256(rgba_hl, rgba_hh, 0x31));
+	}
+}
+
+__ri void yuv2rgb()
+{
+	if (x86caps.hasAVX2)
+		yuv2rgb_avx2();
+	else
+		yuv2rgb_sse2();
+}
+
+// conforming implementation for reference, do not optimise
+void ipu_csc_alpha_reference(macroblock_rgb32& rgb32, u8 thresh0, u8 thresh1, int sgn)
+{
+	for (int y = 0; y < 16; y++)
+		for (int x = 0; x < 16; x++)
+		{
+			auto& c = rgb32.c[y][x];
+			const bool below0 = (c.r < thresh0) && (c.g < thresh0) && (c.b < thresh0);
+			const bool below1 = (c.r < thresh1) && (c.g < thresh1) && (c.b < thresh1);
+
+			if (below0)
+				c.r = c.g = c.b = c.a = 0;
+			else if (below1)
+				c.a = 0x40;
+
+			if (sgn)
+			{
+				c.r ^= 0x80;
+				c.g ^= 0x80;
+				c.b ^= 0x80;
+			}
+		}
+}
+
+// A pixel is below a threshold when all of its R, G and B bytes are: the saturated
+// threshold - byte difference is then non zero for the three of them.
+static __fi __m128i csc_below_sse41(__m128i rgba, __m128i thresh, __m128i rgb_mask)
+{
+	const __m128i above = _mm_cmpeq_epi8(_mm_subs_epu8(thresh, rgba), _mm_setzero_si128());
+	return _mm_cmpeq_epi32(_mm_and_si128(above, rgb_mask), _mm_setzero_si128());
+}
+
+__ri void ipu_csc_alpha_sse41(macroblock_rgb32& rgb32, u8 thresh0, u8 thresh1, int sgn)
+{
+	const __m128i rgb_mask = _mm_set1_epi32(0x00FFFFFF);
+	const __m128i alpha_40 = _mm_set1_epi32(0x40000000);
+	const __m128i sign = _mm_set1_epi32(sgn ? 0x00808080 : 0);
+	const __m128i t0 = _mm_set1_epi8(s8(thresh0));
+	const __m128i t1 = _mm_set1_epi8(s8(thresh1));
+
+	__m128i* p = reinterpret_cast<__m128i*>(&rgb32.c[0][0]);
+	for (int i = 0; i < 16 * 16 / 4; ++i)
+	{
+		__m128i rgba = _mm_load_si128(p + i);
+
+		const __m128i below0 = csc_below_sse41(rgba, t0, rgb_mask);
+		const __m128i below1 = _mm_andnot_si128(below0, csc_below_sse41(rgba, t1, rgb_mask));
+
+		rgba = _mm_andnot_si128(below0, rgba);
+		rgba = _mm_blendv_epi8(rgba, _mm_or_si128(_mm_and_si128(rgba, rgb_mask), alpha_40), below1);
+		rgba = _mm_xor_si128(rgba, sign);
+
+		_mm_store_si128(p + i, rgba);
+	}
+}
+
+static __fi __ipu_avx2 __m256i csc_below_avx2(__m256i rgba, __m256i thresh, __m256i rgb_mask)
+{
+	const __m256i above = _mm256_cmpeq_epi8(_mm256_subs_epu8(thresh, rgba), _mm256_setzero_si256());
+	return _mm256_cmpeq_epi32(_mm256_and_si256(above, rgb_mask), _mm256_setzero_si256());
+}
+
+static __ipu_avx2 void ipu_csc_alpha_avx2(macroblock_rgb32& rgb32, u8 thresh0, u8 thresh1, int sgn)
+{
+	const __m256i rgb_mask = _mm256_set1_epi32(0x00FFFFFF);
+	const __m256i alpha_40 = _mm256_set1_epi32(0x40000000);
+	const __m256i sign = _mm256_set1_epi32(sgn ? 0x00808080 : 0);
+	const __m256i t0 = _mm256_set1_epi8(s8(thresh0));
+	const __m256i t1 = _mm256_set1_epi8(s8(thresh1));
+
+	__m256i* p = reinterpret_cast<__m256i*>(&rgb32.c[0][0]);
+	for (int i = 0; i < 16 * 16 / 8; ++i)
+	{
+		__m256i rgba = _mm256_loadu_si256(p + i);
+
+		const __m256i below0 = csc_below_avx2(rgba, t0, rgb_mask);
+		const __m256i below1 = _mm256_andnot_si256(below0, csc_below_avx2(rgba, t1, rgb_mask));
+
+		rgba = _mm256_andnot_si256(below0, rgba);
+		rgba = _mm256_blendv_epi8(rgba, _mm256_or_si256(_mm256_and_si256(rgba, rgb_mask), alpha_40), below1);
+		rgba = _mm256_xor_si256(rgba, sign);
+
+		_mm256_storeu_si256(p + i, rgba);
+	}
+}
+
+__ri void ipu_csc_alpha(macroblock_rgb32& rgb32, u8 thresh0, u8 thresh1, int sgn)
+{
+	if (x86caps.hasAVX2)
+		ipu_csc_alpha_avx2(rgb32, thresh0, thresh1, sgn);
+	else
+		ipu_csc_alpha_sse41(rgb32, thresh0, thresh1, sgn);
+}
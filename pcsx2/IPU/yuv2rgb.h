@@ -15,7 +15,13 @@
 
 #pragma once
 
-extern void yuv2rgb_reference();
+struct macroblock_rgb32;
 
-#define yuv2rgb yuv2rgb_sse2
+extern void yuv2rgb_reference();
 extern void yuv2rgb_sse2();
+extern void yuv2rgb();
+
+// Alpha thresholding (SETTH) and sign conversion, applied to the output of yuv2rgb
+extern void ipu_csc_alpha_reference(macroblock_rgb32& rgb32, u8 thresh0, u8 thresh1, int sgn);
+extern void ipu_csc_alpha_sse41(macroblock_rgb32& rgb32, u8 thresh0, u8 thresh1, int sgn);
+extern void ipu_csc_alpha(macroblock_rgb32& rgb32, u8 thresh0, u8 thresh1, int sgn);
@@ -16,11 +16,34 @@
 #include "PrecompiledHeader.h"
 #include "AsyncFileReader.h"
 
+#include <errno.h>
+
 FlatFileReader::FlatFileReader(bool shareWrite) : shareWrite(shareWrite)
 {
 	m_blocksize = 2048;
 	m_fd = -1;
 	m_aio_context = 0;
+	m_filesize = 0;
+
+	for (ReadaheadSlot& slot : m_readahead)
+	{
+		slot.capacity = 0;
+		slot.offset = 0;
+		slot.length = 0;
+		slot.result = 0;
+		slot.inFlight = false;
+		slot.ready = false;
+		slot.discard = false;
+	}
+
+	m_demand_pending = false;
+	m_demand_result = 0;
+	m_demand_slot = NULL;
+	m_demand_buffer = NULL;
+	m_demand_offset = 0;
+	m_demand_length = 0;
+	m_next_offset = 0;
+	m_readahead_end = 0;
 }
 
 FlatFileReader::~FlatFileReader(void)
@@ -36,6 +59,7 @@ bool FlatFileReader::Open(const wxString& fileName)
 	if (err) return false;
 
     m_fd = wxOpen(fileName, O_RDONLY, 0);
+	m_filesize = Path::GetFileSize(fileName);
 
 	return (m_fd != -1);
 }
@@ -46,6 +70,100 @@ int FlatFileReader::ReadSync(void* pBuffer, uint sector, uint count)
 	return FinishRead();
 }
 
+// Collects completed requests and updates the demand/readahead state.
+// min_nr = 0 polls without blocking. Returns the number of events or -1.
+int FlatFileReader::ReapEvents(int min_nr)
+{
+	struct io_event events[ReadaheadSlots + 1];
+	struct timespec no_wait = {0, 0};
+
+	// A signal (the profiler's SIGPROF, for one) interrupts the wait without restarting it
+	int count;
+	do
+	{
+		count = io_getevents(m_aio_context, min_nr, ReadaheadSlots + 1, events, min_nr ? NULL : &no_wait);
+	} while (count == -EINTR);
+
+	if (count < 0)
+		return -1;
+
+	for (int i = 0; i < count; i++)
+	{
+		struct iocb* cb = events[i].obj;
+		long res = (long)events[i].res;
+
+		if (cb == &m_demand_cb)
+		{
+			m_demand_pending = false;
+			m_demand_result = res;
+			continue;
+		}
+
+		ReadaheadSlot* slot = (ReadaheadSlot*)cb->data;
+		slot->inFlight = false;
+		slot->result = res;
+		slot->ready = !slot->discard && res > 0;
+		slot->discard = false;
+
+		// Only the bytes actually read may be served from the slot
+		if (slot->ready && (u64)res < slot->length)
+			slot->length = (u32)res;
+	}
+
+	return count;
+}
+
+void FlatFileReader::DropReadahead()
+{
+	for (ReadaheadSlot& slot : m_readahead)
+	{
+		if (slot.inFlight)
+			slot.discard = true;
+		slot.ready = false;
+	}
+
+	m_readahead_end = 0;
+}
+
+// Queues reads of `length` bytes following the current request into every
+// slot that is idle or already behind the stream position `from`.
+void FlatFileReader::QueueReadahead(u64 from, u32 length)
+{
+	if (m_readahead_end < from)
+		m_readahead_end = from;
+
+	for (ReadaheadSlot& slot : m_readahead)
+	{
+		if (m_readahead_end >= (u64)m_filesize)
+			break;
+
+		if (slot.inFlight || &slot == m_demand_slot)
+			continue;
+		if (slot.ready && slot.offset + slot.length > from)
+			continue;
+
+		if (slot.capacity < length)
+		{
+			slot.buffer.reset(new u8[length]);
+			slot.capacity = length;
+		}
+
+		slot.offset = m_readahead_end;
+		slot.length = (u32)std::min<u64>(length, m_filesize - m_readahead_end);
+		slot.ready = false;
+
+		struct iocb* cbs = &slot.cb;
+		io_prep_pread(&slot.cb, m_fd, slot.buffer.get(), slot.length, slot.offset);
+		slot.cb.data = &slot;
+
+		if (io_submit(m_aio_context, 1, &cbs) != 1)
+			break;
+
+		slot.inFlight = true;
+		m_readahead_end += slot.length;
+	}
+}
+
 void FlatFileReader::BeginRead(void* pBuffer, uint sector, uint count)
 {
 	u64 offset;
@@ -53,21 +171,75 @@ void FlatFileReader::BeginRead(void* pBuffer, uint sector, uint count)
 
 	u32 bytesToRead = count * m_blocksize;
 
-	struct iocb iocb;
-	struct iocb* iocbs = &iocb;
+	// Pick up whatever finished while the caller was busy
+	ReapEvents(0);
+
+	const bool sequential = (offset == m_next_offset);
+	if (!sequential)
+		DropReadahead();
+	m_next_offset = offset + bytesToRead;
 
-	io_prep_pread(&iocb, m_fd, pBuffer, bytesToRead, offset);
-	io_submit(m_aio_context, 1, &iocbs);
+	m_demand_slot = NULL;
+	for (ReadaheadSlot& slot : m_readahead)
+	{
+		if ((slot.ready || (slot.inFlight && !slot.discard))
+			&& offset >= slot.offset && offset + bytesToRead <= slot.offset + slot.length)
+		{
+			m_demand_slot = &slot;
+			m_demand_buffer = pBuffer;
+			m_demand_offset = offset;
+			m_demand_length = bytesToRead;
+			break;
+		}
+	}
+
+	if (!m_demand_slot)
+		SubmitDemand(pBuffer, offset, bytesToRead);
+
+	// Random access wouldn't use the prefetched data
+	if (sequential)
+		QueueReadahead(offset + bytesToRead, bytesToRead);
+}
+
+void FlatFileReader::SubmitDemand(void* pBuffer, u64 offset, u32 length)
+{
+	struct iocb* iocbs = &m_demand_cb;
+
+	io_prep_pread(&m_demand_cb, m_fd, pBuffer, length, offset);
+	m_demand_pending = io_submit(m_aio_context, 1, &iocbs) == 1;
+	m_demand_result = m_demand_pending ? 0 : -1;
 }
 
 int FlatFileReader::FinishRead(void)
 {
-	int min_nr = 1;
-	int max_nr = 1;
-	struct io_event events[max_nr];
+	if (m_demand_slot)
+	{
+		ReadaheadSlot* slot = m_demand_slot;
+		m_demand_slot = NULL;
+
+		while (slot->inFlight)
+		{
+			if (ReapEvents(1) < 0)
+				return -1;
+		}
+
+		if (slot->ready && m_demand_offset + m_demand_length <= slot->offset + slot->length)
+		{
+			memcpy(m_demand_buffer, slot->buffer.get() + (m_demand_offset - slot->offset), m_demand_length);
+			return 1;
+		}
+
+		// The prefetch failed or came back short, read the request itself
+		SubmitDemand(m_demand_buffer, m_demand_offset, m_demand_length);
+	}
+
+	while (m_demand_pending)
+	{
+		if (ReapEvents(1) < 0)
+			return -1;
+	}
 
-	int event = io_getevents(m_aio_context, min_nr, max_nr, events, NULL);
-	if (event < 1) {
+	if (m_demand_result < 0) {
 		return -1;
 	}
 
@@ -76,10 +248,15 @@ int FlatFileReader::FinishRead(void)
 
 void FlatFileReader::CancelRead(void)
 {
-	// Will be done when m_aio_context context is destroyed
-	// Note: io_cancel exists but need the iocb structure as parameter
-	// int io_cancel(aio_context_t ctx_id, struct iocb *iocb,
-	//                struct io_event *result);
+	// io_cancel needs the iocb and rarely succeeds for regular files, so just
+	// make sure nothing writes into the caller's buffer after we return.
+	m_demand_slot = NULL;
+
+	while (m_demand_pending)
+	{
+		if (ReapEvents(1) < 0)
+			break;
+	}
 }
 
 void FlatFileReader::Close(void)
@@ -87,10 +264,23 @@ void FlatFileReader::Close(void)
 
 	if (m_fd != -1) close(m_fd);
 
+	// Waits for (or cancels) the outstanding readahead requests
 	io_destroy(m_aio_context);
 
 	m_fd = -1;
 	m_aio_context = 0;
+
+	for (ReadaheadSlot& slot : m_readahead)
+	{
+		slot.inFlight = false;
+		slot.ready = false;
+		slot.discard = false;
+	}
+
+	m_demand_pending = false;
+	m_demand_slot = NULL;
+	m_next_offset = 0;
+	m_readahead_end = 0;
 }
 
 uint FlatFileReader::GetBlockCount(void) const
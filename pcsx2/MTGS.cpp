@@ -119,11 +119,17 @@ void SysMtgsThread::OnStart()
 
 	m_QueuedFrameCount = 0;
 	m_VsyncSignalListener = false;
+	m_VsyncQueueLimit = EmuConfig.GS.VsyncQueueSize;
 	m_SignalRingEnable = false;
 	m_SignalRingPosition = 0;
 
 	m_CopyDataTally = 0;
 
+	ResetFrameStats();
+	m_gsVsyncCount = 0;
+	m_gsVsyncTick = GetCPUTicks();
+	m_gsIdleTick = 0;
+
 	_parent::OnStart();
 }
 
@@ -153,6 +159,7 @@ void SysMtgsThread::ResetGS()
 	m_ReadPos = m_WritePos.load();
 	m_QueuedFrameCount = 0;
 	m_VsyncSignalListener = 0;
+	ResetFrameStats(); // The MTGS side is reset by GS_RINGTYPE_RESET
 
 	MTGS_LOG("MTGS: Sending Reset...");
 	SendSimplePacket(GS_RINGTYPE_RESET, 0, 0, 0);
@@ -168,8 +175,153 @@ struct RingCmdPacket_Vsync
 	GSRegSIGBLID siglblid;
 };
 
+static u32 TicksToUs(u64 ticks)
+{
+	return (u32)(ticks * 1000000 / GetTickFrequency());
+}
+
+// EE thread: clears the telemetry and restarts the adaptive queue window
+void SysMtgsThread::ResetFrameStats()
+{
+	ScopedLock lock(m_mtx_FrameStats);
+	memzero(m_FrameStats);
+	m_eeVsyncCount = 0;
+	m_eeVsyncTick = GetCPUTicks();
+	m_eeWaitTick = 0;
+	m_PacingFrames = 0;
+	m_PacingEEWaits = 0;
+	m_PacingPeriod = 0;
+	m_PacingGSIdle = 0;
+}
+
+size_t SysMtgsThread::GetFrameStats(MTGS_FrameStats* dest, size_t count)
+{
+	ScopedLock lock(m_mtx_FrameStats);
+	count = std::min<u64>(std::min<size_t>(count, MTGS_FrameStatsCount), m_eeVsyncCount);
+	for (size_t i = 0; i < count; i++)
+		dest[i] = m_FrameStats[(m_eeVsyncCount - count + i) % MTGS_FrameStatsCount];
+	return count;
+}
+
+// EE thread, called once per vsync.  When the EE keeps blocking on the queue limit while
+// the MTGS also runs out of work, the frames are bursty (e.g. Xenosaga alternates heavy and
+// empty frames) and a deeper queue evens them out.  When the MTGS never runs out of work
+// it's the bottleneck, and queued frames only add input lag.  The depth is bounded by
+// the latency budget.  A VsyncQueueSize of 0 asks for no queued frames at all, which
+// is always honoured.
+void SysMtgsThread::UpdateVsyncQueueLimit()
+{
+	static const int window = 30;
+
+	if (!EmuConfig.GS.VsyncQueueAdaptive || EmuConfig.GS.VsyncQueueSize <= 0)
+	{
+		m_VsyncQueueLimit.store(EmuConfig.GS.VsyncQueueSize, std::memory_order_relaxed);
+		return;
+	}
+	if (m_PacingFrames < window)
+		return;
+
+	u64 frameTime = std::max<u64>(m_PacingPeriod / m_PacingFrames, 1);
+	u64 budget = (u64)std::max(EmuConfig.GS.VsyncQueueLatency, 0) * GetTickFrequency() / 1000;
+	int maxLimit = std::min<u64>((budget + frameTime / 2) / frameTime, 8);
+	int gsIdle = m_PacingGSIdle.exchange(0);
+	int limit = m_VsyncQueueLimit.load(std::memory_order_relaxed);
+
+	if (m_PacingEEWaits > m_PacingFrames / 4)
+	{
+		if (gsIdle > m_PacingFrames / 4)
+			limit++;
+		else if (!gsIdle)
+			limit--;
+	}
+	limit = std::max(1, std::min(limit, maxLimit));
+
+	if (limit != m_VsyncQueueLimit.load(std::memory_order_relaxed))
+		DevCon.WriteLn("MTGS: Vsync queue limit = %d [frame=%.1fms, ee waits=%d, gs idle=%d]",
+			limit, TicksToUs(frameTime) / 1000.0, m_PacingEEWaits, gsIdle);
+	m_VsyncQueueLimit.store(limit, std::memory_order_relaxed);
+
+	m_PacingFrames = 0;
+	m_PacingEEWaits = 0;
+	m_PacingPeriod = 0;
+}
+
+// MTGS thread, called after each vsync: fills the GS side of the frame stats and shows
+// the averages of the last frames on the OSD monitor
+void SysMtgsThread::PostFrameStatsInThread()
+{
+	static const uint osdFrames = 16;
+
+	u64 tick = GetCPUTicks();
+	u64 period = tick - m_gsVsyncTick;
+
+	if (m_gsIdleTick > period / 10)
+		m_PacingGSIdle.fetch_add(1, std::memory_order_relaxed);
+
+	ScopedLock lock(m_mtx_FrameStats);
+
+	MTGS_FrameStats& fs = m_FrameStats[m_gsVsyncCount % MTGS_FrameStatsCount];
+	if (fs.frame == m_gsVsyncCount)
+	{
+		fs.gsTime = TicksToUs(period - std::min(m_gsIdleTick, period));
+		fs.gsIdle = TicksToUs(m_gsIdleTick);
+		fs.gsDone = true;
+	}
+
+	m_gsVsyncCount++;
+	m_gsVsyncTick = tick;
+	m_gsIdleTick = 0;
+
+	if ((m_gsVsyncCount % osdFrames) || m_gsVsyncCount < osdFrames)
+		return;
+
+	u64 eeTime = 0, eeWait = 0, gsTime = 0, gsIdle = 0, depth = 0;
+	uint frames = 0;
+	for (u64 i = m_gsVsyncCount - osdFrames; i < m_gsVsyncCount; i++)
+	{
+		const MTGS_FrameStats& f = m_FrameStats[i % MTGS_FrameStatsCount];
+		if (f.frame != i || !f.gsDone)
+			continue;
+		eeTime += f.eeTime;
+		eeWait += f.eeWait;
+		gsTime += f.gsTime;
+		gsIdle += f.gsIdle;
+		depth += f.queueDepth;
+		frames++;
+	}
+	if (!frames)
+		return;
+
+	char value[128];
+	snprintf(value, sizeof(value), "EE %.1fms (wait %.1f) | GS %.1fms (idle %.1f) | Queue %.1f/%d",
+		eeTime / 1000.0 / frames, eeWait / 1000.0 / frames, gsTime / 1000.0 / frames, gsIdle / 1000.0 / frames,
+		(double)depth / frames, GetVsyncQueueLimit());
+	GSosdMonitor("Frame pacing", value, 0);
+}
+
 void SysMtgsThread::PostVsyncStart()
 {
+	// Frame pacing telemetry, must be stored before the MTGS can process the vsync
+	u64 tick = GetCPUTicks();
+	u64 period = tick - m_eeVsyncTick;
+	{
+		ScopedLock lock(m_mtx_FrameStats);
+		MTGS_FrameStats& fs = m_FrameStats[m_eeVsyncCount % MTGS_FrameStatsCount];
+		memzero(fs);
+		fs.frame = m_eeVsyncCount;
+		fs.eeTime = TicksToUs(period - std::min(m_eeWaitTick, period));
+		fs.eeWait = TicksToUs(m_eeWaitTick);
+		fs.queueDepth = std::max(m_QueuedFrameCount.load(), 0);
+		fs.queueLimit = GetVsyncQueueLimit();
+		m_eeVsyncCount++;
+	}
+	m_PacingFrames++;
+	m_PacingEEWaits += !!m_eeWaitTick;
+	m_PacingPeriod += period;
+	m_eeVsyncTick = tick;
+	m_eeWaitTick = 0;
+	UpdateVsyncQueueLimit();
+
 	// Optimization note: Typically regset1 isn't needed.  The regs in that area are typically
 	// changed infrequently, usually during video mode changes.  However, on modern systems the
 	// 256-byte copy is only a few dozen cycles -- executed 60 times a second -- so probably
@@ -201,8 +353,9 @@ void SysMtgsThread::PostVsyncStart()
 	// For that reason it's better to have the limit always in place, at the cost of a few max FPS in benchmarks.
 	// If those are needed back, it's better to increase the VsyncQueueSize via PCSX_vm.ini.
 	// (The Xenosaga engine is known to run into this, due to it throwing bulks of data in one frame followed by 2 empty frames.)
+	// Edit: VsyncQueueAdaptive now picks the limit at runtime (see UpdateVsyncQueueLimit).
 
-	if ((m_QueuedFrameCount.fetch_add(1) < EmuConfig.GS.VsyncQueueSize) /*|| (!EmuConfig.GS.VsyncEnable && !EmuConfig.GS.FrameLimitEnable)*/)
+	if ((m_QueuedFrameCount.fetch_add(1) < GetVsyncQueueLimit()) /*|| (!EmuConfig.GS.VsyncEnable && !EmuConfig.GS.FrameLimitEnable)*/)
 		return;
 
 	m_VsyncSignalListener.store(true, std::memory_order_release);
@@ -214,7 +367,9 @@ void SysMtgsThread::PostVsyncStart()
 	// So let's ensure the ring doesn't sleep
 	m_sem_event.Post();
 
+	u64 waitStart = GetCPUTicks();
 	m_sem_Vsync.WaitNoCancel();
+	m_eeWaitTick = GetCPUTicks() - waitStart;
 }
 
 union PacketTagType
@@ -319,7 +474,9 @@ void SysMtgsThread::ExecuteTaskInThread()
 		// is very optimized (only 1 instruction test in most cases), so no point in trying
 		// to avoid it.
 
+		u64 idleStart = GetCPUTicks();
 		m_sem_event.WaitWithoutYield();
+		m_gsIdleTick += GetCPUTicks() - idleStart;
 		StateCheckInThread();
 		busy.Acquire();
 
@@ -481,6 +638,7 @@ void SysMtgsThread::ExecuteTaskInThread()
 							// CSR & 0x2000; is the pageflip id.
 							GSvsync(((u32&)RingBuffer.Regs[0x1000]) & 0x2000);
 							gsFrameSkip();
+							PostFrameStatsInThread();
 
 							m_QueuedFrameCount.fetch_sub(1);
 							if (m_VsyncSignalListener.exchange(false))
@@ -508,6 +666,9 @@ void SysMtgsThread::ExecuteTaskInThread()
 						case GS_RINGTYPE_RESET:
 							MTGS_LOG("(MTGS Packet Read) ringtype=Reset");
 							GSreset();
+							m_gsVsyncCount = 0;
+							m_gsVsyncTick = GetCPUTicks();
+							m_gsIdleTick = 0;
 							break;
 
 						case GS_RINGTYPE_SOFTRESET:
@@ -24,6 +24,15 @@ __aligned16 VU_Thread vu1Thread(CpuVU1, VU1);
 #define MTVU_ALWAYS_KICK 0
 #define MTVU_SYNC_MODE 0
 
+// Small commands (vif unpacks, memory writes) are published to the VU thread once this many
+// u32's are queued, or by the next ExecuteVU()/WaitVU()
+static const s32 MTVU_BATCH_SIZE = _16kb / sizeof(u32);
+
+// Spin counts before sleeping: the VU thread adapts its own between these, the EE thread
+// always spins the maximum (it has nothing else to do)
+static const u32 MTVU_SPIN_MIN = 64;
+static const u32 MTVU_SPIN_MAX = 1 << 14;
+
 // Rounds up a size in bytes for size in u32's
 static __fi u32 size_u32(u32 x) { return (x + 3) >> 2; }
 
@@ -103,8 +112,18 @@ void VU_Thread::Reset()
 {
 	ScopedLock lock(mtxBusy);
 
+	if (m_stats.commits)
+	{
+		DevCon.WriteLn("MTVU: %u commands in %u publications, waited %u times on ring space (%llums), %u times on VU1 (%llums)",
+			m_stats.packets, m_stats.commits, m_stats.sizeWaits, m_stats.sizeWaitTicks * 1000 / GetTickFrequency(),
+			m_stats.vuWaits, m_stats.vuWaitTicks * 1000 / GetTickFrequency());
+	}
+	memzero(m_stats);
+
 	vuCycleIdx = 0;
 	isBusy = false;
+	eeWaiting = false;
+	m_spin = MTVU_SPIN_MIN;
 	m_ato_write_pos = 0;
 	m_write_pos = 0;
 	m_ato_read_pos = 0;
@@ -129,7 +148,7 @@ void VU_Thread::ExecuteRingBuffer()
 {
 	for (;;)
 	{
-		semaEvent.WaitWithoutYield();
+		WaitForWork();
 		ScopedLockBool lock(mtxBusy, isBusy);
 		while (m_ato_read_pos.load(std::memory_order_relaxed) != GetWritePos())
 		{
@@ -196,9 +215,56 @@ void VU_Thread::ExecuteRingBuffer()
 }
 
 
+// VU thread: spins a little before sleeping on semaEvent.  In VU1 bound games the EE sends
+// the next program within microseconds, less than a sleep and wake-up round trip.  The
+// spin count doubles when work arrives while spinning, and halves when it doesn't.
+void VU_Thread::WaitForWork()
+{
+	isBusy.store(true, std::memory_order_relaxed); // KickStart() doesn't post while spinning
+	for (u32 i = 0; i < m_spin; i++)
+	{
+		if (m_ato_read_pos.load(std::memory_order_relaxed) != GetWritePos())
+		{
+			m_spin = std::min(m_spin * 2, MTVU_SPIN_MAX);
+			return;
+		}
+		Threading::SpinWait();
+	}
+	m_spin = std::max(m_spin / 2, MTVU_SPIN_MIN);
+
+	// Pairs with the fence in KickStart(): either it sees isBusy cleared and posts, or we
+	// see its write pos here
+	isBusy.store(false, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (m_ato_read_pos.load(std::memory_order_relaxed) != GetWritePos())
+		return;
+
+	semaEvent.WaitWithoutYield();
+}
+
+// EE thread: waits for the VU thread to move its read pos away from readPos.  Spins first,
+// then sleeps on semaRead which CommitReadPos() posts while eeWaiting is set.
+void VU_Thread::WaitForRead(s32 readPos)
+{
+	for (u32 i = 0; i < MTVU_SPIN_MAX; i++)
+	{
+		if (GetReadPos() != readPos)
+			return;
+		Threading::SpinWait();
+	}
+
+	KickStart();
+	eeWaiting.store(true, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (GetReadPos() == readPos)
+		semaRead.WaitWithoutYield(wxTimeSpan::Milliseconds(1)); // Timeout in case the VU thread went idle
+	eeWaiting.store(false, std::memory_order_relaxed);
+}
+
 // Should only be called by ReserveSpace()
 __ri void VU_Thread::WaitOnSize(s32 size)
 {
+	u64 waitStart = 0;
 	for (;;)
 	{
 		s32 readPos = GetReadPos();
@@ -211,15 +277,16 @@ __ri void VU_Thread::WaitOnSize(s32 size)
 		// Note: a wait lock instead of a yield also helps to avoid the bug.
 		if (readPos > m_write_pos + size + _4kb)
 			break; // Enough free front space
-		{          // Let MTVU run to free up buffer space
-			KickStart();
-			// Locking might trigger a full flush of the ring buffer. Yield
-			// will be more aggressive, and only flush the minimal size.
-			// Performance will be smoother but it will consume extra CPU cycle
-			// on the EE thread (not an issue on 4 cores).
-			std::this_thread::yield();
+		if (!waitStart)
+		{ // Let MTVU run to free up buffer space, including the queued commands
+			waitStart = GetCPUTicks();
+			m_stats.sizeWaits++;
+			FlushWritePos();
 		}
+		WaitForRead(readPos);
 	}
+	if (waitStart)
+		m_stats.sizeWaitTicks += GetCPUTicks() - waitStart;
 }
 
 // Makes sure theres enough room in the ring buffer
@@ -264,6 +331,7 @@ __fi u32* VU_Thread::GetWritePtr()
 __fi void VU_Thread::CommitWritePos()
 {
 	m_ato_write_pos.store(m_write_pos, std::memory_order_release);
+	m_stats.commits++;
 
 	if (MTVU_ALWAYS_KICK)
 		KickStart();
@@ -274,6 +342,29 @@ __fi void VU_Thread::CommitWritePos()
 __fi void VU_Thread::CommitReadPos()
 {
 	m_ato_read_pos.store(m_read_pos, std::memory_order_release);
+
+	// Pairs with the fence in WaitForRead()
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (eeWaiting.load(std::memory_order_relaxed) && eeWaiting.exchange(false))
+		semaRead.Post();
+}
+
+// Publishes the queued commands once there are enough of them, so that several small
+// commands are published, and the VU thread woken, in one go
+__fi void VU_Thread::QueueWritePos()
+{
+	m_stats.packets++;
+	if (m_write_pos - m_ato_write_pos.load(std::memory_order_relaxed) >= MTVU_BATCH_SIZE)
+		FlushWritePos();
+}
+
+// Publishes the queued commands, if any
+__fi void VU_Thread::FlushWritePos()
+{
+	if (m_write_pos == m_ato_write_pos.load(std::memory_order_relaxed))
+		return;
+	CommitWritePos();
+	KickStart();
 }
 
 __fi u32 VU_Thread::Read()
@@ -396,6 +487,8 @@ void VU_Thread::Get_GSChanges()
 
 void VU_Thread::KickStart(bool forceKick)
 {
+	// Pairs with the fence in WaitForWork()
+	std::atomic_thread_fence(std::memory_order_seq_cst);
 	if ((forceKick && !semaEvent.Count()) || (!isBusy.load(std::memory_order_acquire) && GetReadPos() != m_ato_write_pos.load(std::memory_order_relaxed)))
 		semaEvent.Post();
 }
@@ -408,16 +501,19 @@ bool VU_Thread::IsDone()
 void VU_Thread::WaitVU()
 {
 	MTVU_LOG("MTVU - WaitVU!");
-	for (;;)
+	FlushWritePos();
+	if (IsDone())
+		return;
+
+	u64 waitStart = GetCPUTicks();
+	m_stats.vuWaits++;
+	while (!IsDone())
 	{
-		if (IsDone())
-			break;
 		//DevCon.WriteLn("WaitVU()");
 		//pxAssert(THREAD_VU1);
-		KickStart();
-		std::this_thread::yield(); // Give a chance to the MTVU thread to actually start
-		ScopedLock lock(mtxBusy);
+		WaitForRead(GetReadPos());
 	}
+	m_stats.vuWaitTicks += GetCPUTicks() - waitStart;
 }
 
 void VU_Thread::ExecuteVU(u32 vu_addr, u32 vif_top, u32 vif_itop)
@@ -429,6 +525,7 @@ void VU_Thread::ExecuteVU(u32 vu_addr, u32 vif_top, u32 vif_itop)
 	Write(vu_addr);
 	Write(vif_top);
 	Write(vif_itop);
+	m_stats.packets++;
 	CommitWritePos();
 	gifUnit.TransferGSPacketData(GIF_TRANS_MTVU, NULL, 0);
 	KickStart();
@@ -448,8 +545,7 @@ void VU_Thread::VifUnpack(vifStruct& _vif, VIFregisters& _vifRegs, u8* data, u32
 	WriteRegs(&_vifRegs);
 	Write(size);
 	Write(data, size);
-	CommitWritePos();
-	KickStart();
+	QueueWritePos();
 }
 
 void VU_Thread::WriteMicroMem(u32 vu_micro_addr, void* data, u32 size)
@@ -460,8 +556,7 @@ void VU_Thread::WriteMicroMem(u32 vu_micro_addr, void* data, u32 size)
 	Write(vu_micro_addr);
 	Write(size);
 	Write(data, size);
-	CommitWritePos();
-	KickStart();
+	QueueWritePos();
 }
 
 void VU_Thread::WriteDataMem(u32 vu_data_addr, void* data, u32 size)
@@ -472,8 +567,7 @@ void VU_Thread::WriteDataMem(u32 vu_data_addr, void* data, u32 size)
 	Write(vu_data_addr);
 	Write(size);
 	Write(data, size);
-	CommitWritePos();
-	KickStart();
+	QueueWritePos();
 }
 
 void VU_Thread::WriteCol(vifStruct& _vif)
@@ -482,8 +576,7 @@ void VU_Thread::WriteCol(vifStruct& _vif)
 	ReserveSpace(1 + size_u32(sizeof(_vif.MaskCol)));
 	Write(MTVU_VIF_WRITE_COL);
 	Write(&_vif.MaskCol, sizeof(_vif.MaskCol));
-	CommitWritePos();
-	KickStart();
+	QueueWritePos();
 }
 
 void VU_Thread::WriteRow(vifStruct& _vif)
@@ -492,6 +585,5 @@ void VU_Thread::WriteRow(vifStruct& _vif)
 	ReserveSpace(1 + size_u32(sizeof(_vif.MaskRow)));
 	Write(MTVU_VIF_WRITE_ROW);
 	Write(&_vif.MaskRow, sizeof(_vif.MaskRow));
-	CommitWritePos();
-	KickStart();
+	QueueWritePos();
 }
@@ -22,6 +22,18 @@
 #define MTVU_LOG(...) do{} while(0)
 //#define MTVU_LOG DevCon.WriteLn
 
+// Time the EE thread spent waiting on the VU thread, and how many ring publications
+// it made for how many commands (see VU_Thread::GetStats)
+struct MTVU_Stats
+{
+	u64 sizeWaitTicks; // WaitOnSize(): ring full
+	u64 vuWaitTicks;   // WaitVU(): VU thread finishing its commands
+	u32 sizeWaits;
+	u32 vuWaits;
+	u32 commits;       // Write position publications
+	u32 packets;       // Commands written
+};
+
 // Notes:
 // - This class should only be accessed from the EE thread...
 // - buffer_size must be power of 2
@@ -31,13 +43,17 @@ class VU_Thread : public pxThread {
 
 	u32 buffer[buffer_size];
 	// Note: keep atomic on separate cache line to avoid CPU conflict
-	__aligned(64) std::atomic<bool> isBusy;   // Is thread processing data?
+	__aligned(64) std::atomic<bool> isBusy;   // Is thread processing data? (or spinning for more)
 	__aligned(64) std::atomic<int> m_ato_read_pos; // Only modified by VU thread
 	__aligned(64) std::atomic<int> m_ato_write_pos;    // Only modified by EE thread
+	__aligned(64) std::atomic<bool> eeWaiting; // EE thread sleeps on semaRead until the read pos moves
 	__aligned(64) int  m_read_pos; // temporary read pos (local to the VU thread)
+	u32  m_spin;      // VU thread spins before sleeping (local to the VU thread)
 	int  m_write_pos; // temporary write pos (local to the EE thread)
+	MTVU_Stats m_stats; // local to the EE thread
 	Mutex     mtxBusy;
 	Semaphore semaEvent;
+	Semaphore semaRead;
 	BaseVUmicroCPU*& vuCPU;
 	VURegs&          vuRegs;
 
@@ -72,6 +88,9 @@ public:
 	// Waits till MTVU is done processing
 	void WaitVU();
 
+	// Wait and publication counters since the last Reset (EE thread only)
+	const MTVU_Stats& GetStats() const { return m_stats; }
+
 	void Get_GSChanges();
 
 	void ExecuteVU(u32 vu_addr, u32 vif_top, u32 vif_itop);
@@ -93,6 +112,8 @@ protected:
 
 private:
 	void ExecuteRingBuffer();
+	void WaitForWork();
+	void WaitForRead(s32 readPos);
 
 	void WaitOnSize(s32 size);
 	void ReserveSpace(s32 size);
@@ -104,6 +125,8 @@ private:
 
 	void CommitWritePos();
 	void CommitReadPos();
+	void QueueWritePos();
+	void FlushWritePos();
 
 	u32 Read();
 	void Read(void* dest, u32 size);
@@ -118,6 +118,7 @@ Pcsx2Config::RecompilerOptions::RecompilerOptions()
 	EnableEECache = false;
 	EnableIOP	= true;
 	EnableVU0	= true;
+	EnableVUCache = false;
 	EnableVU1	= true;
 
 	// vu and fpu clamping default to standard overflow.
@@ -173,6 +174,7 @@ void Pcsx2Config::RecompilerOptions::LoadSave( IniInterface& ini )
 	IniBitBool( EnableEECache );
 	IniBitBool( EnableVU0 );
 	IniBitBool( EnableVU1 );
+	IniBitBool( EnableVUCache );
 
 	IniBitBool( vuOverflow );
 	IniBitBool( vuExtraOverflow );
@@ -226,6 +228,8 @@ Pcsx2Config::GSOptions::GSOptions()
 
 	SynchronousMTGS			= false;
 	VsyncQueueSize			= 2;
+	VsyncQueueAdaptive		= false;
+	VsyncQueueLatency		= 50;
 
 	FramesToDraw			= 2;
 	FramesToSkip			= 2;
@@ -241,6 +245,8 @@ void Pcsx2Config::GSOptions::LoadSave( IniInterface& ini )
 
 	IniEntry( SynchronousMTGS );
 	IniEntry( VsyncQueueSize );
+	IniEntry( VsyncQueueAdaptive );
+	IniEntry( VsyncQueueLatency );
 
 	IniEntry( FrameLimitEnable );
 	IniEntry( FrameSkipEnable );
@@ -427,6 +433,30 @@ void Pcsx2Config::DebugOptions::LoadSave( IniInterface& ini )
 	IniBitfield( MemoryViewBytesPerRow );
 }
 
+Pcsx2Config::RewindOptions::RewindOptions()
+{
+	bitset = 0;
+	FrameInterval = 30;
+	MaxSnapshots = 120;
+	MaxMemoryMb = 512;
+}
+
+void Pcsx2Config::RewindOptions::LoadSave( IniInterface& ini )
+{
+	ScopedIniGroup path( ini, L"Rewind" );
+
+	IniBitBool( Enabled );
+	IniBitfield( FrameInterval );
+	IniBitfield( MaxSnapshots );
+	IniBitfield( MaxMemoryMb );
+
+	if (ini.IsLoading())
+	{
+		FrameInterval = std::max<u32>(FrameInterval, 1);
+		MaxSnapshots = std::max<u32>(MaxSnapshots, 1);
+	}
+}
+
 
 
 
@@ -459,6 +489,7 @@ void Pcsx2Config::LoadSave( IniInterface& ini )
 	IniBitBool( FullBootConfig );
 
 	IniBitBool( BackupSavestate );
+	IniBitBool( DeltaSavestates );
 	IniBitBool( McdEnableEjection );
 	IniBitBool( McdFolderAutoManage );
 	IniBitBool( MultitapPort0_Enabled );
@@ -473,6 +504,7 @@ void Pcsx2Config::LoadSave( IniInterface& ini )
 	Profiler		.LoadSave( ini );
 
 	Debugger		.LoadSave( ini );
+	Rewind			.LoadSave( ini );
 	Trace			.LoadSave( ini );
 
 	ini.Flush();
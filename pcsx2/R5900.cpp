@@ -38,6 +38,7 @@
 
 #include "DebugTools/Breakpoints.h"
 #include "R5900OpcodeTables.h"
+#include "Utilities/Perf.h"
 
 using namespace R5900;	// for R5900 disasm tools
 
@@ -547,6 +548,7 @@ void __fastcall eeGameStarting()
 		//Console.WriteLn( Color_Green, "(R5900) ELF Entry point! [addr=0x%08X]", ElfEntry );
 		g_GameStarted = true;
 		g_GameLoading = false;
+		Perf::SetGame(ElfCRC);
 		GetCoreThread().GameStartingInThread();
 
 		// GameStartingInThread may issue a reset of the cpu and/or recompilers.  Check for and
@@ -182,10 +182,46 @@ void InputRecording::IncrementFrameCounter()
 		case InputRecordingMode::Replaying:
 			if (frameCounter == inputRecordingData.GetTotalFrames())
 				incrementUndo = false;
+			captureKeyframe();
 		}
 	}
 }
 
+void InputRecording::captureKeyframe()
+{
+	const int interval = g_Conf->inputRecording.m_keyframe_interval;
+	if (interval <= 0 || frameCounter % interval != 0 || !inputRecordingData.SupportsKeyframes() ||
+		inputRecordingData.FindKeyframe(frameCounter) == frameCounter)
+		return;
+
+	// The snapshot is taken once the core thread reaches a safe point, so it is filed under
+	// the frame it was actually taken at.
+	StateCopy_SaveSnapshot([](u32 frame, std::vector<u8>& snapshot) {
+		if (g_InputRecording.IsActive() && frame >= g_InputRecording.GetStartingFrame())
+			g_InputRecording.GetInputRecordingData().QueueKeyframe(frame - g_InputRecording.GetStartingFrame(), std::move(snapshot));
+	});
+}
+
+bool InputRecording::GoToFrame(s32 frame)
+{
+	const long keyframe = inputRecordingData.FindKeyframe(frame);
+	std::vector<u8> snapshot;
+	if (keyframe < 0 || !inputRecordingData.ReadKeyframe(keyframe, snapshot))
+	{
+		inputRec::consoleLog(fmt::format("No keyframe at or before frame {}", frame));
+		return false;
+	}
+
+	// Stop the frame counter before the keyframe replaces it, then replay up to the frame
+	g_InputRecordingControls.PauseImmediately();
+	if (IsRecording())
+		SetToReplayMode();
+	g_InputRecordingControls.SeekTo(frame);
+	StateCopy_LoadSnapshot(std::move(snapshot));
+	inputRec::log(fmt::format("Seeking to frame {} from keyframe {}", frame, keyframe));
+	return true;
+}
+
 void InputRecording::LogAndRedraw()
 {
 	for (u8 port = 0; port < 2; port++)
@@ -98,6 +98,8 @@ public:
 	void GoToFirstFrame(wxWindow* parent);
 	// Resets a recording if the base savestate could not be loaded at the start
 	void FailedSavestate();
+	// Loads the closest keyframe at or before the frame and replays up to it
+	bool GoToFrame(s32 frame);
 
 private:
 	enum class InputRecordingMode
@@ -138,6 +140,9 @@ private:
 		~InputRecordingPad();
 	} pads[2];
 
+	// Queues a keyframe snapshot every InputRecordingOptions::m_keyframe_interval frames
+	void captureKeyframe();
+
 	// Resolve the name and region of the game currently loaded using the GameDB
 	// If the game cannot be found in the DB, the fallback is the ISO filename
 	wxString resolveGameName();
@@ -18,6 +18,7 @@
 #ifndef DISABLE_RECORDING
 
 #include "App.h"
+#include "AppSaveStates.h"
 #include "Counters.h"
 #include "DebugTools/Debug.h"
 #include "MainFrame.h"
@@ -42,6 +43,12 @@ void InputRecordingControls::CheckPauseStatus()
 	{
 		g_InputRecording.IncrementFrameCounter();
 
+		if (seeking && g_InputRecording.GetFrameCounter() >= seekFrame)
+		{
+			seeking = false;
+			pauseEmulation = true;
+		}
+
 		if (switchToReplay)
 		{
 			g_InputRecording.SetToReplayMode();
@@ -104,6 +111,25 @@ void InputRecordingControls::FrameAdvance()
 	Resume();
 }
 
+void InputRecordingControls::FrameRewind()
+{
+	frameAdvancing = false;
+	Pause();
+	emulationCurrentlyPaused = true;
+	// The snapshot is loaded while the core is paused, and it stays paused afterwards
+	StateCopy_Rewind(true);
+}
+
+void InputRecordingControls::SeekTo(s32 frame)
+{
+	frameAdvancing = false;
+	seeking = true;
+	seekFrame = frame;
+	// The keyframe load resumes the core by itself
+	pauseEmulation = false;
+	resumeEmulation = false;
+}
+
 void InputRecordingControls::setFrameAdvanceAmount(int amount)
 {
 	frames_per_frame_advance = amount;
@@ -47,6 +47,10 @@ public:
 	// Resume emulation (incase the emulation is currently paused) and pause after a single frame has passed
 	void FrameAdvance();
 	void setFrameAdvanceAmount(int amount);
+	// Restores the previous rewind snapshot and holds emulation paused on it
+	void FrameRewind();
+	// Runs emulation until the recording reaches the given frame, then pauses
+	void SeekTo(s32 frame);
 	// Returns true if emulation is currently set up to frame advance.
 	bool IsFrameAdvancing();
 	// Returns true if the input recording has been paused, which can occur:
@@ -80,6 +84,9 @@ private:
 	bool frameAdvancing = false;
 	u32 frame_advance_frame_counter = 0;
 	u32 frames_per_frame_advance = 1;
+	// Set while running towards seekFrame
+	bool seeking = false;
+	s32 seekFrame = 0;
 	// Indicates if we intend to call CoreThread.PauseSelf() on the current or next available vsync
 	bool pauseEmulation = false;
 	// Indicates if we intend to call CoreThread.Resume() when the next pcsx2 App event is handled
@@ -23,9 +23,14 @@
 
 #include "InputRecordingFile.h"
 #include "Utilities/InputRecordingLogger.h"
+#include "CDVD/CompressedFileReaderUtils.h"
+
+#include <algorithm>
+#include <zlib.h>
 
 void InputRecordingFileHeader::Init()
 {
+	version = 2;
 	memset(author, 0, ArraySize(author));
 	memset(gameName, 0, ArraySize(gameName));
 }
@@ -58,12 +63,72 @@ bool InputRecordingFile::Close()
 	{
 		return false;
 	}
+	Flush();
 	fclose(recordingFile);
 	recordingFile = nullptr;
 	filename = "";
+	frameData.clear();
+	frameData.shrink_to_fit();
+	dirtyBegin = LONG_MAX;
+	dirtyEnd = 0;
+	framesSinceFlush = 0;
+	cutFrame = LONG_MAX;
+	appendOffset = 0;
+	std::lock_guard<std::mutex> lock(keyframeMutex);
+	keyframes.clear();
+	pendingKeyframes.clear();
 	return true;
 }
 
+bool InputRecordingFile::Flush()
+{
+	if (recordingFile == nullptr)
+	{
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(keyframeMutex);
+	bool ok = true;
+	if (header.version == 1)
+	{
+		if (dirtyBegin < dirtyEnd)
+		{
+			const size_t count = dirtyEnd - dirtyBegin;
+			ok = fseek(recordingFile, getRecordingBlockSeekPoint(dirtyBegin), SEEK_SET) == 0
+				&& fwrite(&frameData[dirtyBegin * inputBytesPerFrame], inputBytesPerFrame, count, recordingFile) == count;
+		}
+		pendingKeyframes.clear();
+	}
+	else
+	{
+		// The cut goes first: every keyframe still pending was taken after it
+		if (cutFrame != LONG_MAX)
+			ok &= appendBlock(blockTagCut, cutFrame, nullptr, 0);
+		if (dirtyBegin < dirtyEnd)
+			ok &= appendBlock(blockTagFrames, dirtyBegin, &frameData[dirtyBegin * inputBytesPerFrame], (dirtyEnd - dirtyBegin) * inputBytesPerFrame);
+		for (const auto& pending : pendingKeyframes)
+		{
+			const s64 offset = appendOffset + sizeof(InputRecordingBlockHeader);
+			if (appendBlock(blockTagKeyframe, pending.first, pending.second.data(), pending.second.size()))
+				keyframes[pending.first] = {offset, (u32)pending.second.size()};
+			else
+				ok = false;
+		}
+		pendingKeyframes.clear();
+	}
+	cutFrame = LONG_MAX;
+	dirtyBegin = LONG_MAX;
+	dirtyEnd = 0;
+	framesSinceFlush = 0;
+
+	ok = ok
+		&& fseek(recordingFile, seekpointTotalFrames, SEEK_SET) == 0
+		&& fwrite(&totalFrames, 4, 1, recordingFile) == 1
+		&& fwrite(&undoCount, 4, 1, recordingFile) == 1;
+	fflush(recordingFile);
+	return ok;
+}
+
 const wxString &InputRecordingFile::GetFilename()
 {
 	return filename;
@@ -96,8 +161,7 @@ void InputRecordingFile::IncrementUndoCount()
 	{
 		return;
 	}
-	fseek(recordingFile, seekpointUndoCount, SEEK_SET);
-	fwrite(&undoCount, 4, 1, recordingFile);
+	Flush();
 }
 
 bool InputRecordingFile::open(const wxString path, bool newRecording)
@@ -110,12 +174,13 @@ bool InputRecordingFile::open(const wxString path, bool newRecording)
 			totalFrames = 0;
 			undoCount = 0;
 			header.Init();
+			appendOffset = seekpointBlocks;
 			return true;
 		}
 	}
 	else if ((recordingFile = wxFopen(path, L"rb+")) != nullptr)
 	{
-		if (verifyRecordingFileHeader())
+		if (verifyRecordingFileHeader() && readBlocks())
 		{
 			filename = path;
 			return true;
@@ -143,29 +208,32 @@ bool InputRecordingFile::OpenExisting(const wxString& path)
 
 bool InputRecordingFile::ReadKeyBuffer(u8 &result, const uint &frame, const uint port, const uint bufIndex)
 {
-	if (recordingFile == nullptr)
-	{
-		return false;
-	}
-
-	long seek = getRecordingBlockSeekPoint(frame) + controllerInputBytes * port + bufIndex;
-	if (fseek(recordingFile, seek, SEEK_SET) != 0 || fread(&result, 1, 1, recordingFile) != 1)
+	const size_t pos = (size_t)frame * inputBytesPerFrame + controllerInputBytes * port + bufIndex;
+	if (recordingFile == nullptr || pos >= frameData.size())
 	{
 		return false;
 	}
 
+	result = frameData[pos];
 	return true;
 }
 
 void InputRecordingFile::SetTotalFrames(long frame)
 {
-	if (recordingFile == nullptr || totalFrames >= frame)
+	if (recordingFile == nullptr)
 	{
 		return;
 	}
-	totalFrames = frame;
-	fseek(recordingFile, seekpointTotalFrames, SEEK_SET);
-	fwrite(&totalFrames, 4, 1, recordingFile);
+	if (totalFrames < frame)
+	{
+		totalFrames = frame;
+	}
+	// Re-recording frames before the end doesn't move totalFrames, so count the frames
+	// themselves, and bound the size of the modified range as well
+	if (++framesSinceFlush >= flushInterval || dirtyEnd - dirtyBegin >= flushInterval)
+	{
+		Flush();
+	}
 }
 
 bool InputRecordingFile::WriteHeader()
@@ -182,6 +250,7 @@ bool InputRecordingFile::WriteHeader()
 	{
 		return false;
 	}
+	fflush(recordingFile);
 	return true;
 }
 
@@ -192,22 +261,192 @@ bool InputRecordingFile::WriteKeyBuffer(const uint &frame, const uint port, cons
 		return false;
 	}
 
-	long seek = getRecordingBlockSeekPoint(frame) + 18 * port + bufIndex;
+	const size_t pos = (size_t)frame * inputBytesPerFrame + controllerInputBytes * port + bufIndex;
+	if (pos >= frameData.size())
+	{
+		frameData.resize(((size_t)frame + 1) * inputBytesPerFrame, 0);
+	}
+	else if (frameData[pos] != buf)
+	{
+		// Re-recording an existing frame changes everything that comes after it
+		cutKeyframes(frame);
+	}
+	else
+	{
+		return true;
+	}
+
+	frameData[pos] = buf;
+	dirtyBegin = std::min<long>(dirtyBegin, frame);
+	dirtyEnd = std::max<long>(dirtyEnd, frame + 1);
+	return true;
+}
+
+bool InputRecordingFile::SupportsKeyframes()
+{
+	return recordingFile != nullptr && header.version >= 2;
+}
+
+void InputRecordingFile::QueueKeyframe(long frame, std::vector<u8> snapshot)
+{
+	std::lock_guard<std::mutex> lock(keyframeMutex);
+	if (recordingFile == nullptr)
+	{
+		return;
+	}
+	pendingKeyframes.emplace_back(frame, std::move(snapshot));
+}
+
+long InputRecordingFile::FindKeyframe(long frame)
+{
+	std::lock_guard<std::mutex> lock(keyframeMutex);
+	auto it = keyframes.upper_bound(frame);
+	if (it == keyframes.begin())
+	{
+		return -1;
+	}
+	return (--it)->first;
+}
+
+bool InputRecordingFile::ReadKeyframe(long frame, std::vector<u8> &snapshot)
+{
+	std::lock_guard<std::mutex> lock(keyframeMutex);
+	auto it = keyframes.find(frame);
+	if (recordingFile == nullptr || it == keyframes.end())
+	{
+		return false;
+	}
 
-	if (fseek(recordingFile, seek, SEEK_SET) != 0 || fwrite(&buf, 1, 1, recordingFile) != 1)
+	InputRecordingBlockHeader block;
+	snapshot.resize(it->second.size);
+	if (PX_fseeko(recordingFile, it->second.offset - sizeof(block), SEEK_SET) != 0
+		|| fread(&block, sizeof(block), 1, recordingFile) != 1
+		|| fread(snapshot.data(), 1, snapshot.size(), recordingFile) != snapshot.size()
+		|| block.crc != crc32(0, snapshot.data(), snapshot.size()))
 	{
+		inputRec::consoleLog(fmt::format("Keyframe at frame {} is corrupted", frame));
+		keyframes.erase(it);
 		return false;
 	}
+	return true;
+}
 
-	fflush(recordingFile);
+bool InputRecordingFile::appendBlock(u32 tag, long frame, const void* data, u32 size)
+{
+	InputRecordingBlockHeader block;
+	block.tag = tag;
+	block.frame = frame;
+	block.size = size;
+	block.crc = crc32(0, (const Bytef*)data, size);
+
+	if (PX_fseeko(recordingFile, appendOffset, SEEK_SET) != 0
+		|| fwrite(&block, sizeof(block), 1, recordingFile) != 1
+		|| (size && fwrite(data, size, 1, recordingFile) != 1))
+	{
+		return false;
+	}
+	appendOffset += sizeof(block) + size;
 	return true;
 }
 
+void InputRecordingFile::cutKeyframes(long frame)
+{
+	std::lock_guard<std::mutex> lock(keyframeMutex);
+	auto stale = keyframes.upper_bound(frame);
+	if (stale != keyframes.end())
+	{
+		keyframes.erase(stale, keyframes.end());
+		cutFrame = std::min(cutFrame, frame);
+	}
+	pendingKeyframes.erase(std::remove_if(pendingKeyframes.begin(), pendingKeyframes.end(),
+		[frame](const std::pair<long, std::vector<u8>>& pending) { return pending.first > frame; }), pendingKeyframes.end());
+}
+
 long InputRecordingFile::getRecordingBlockSeekPoint(const long &frame)
 {
 	return headerSize + sizeof(bool) + frame * inputBytesPerFrame;
 }
 
+bool InputRecordingFile::readBlocks()
+{
+	if (PX_fseeko(recordingFile, 0, SEEK_END) != 0)
+	{
+		return false;
+	}
+	const s64 fileSize = PX_ftello(recordingFile);
+	if (fileSize < seekpointBlocks || PX_fseeko(recordingFile, seekpointBlocks, SEEK_SET) != 0)
+	{
+		return false;
+	}
+
+	// Version 1: the frames follow the header as a plain array
+	if (header.version == 1)
+	{
+		frameData.resize((fileSize - seekpointBlocks) / inputBytesPerFrame * inputBytesPerFrame);
+		return frameData.empty() || fread(frameData.data(), frameData.size(), 1, recordingFile) == 1;
+	}
+
+	s64 offset = seekpointBlocks;
+	std::vector<u8> payload;
+	InputRecordingBlockHeader block;
+	while (offset + (s64)sizeof(block) <= fileSize)
+	{
+		if (fread(&block, sizeof(block), 1, recordingFile) != 1 || offset + (s64)sizeof(block) + block.size > fileSize)
+		{
+			break;
+		}
+
+		if (block.tag == blockTagKeyframe)
+		{
+			// Keyframes are checked when they are loaded; reading them all here would make
+			// opening long movies slow.
+			keyframes[block.frame] = {offset + (s64)sizeof(block), block.size};
+			if (PX_fseeko(recordingFile, block.size, SEEK_CUR) != 0)
+			{
+				break;
+			}
+		}
+		else if (block.tag == blockTagFrames || block.tag == blockTagCut)
+		{
+			payload.resize(block.size);
+			if ((block.size && fread(payload.data(), block.size, 1, recordingFile) != 1)
+				|| block.crc != crc32(0, payload.data(), block.size)
+				|| block.size % inputBytesPerFrame != 0)
+			{
+				break;
+			}
+
+			if (block.tag == blockTagCut)
+			{
+				keyframes.erase(keyframes.upper_bound(block.frame), keyframes.end());
+			}
+			else if (block.size)
+			{
+				const size_t pos = (size_t)block.frame * inputBytesPerFrame;
+				if (frameData.size() < pos + block.size)
+				{
+					frameData.resize(pos + block.size, 0);
+				}
+				memcpy(&frameData[pos], payload.data(), block.size);
+			}
+		}
+		else
+		{
+			break;
+		}
+
+		offset += sizeof(block) + block.size;
+	}
+
+	// Anything past the last good block was cut short by a crash; new blocks overwrite it
+	if (offset != fileSize)
+	{
+		inputRec::consoleLog(fmt::format("Input recording file is damaged after offset {}, the rest is ignored", offset));
+	}
+	appendOffset = offset;
+	return true;
+}
+
 bool InputRecordingFile::verifyRecordingFileHeader()
 {
 	if (recordingFile == nullptr)
@@ -225,7 +464,7 @@ bool InputRecordingFile::verifyRecordingFileHeader()
 	}
 	
 	// Check for current verison
-	if (header.version != 1)
+	if (header.version != 1 && header.version != 2)
 	{
 		inputRec::consoleLog(fmt::format("Input recording file is not a supported version - {}", header.version));
 		return false;
@@ -21,12 +21,17 @@
 
 #include "PadData.h"
 
-// NOTE / TODOs for Version 2
+#include <climits>
+#include <map>
+#include <mutex>
+#include <vector>
+
+// NOTE / TODOs for Version 3
 // - Move fromSavestate, undoCount, and total frames into the header
 
 struct InputRecordingFileHeader
 {
-	u8 version = 1;
+	u8 version = 2;
 	char emu[50] = "";
 	char author[255] = "";
 	char gameName[255] = "";
@@ -46,7 +51,22 @@ struct InputRecordingSavestate
 	bool fromSavestate = false;
 };
 
+// Version 2 recordings follow the fixed header with append-only blocks.  Data in a later
+// block supersedes whatever an earlier block said about the same frames, so editing a
+// movie never rewrites the file in place.
+struct InputRecordingBlockHeader
+{
+	u32 tag;   // one of the InputRecordingFile block tags
+	u32 frame; // first frame covered by the block
+	u32 size;  // size of the payload following this header
+	u32 crc;   // crc32 of the payload
+};
+
 // Handles all operations on the input recording file
+//
+// The input data of every frame is kept in memory; reads never touch the file and writes
+// are flushed as a single block every few frames.  Version 1 recordings are still read,
+// and written back in place, but cannot hold keyframes.
 class InputRecordingFile
 {
 public:
@@ -55,6 +75,8 @@ public:
 	// Closes the underlying input recording file, writing the header and 
 	// prepares for a possible new recording to be started
 	bool Close();
+	// Writes the frames modified and the keyframes captured since the last flush
+	bool Flush();
 	// Retrieve the input recording's filename (not the path)
 	const wxString &GetFilename();
 	// Retrieve the input recording's header which contains high-level metadata on the recording
@@ -83,6 +105,17 @@ public:
 	// Writes the current frame's input data to the file so it can be replayed
 	bool WriteKeyBuffer(const uint &frame, const uint port, const uint bufIndex, const u8 &buf);
 
+	// Keyframes are savestate snapshots (see StateCopy_SaveSnapshot) embedded in the
+	// recording so that playback can seek without replaying from the start.
+	// Whether keyframes can be stored in this recording
+	bool SupportsKeyframes();
+	// Queues a keyframe for the next flush; can be called from any thread
+	void QueueKeyframe(long frame, std::vector<u8> snapshot);
+	// The frame of the closest keyframe at or before the given frame, or -1 if there is none
+	long FindKeyframe(long frame);
+	// Reads the snapshot of the keyframe at the given frame
+	bool ReadKeyframe(long frame, std::vector<u8> &snapshot);
+
 private:
 	static const int controllerPortsSupported = 2;
 	static const int controllerInputBytes = 18;
@@ -95,6 +128,21 @@ private:
 	static const int seekpointTotalFrames = sizeof(InputRecordingFileHeader);
 	static const int seekpointUndoCount = sizeof(InputRecordingFileHeader) + 4;
 	static const int seekpointSaveStateHeader = seekpointUndoCount + 4;
+	static const int seekpointBlocks = headerSize + recordingSavestateHeaderSize;
+
+	// Block tags of version 2 recordings
+	static const u32 blockTagFrames = 0x534D5246;   // "FRMS": input data of consecutive frames
+	static const u32 blockTagKeyframe = 0x4D52464B; // "KFRM": savestate snapshot taken at the start of a frame
+	static const u32 blockTagCut = 0x54554343;      // "CCUT": keyframes after the frame are stale (re-recorded)
+
+	// Modified frames are written out once this many frames have passed
+	static const long flushInterval = 60;
+
+	struct Keyframe
+	{
+		s64 offset;
+		u32 size;
+	};
 
 	InputRecordingFileHeader header;
 	wxString filename = "";
@@ -105,9 +153,30 @@ private:
 	long totalFrames = 0;
 	unsigned long undoCount = 0;
 
+	// Input data of every frame, inputBytesPerFrame bytes each
+	std::vector<u8> frameData;
+	// Range of frames modified since the last flush
+	long dirtyBegin = LONG_MAX;
+	long dirtyEnd = 0;
+	// Frames recorded (or re-recorded) since the last flush
+	long framesSinceFlush = 0;
+	// Lowest frame re-recorded since the last flush; keyframes after it are discarded
+	long cutFrame = LONG_MAX;
+	// Where the next block is written (version 2)
+	s64 appendOffset = 0;
+
+	// Guards the keyframe state and the file itself, which the keyframe functions share
+	// with the emulation thread
+	std::mutex keyframeMutex;
+	std::map<long, Keyframe> keyframes;
+	std::vector<std::pair<long, std::vector<u8>>> pendingKeyframes;
+
+	bool appendBlock(u32 tag, long frame, const void* data, u32 size);
+	void cutKeyframes(long frame);
 	// Calculates the position of the current frame in the input recording
 	long getRecordingBlockSeekPoint(const long& frame);
 	bool open(const wxString path, bool newRecording);
+	bool readBlocks();
 	bool verifyRecordingFileHeader();
 };
 
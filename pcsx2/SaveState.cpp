@@ -32,6 +32,12 @@
 #include "SPU2/spu2.h"
 #include "gui/ConsoleLogger.h"
 
+#ifdef __POSIX__
+#include <zlib.h>
+#else
+#include <zlib/zlib.h>
+#endif
+
 using namespace R5900;
 
 
@@ -296,6 +302,119 @@ void memLoadingState::FreezeMem( void* data, int size )
 	memcpy( data, src, size );
 }
 
+// --------------------------------------------------------------------------------------
+//  SaveStateDelta  (implementations)
+// --------------------------------------------------------------------------------------
+struct SaveStateDeltaHeader
+{
+	char magic[4];
+	u32 baseSize;
+	u32 baseCrc;
+	u32 resultSize;
+	u32 pageCount;
+};
+
+static const char SaveStateDeltaMagic[4] = {'P', 'S', 'D', 'T'};
+
+u32 SaveStateDelta::Checksum(const u8* data, uint size)
+{
+	return crc32(crc32(0L, Z_NULL, 0), data, size);
+}
+
+uint SaveStateDelta::Create(const u8* base, uint baseSize, u32 baseCrc, const u8* current, uint currentSize, VmStateBuffer& delta)
+{
+	const uint pages = (currentSize + PageSize - 1) / PageSize;
+
+	std::vector<u32> changed;
+	for (uint page = 0; page < pages; ++page)
+	{
+		const uint offset = page * PageSize;
+		const uint len = std::min(PageSize, currentSize - offset);
+
+		// Pages past the end of the base (or straddling it) are always stored.
+		if (offset + len > baseSize || memcmp(base + offset, current + offset, len) != 0)
+			changed.push_back(page);
+	}
+
+	const uint tableSize = changed.size() * sizeof(u32);
+	uint size = sizeof(SaveStateDeltaHeader) + tableSize;
+	for (u32 page : changed)
+		size += std::min(PageSize, currentSize - page * PageSize);
+
+	delta.MakeRoomFor(size);
+
+	SaveStateDeltaHeader hdr;
+	memcpy(hdr.magic, SaveStateDeltaMagic, sizeof(hdr.magic));
+	hdr.baseSize = baseSize;
+	hdr.baseCrc = baseCrc;
+	hdr.resultSize = currentSize;
+	hdr.pageCount = changed.size();
+
+	u8* dest = delta.GetPtr();
+	memcpy(dest, &hdr, sizeof(hdr));
+	dest += sizeof(hdr);
+	if (tableSize)
+	{
+		memcpy(dest, changed.data(), tableSize);
+		dest += tableSize;
+	}
+
+	for (u32 page : changed)
+	{
+		const uint offset = page * PageSize;
+		const uint len = std::min(PageSize, currentSize - offset);
+		memcpy(dest, current + offset, len);
+		dest += len;
+	}
+
+	return size;
+}
+
+uint SaveStateDelta::Apply(const u8* base, uint baseSize, u32 baseCrc, const u8* delta, uint deltaSize, VmStateBuffer& dest)
+{
+	SaveStateDeltaHeader hdr;
+	if (deltaSize < sizeof(hdr))
+		throw Exception::SaveStateLoadError().SetDiagMsg(L"Delta savestate is truncated.");
+
+	memcpy(&hdr, delta, sizeof(hdr));
+	if (memcmp(hdr.magic, SaveStateDeltaMagic, sizeof(hdr.magic)) != 0)
+		throw Exception::SaveStateLoadError().SetDiagMsg(L"Delta savestate has an invalid header.");
+
+	if (hdr.baseSize != baseSize || hdr.baseCrc != baseCrc)
+		throw Exception::SaveStateLoadError()
+			.SetDiagMsg(pxsFmt(L"Delta savestate does not match its parent state (expected crc=0x%08x, parent crc=0x%08x).", hdr.baseCrc, baseCrc))
+			.SetUserMsg(_("This savestate cannot be loaded because the state it was saved against has been changed or overwritten."));
+
+	const u8* table = delta + sizeof(hdr);
+	const u8* data = table + hdr.pageCount * sizeof(u32);
+	const u8* const end = delta + deltaSize;
+	if (data > end)
+		throw Exception::SaveStateLoadError().SetDiagMsg(L"Delta savestate is truncated.");
+
+	dest.MakeRoomFor(hdr.resultSize);
+	u8* result = dest.GetPtr();
+	memcpy(result, base, std::min(baseSize, hdr.resultSize));
+
+	for (uint i = 0; i < hdr.pageCount; ++i)
+	{
+		u32 page;
+		memcpy(&page, table + i * sizeof(u32), sizeof(page));
+
+		const uint offset = page * PageSize;
+		if (offset >= hdr.resultSize)
+			throw Exception::SaveStateLoadError().SetDiagMsg(L"Delta savestate references a page past its end.");
+
+		const uint len = std::min(PageSize, hdr.resultSize - offset);
+		if (data + len > end)
+			throw Exception::SaveStateLoadError().SetDiagMsg(L"Delta savestate is truncated.");
+
+		memcpy(result + offset, data, len);
+		data += len;
+	}
+
+	return hdr.resultSize;
+}
+
 wxString Exception::SaveStateLoadError::FormatDiagnosticMessage() const
 {
 	FastFormatUnicode retval;
@@ -210,6 +210,27 @@ public:
 	bool IsFinished() const { return m_idx >= m_memory->GetSizeInBytes(); }
 };
 
+// --------------------------------------------------------------------------------------
+//  SaveStateDelta
+// --------------------------------------------------------------------------------------
+// Page-granular difference between two flat savestate images.  A delta stores the size
+// and CRC of the base image it was made against, followed by the indices and contents
+// of every page of the new image that differs from the base.  Applying a delta to any
+// other base throws SaveStateLoadError.
+//
+namespace SaveStateDelta
+{
+	static const uint PageSize = 0x1000;
+
+	// Returns the CRC used to identify a base image.
+	extern u32 Checksum(const u8* data, uint size);
+
+	// Writes the difference between base and current into delta, and returns its size.
+	extern uint Create(const u8* base, uint baseSize, u32 baseCrc, const u8* current, uint currentSize, VmStateBuffer& delta);
+
+	// Rebuilds the image described by delta into dest, and returns its size.
+	extern uint Apply(const u8* base, uint baseSize, u32 baseCrc, const u8* delta, uint deltaSize, VmStateBuffer& dest);
+} // namespace SaveStateDelta
 
 namespace Exception
 {
@@ -41,6 +41,7 @@
 #include "DebugTools/SymbolMap.h"
 
 #include "Utilities/PageFaultSource.h"
+#include "Utilities/Perf.h"
 #include "Utilities/Threading.h"
 #include "IopBios.h"
 
@@ -244,6 +245,11 @@ void SysCoreThread::VsyncInThread()
 {
 	ApplyLoadedPatches(PPT_CONTINUOUSLY);
 	ApplyLoadedPatches(PPT_COMBINED_0_1);
+	if (m_IpcState == ON)
+	{
+		m_socketIpc->OnVsync();
+		m_sharedIpc->OnVsync();
+	}
 }
 
 void SysCoreThread::GameStartingInThread()
@@ -263,6 +269,7 @@ void SysCoreThread::GameStartingInThread()
 	{
 		m_IpcState = ON;
 		m_socketIpc = std::make_unique<SocketIPC>(this, IPCSettings::slot);
+		m_sharedIpc = std::make_unique<SharedMemoryIPC>(IPCSettings::slot);
 	}
 	if (m_IpcState == ON && m_socketIpc->m_end)
 		m_socketIpc->Start();
@@ -291,6 +298,9 @@ void SysCoreThread::ExecuteTaskInThread()
 
 	m_mxcsr_saved.bitmask = _mm_getcsr();
 
+	// The recompiled code runs here, so this is the thread the --jitprofile sampler watches.
+	Perf::SampleThisThread();
+
 	PCSX2_PAGEFAULT_PROTECT
 	{
 		while (true)
@@ -337,6 +347,8 @@ void SysCoreThread::OnCleanupInThread()
 	m_hasActiveMachine = false;
 	m_resetVirtualMachine = true;
 
+	Perf::StopSamplingThisThread();
+
 	R3000A::ioman::reset();
 	// FIXME: temporary workaround for deadlock on exit, which actually should be a crash
 	vu1Thread.WaitVU();
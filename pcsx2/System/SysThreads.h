@@ -174,6 +174,9 @@ protected:
 	// Stores the state of the socket IPC thread.
 	std::unique_ptr<SocketIPC> m_socketIpc;
 
+	// Shared memory export for local IPC clients, serviced at each vsync.
+	std::unique_ptr<SharedMemoryIPC> m_sharedIpc;
+
 	// Current state of the IPC thread
 	enum StateIPC
 	{
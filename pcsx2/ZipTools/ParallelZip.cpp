@@ -0,0 +1,516 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+#include "ParallelZip.h"
+
+#include <wx/datetime.h>
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <zlib.h>
+
+static const u32 ZipLocalHeaderSig = 0x04034b50;
+static const u32 ZipCentralHeaderSig = 0x02014b50;
+static const u32 ZipEndOfDirectorySig = 0x06054b50;
+
+static const uint ZipLocalHeaderSize = 30;
+static const uint ZipCentralHeaderSize = 46;
+static const uint ZipEndOfDirectorySize = 22;
+
+static const u16 ZipVersion = 20;
+static const u16 ZipFlagUTF8 = 0x0800;
+static const u16 ZipMethodStore = 0;
+static const u16 ZipMethodDeflate = 8;
+
+static void Put16(std::vector<u8>& dest, u16 value)
+{
+	dest.push_back(value & 0xff);
+	dest.push_back(value >> 8);
+}
+
+static void Put32(std::vector<u8>& dest, u32 value)
+{
+	Put16(dest, value & 0xffff);
+	Put16(dest, value >> 16);
+}
+
+static u16 Get16(const u8* src)
+{
+	return src[0] | (src[1] << 8);
+}
+
+static u32 Get32(const u8* src)
+{
+	return Get16(src) | ((u32)Get16(src + 2) << 16);
+}
+
+// Runs job(0) to job(count-1) on up to `workers` threads, including the calling one.
+// Returns false if any job failed (the remaining ones are then skipped).
+static bool RunJobs(uint count, uint workers, const std::function<bool(uint)>& job)
+{
+	std::atomic<uint> next(0);
+	std::atomic<bool> ok(true);
+
+	auto work = [&]() {
+		while (ok)
+		{
+			const uint i = next++;
+			if (i >= count)
+				break;
+
+			try
+			{
+				if (!job(i))
+					ok = false;
+			}
+			catch (...)
+			{
+				ok = false;
+			}
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (uint i = 1; i < std::min(workers, count); ++i)
+		threads.emplace_back(work);
+
+	work();
+
+	for (std::thread& thread : threads)
+		thread.join();
+
+	return ok;
+}
+
+uint ParallelZip::GetWorkerCount(bool background)
+{
+	const uint cores = std::max(1u, std::thread::hardware_concurrency());
+	return background ? std::max(1u, cores / 2) : cores;
+}
+
+// --------------------------------------------------------------------------------------
+//  ParallelZip::WriteArchive
+// --------------------------------------------------------------------------------------
+struct DeflateJob
+{
+	uint entry;
+	const u8* src;
+	uint size;
+	bool last;
+
+	std::vector<u8> out;
+	u32 crc;
+};
+
+static bool DeflateChunk(DeflateJob& job)
+{
+	z_stream strm = {};
+	if (deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+		return false;
+
+	// Room for the sync flush marker on top of the worst case.
+	job.out.resize(deflateBound(&strm, job.size) + 16);
+
+	strm.next_in = const_cast<u8*>(job.src);
+	strm.avail_in = job.size;
+	strm.next_out = job.out.data();
+	strm.avail_out = job.out.size();
+
+	// A sync flush ends the chunk on a byte boundary without a final block, so the next
+	// chunk's output can simply be appended to it.
+	const int ret = deflate(&strm, job.last ? Z_FINISH : Z_SYNC_FLUSH);
+	const bool ok = job.last ? (ret == Z_STREAM_END) : (ret == Z_OK && strm.avail_in == 0);
+
+	job.out.resize(strm.total_out);
+	deflateEnd(&strm);
+
+	job.crc = crc32(crc32(0L, Z_NULL, 0), job.src, job.size);
+	return ok;
+}
+
+void ParallelZip::WriteArchive(const wxString& filename, const ArchiveEntryList& list, uint workers)
+{
+	std::vector<DeflateJob> jobs;
+	for (uint i = 0; i < list.GetLength(); ++i)
+	{
+		const ArchiveEntry& entry = list[i];
+		const uint size = entry.GetDataSize();
+
+		for (uint offset = 0; offset < size; offset += ChunkSize)
+		{
+			DeflateJob job;
+			job.entry = i;
+			job.src = list.GetPtr(entry.GetDataIndex() + offset);
+			job.size = std::min<uint>(ChunkSize, size - offset);
+			job.last = (offset + job.size == size);
+			job.crc = 0;
+			jobs.push_back(std::move(job));
+		}
+	}
+
+	if (!RunJobs(jobs.size(), workers, [&jobs](uint i) { return DeflateChunk(jobs[i]); }))
+		throw Exception::BadStream(filename).SetDiagMsg(L"Failed to compress archive data.");
+
+	wxFFile file(filename, L"wb");
+	if (!file.IsOpened())
+		throw Exception::CannotCreateStream(filename);
+
+	const u32 dosTime = wxDateTime::Now().GetAsDOS();
+
+	std::vector<u8> central;
+	std::vector<u8> header;
+	u32 offset = 0;
+	u16 count = 0;
+
+	auto write = [&file, &filename](const void* data, size_t size) {
+		if (size && file.Write(data, size) != size)
+			throw Exception::BadStream(filename).SetDiagMsg(L"Failed to write archive data.");
+	};
+
+	for (uint job = 0; job < jobs.size();)
+	{
+		const ArchiveEntry& entry = list[jobs[job].entry];
+		const uint first = job;
+
+		u32 crc = jobs[job].crc;
+		u32 compressedSize = jobs[job].out.size();
+		for (++job; job < jobs.size() && jobs[job].entry == jobs[first].entry; ++job)
+		{
+			crc = crc32_combine(crc, jobs[job].crc, jobs[job].size);
+			compressedSize += jobs[job].out.size();
+		}
+
+		const uint chunks = job - first;
+		if (count == 0xffff || 4 + chunks * 4 > 0xffff || (u64)offset + compressedSize > 0xffffffffull)
+			throw Exception::BadStream(filename).SetDiagMsg(L"Archive is too large for the zip format.");
+
+		std::vector<u8> extra;
+		Put16(extra, ChunkTableTag);
+		Put16(extra, 4 + chunks * 4);
+		Put32(extra, ChunkSize);
+		for (uint i = first; i < job; ++i)
+			Put32(extra, jobs[i].out.size());
+
+		const wxScopedCharBuffer name(entry.GetFilename().ToUTF8());
+
+		// Fields shared by the local and central headers, from "version needed" onwards.
+		std::vector<u8> common;
+		Put16(common, ZipVersion);
+		Put16(common, ZipFlagUTF8);
+		Put16(common, ZipMethodDeflate);
+		Put32(common, dosTime);
+		Put32(common, crc);
+		Put32(common, compressedSize);
+		Put32(common, entry.GetDataSize());
+		Put16(common, name.length());
+		Put16(common, extra.size());
+
+		header.clear();
+		Put32(header, ZipLocalHeaderSig);
+		header.insert(header.end(), common.begin(), common.end());
+		header.insert(header.end(), name.data(), name.data() + name.length());
+		header.insert(header.end(), extra.begin(), extra.end());
+		write(header.data(), header.size());
+
+		for (uint i = first; i < job; ++i)
+			write(jobs[i].out.data(), jobs[i].out.size());
+
+		Put32(central, ZipCentralHeaderSig);
+		Put16(central, ZipVersion);
+		central.insert(central.end(), common.begin(), common.end());
+		Put16(central, 0); // comment length
+		Put16(central, 0); // disk number
+		Put16(central, 0); // internal attributes
+		Put32(central, 0); // external attributes
+		Put32(central, offset);
+		central.insert(central.end(), name.data(), name.data() + name.length());
+		central.insert(central.end(), extra.begin(), extra.end());
+
+		offset += header.size() + compressedSize;
+		++count;
+	}
+
+	Put32(central, ZipEndOfDirectorySig);
+	const uint directorySize = central.size() - 4;
+	Put16(central, 0); // disk number
+	Put16(central, 0); // disk holding the directory
+	Put16(central, count);
+	Put16(central, count);
+	Put32(central, directorySize);
+	Put32(central, offset);
+	Put16(central, 0); // comment length
+	write(central.data(), central.size());
+
+	if (!file.Close())
+		throw Exception::BadStream(filename).SetDiagMsg(L"Failed to close archive.");
+}
+
+// --------------------------------------------------------------------------------------
+//  ParallelZip::Reader
+// --------------------------------------------------------------------------------------
+bool ParallelZip::Reader::Open(const wxString& filename)
+{
+	m_filename = filename;
+	m_entries.clear();
+
+	if (!m_file.Open(filename, L"rb"))
+		throw Exception::CannotCreateStream(filename).SetDiagMsg(L"Cannot open file for reading.");
+
+	return ReadCentralDirectory();
+}
+
+bool ParallelZip::Reader::ReadCentralDirectory()
+{
+	const wxFileOffset length = m_file.Length();
+	if (length < (wxFileOffset)ZipEndOfDirectorySize || length > 0xffffffffll)
+		return false;
+
+	// The end of directory record is followed by a comment of up to 64k.
+	const uint tailSize = std::min<wxFileOffset>(length, ZipEndOfDirectorySize + 0xffff);
+	std::vector<u8> tail(tailSize);
+	if (!m_file.Seek(length - tailSize) || m_file.Read(tail.data(), tailSize) != tailSize)
+		return false;
+
+	const u8* eocd = nullptr;
+	for (uint pos = tailSize - ZipEndOfDirectorySize + 1; pos-- > 0;)
+	{
+		if (Get32(&tail[pos]) == ZipEndOfDirectorySig)
+		{
+			eocd = &tail[pos];
+			break;
+		}
+	}
+
+	if (!eocd)
+		return false;
+
+	const uint count = Get16(eocd + 10);
+	const u32 directorySize = Get32(eocd + 12);
+	const u32 directoryOffset = Get32(eocd + 16);
+	if ((u64)directoryOffset + directorySize > (u64)length)
+		return false;
+
+	std::vector<u8> directory(directorySize);
+	if (!m_file.Seek(directoryOffset) || m_file.Read(directory.data(), directorySize) != directorySize)
+		return false;
+
+	uint pos = 0;
+	for (uint i = 0; i < count; ++i)
+	{
+		if (pos + ZipCentralHeaderSize > directorySize)
+			return false;
+
+		const u8* hdr = &directory[pos];
+		if (Get32(hdr) != ZipCentralHeaderSig)
+			return false;
+
+		const u16 flags = Get16(hdr + 8);
+		const uint nameLength = Get16(hdr + 28);
+		const uint extraLength = Get16(hdr + 30);
+		const uint commentLength = Get16(hdr + 32);
+		if (pos + ZipCentralHeaderSize + nameLength + extraLength + commentLength > directorySize)
+			return false;
+
+		// Encrypted entries are not supported.
+		if (flags & 1)
+			return false;
+
+		Entry entry;
+		entry.method = Get16(hdr + 10);
+		entry.crc = Get32(hdr + 16);
+		entry.compressedSize = Get32(hdr + 20);
+		entry.size = Get32(hdr + 24);
+		entry.localOffset = Get32(hdr + 42);
+		entry.chunkSize = 0;
+
+		// zip64 entries are not supported.
+		if (entry.compressedSize == 0xffffffff || entry.size == 0xffffffff || entry.localOffset == 0xffffffff)
+			return false;
+
+		const char* name = (const char*)hdr + ZipCentralHeaderSize;
+		entry.name = wxString::FromUTF8(name, nameLength);
+		if (entry.name.IsEmpty())
+			entry.name = wxString::From8BitData(name, nameLength);
+
+		const u8* extra = hdr + ZipCentralHeaderSize + nameLength;
+		for (uint epos = 0; epos + 4 <= extraLength;)
+		{
+			const u16 tag = Get16(extra + epos);
+			const uint size = Get16(extra + epos + 2);
+			if (epos + 4 + size > extraLength)
+				break;
+
+			if (tag == ChunkTableTag && size >= 4 && entry.method == ZipMethodDeflate)
+			{
+				entry.chunkSize = Get32(extra + epos + 4);
+				u32 total = 0;
+				for (uint c = 8; c + 4 <= size + 4; c += 4)
+				{
+					entry.chunks.push_back(Get32(extra + epos + c));
+					total += entry.chunks.back();
+				}
+
+				// Ignore a table that doesn't describe this entry; it's inflated in one go.
+				const uint expected = entry.chunkSize ? (entry.size + entry.chunkSize - 1) / entry.chunkSize : 0;
+				if (!entry.chunkSize || entry.chunks.size() != expected || total != entry.compressedSize)
+				{
+					entry.chunkSize = 0;
+					entry.chunks.clear();
+				}
+			}
+
+			epos += 4 + size;
+		}
+
+		m_entries.push_back(std::move(entry));
+		pos += ZipCentralHeaderSize + nameLength + extraLength + commentLength;
+	}
+
+	return true;
+}
+
+const ParallelZip::Reader::Entry* ParallelZip::Reader::Find(const wxString& name) const
+{
+	for (const Entry& entry : m_entries)
+	{
+		if (entry.name.CmpNoCase(name) == 0)
+			return &entry;
+	}
+
+	return nullptr;
+}
+
+void ParallelZip::Reader::ReadCompressed(const Entry& entry, std::vector<u8>& dest)
+{
+	u8 hdr[ZipLocalHeaderSize];
+	if (!m_file.Seek(entry.localOffset) || m_file.Read(hdr, sizeof(hdr)) != sizeof(hdr) || Get32(hdr) != ZipLocalHeaderSig)
+		throw Exception::BadStream(m_filename).SetDiagMsg(pxsFmt(L"Zip entry '%s' has an invalid local header.", WX_STR(entry.name)));
+
+	const wxFileOffset data = (wxFileOffset)entry.localOffset + ZipLocalHeaderSize + Get16(hdr + 26) + Get16(hdr + 28);
+
+	dest.resize(entry.compressedSize);
+	if (!m_file.Seek(data) || m_file.Read(dest.data(), dest.size()) != dest.size())
+		throw Exception::BadStream(m_filename).SetDiagMsg(pxsFmt(L"Zip entry '%s' is truncated.", WX_STR(entry.name)));
+}
+
+struct InflateJob
+{
+	uint request;
+	const u8* src;
+	uint srcSize;
+	u8* dest;
+	uint destSize;
+	bool stored;
+	bool last;
+
+	u32 crc;
+};
+
+static bool InflateChunk(InflateJob& job)
+{
+	if (job.stored)
+	{
+		memcpy(job.dest, job.src, job.destSize);
+	}
+	else
+	{
+		z_stream strm = {};
+		if (inflateInit2(&strm, -MAX_WBITS) != Z_OK)
+			return false;
+
+		strm.next_in = const_cast<u8*>(job.src);
+		strm.avail_in = job.srcSize;
+		strm.next_out = job.dest;
+		strm.avail_out = job.destSize;
+
+		// Chunks other than the last end on a sync flush rather than the end of the stream;
+		// the CRC check catches anything the size check lets through.
+		const int ret = inflate(&strm, job.last ? Z_FINISH : Z_SYNC_FLUSH);
+		const bool ok = (strm.total_out == job.destSize) && (job.last ? ret == Z_STREAM_END : (ret == Z_OK || ret == Z_BUF_ERROR));
+		inflateEnd(&strm);
+
+		if (!ok)
+			return false;
+	}
+
+	job.crc = crc32(crc32(0L, Z_NULL, 0), job.dest, job.destSize);
+	return true;
+}
+
+void ParallelZip::Reader::Read(const Request* requests, uint count, uint workers)
+{
+	std::vector<std::vector<u8>> compressed(count);
+	std::vector<InflateJob> jobs;
+
+	for (uint r = 0; r < count; ++r)
+	{
+		const Entry& entry = *requests[r].entry;
+		if (entry.method != ZipMethodStore && entry.method != ZipMethodDeflate)
+			throw Exception::BadStream(m_filename).SetDiagMsg(pxsFmt(L"Zip entry '%s' uses unsupported compression method %u.", WX_STR(entry.name), entry.method));
+
+		if (entry.method == ZipMethodStore && entry.compressedSize != entry.size)
+			throw Exception::BadStream(m_filename).SetDiagMsg(pxsFmt(L"Zip entry '%s' is corrupt.", WX_STR(entry.name)));
+
+		if (!entry.size)
+			continue;
+
+		ReadCompressed(entry, compressed[r]);
+
+		InflateJob job;
+		job.request = r;
+		job.crc = 0;
+		job.stored = (entry.method == ZipMethodStore);
+		job.src = compressed[r].data();
+		job.dest = (u8*)requests[r].dest;
+
+		if (entry.chunks.empty())
+		{
+			job.srcSize = entry.compressedSize;
+			job.destSize = entry.size;
+			job.last = true;
+			jobs.push_back(job);
+			continue;
+		}
+
+		for (uint c = 0; c < entry.chunks.size(); ++c)
+		{
+			job.srcSize = entry.chunks[c];
+			job.destSize = std::min<uint>(entry.chunkSize, entry.size - c * entry.chunkSize);
+			job.last = (c + 1 == entry.chunks.size());
+			jobs.push_back(job);
+
+			job.src += job.srcSize;
+			job.dest += job.destSize;
+		}
+	}
+
+	const bool ok = RunJobs(jobs.size(), workers, [&jobs](uint i) { return InflateChunk(jobs[i]); });
+
+	// Jobs of a request are contiguous and in order, so their CRCs combine in sequence.
+	for (uint job = 0; ok && job < jobs.size();)
+	{
+		const Entry& entry = *requests[jobs[job].request].entry;
+		u32 crc = jobs[job].crc;
+		for (++job; job < jobs.size() && jobs[job].request == jobs[job - 1].request; ++job)
+			crc = crc32_combine(crc, jobs[job].crc, jobs[job].destSize);
+
+		if (crc != entry.crc)
+			throw Exception::BadStream(m_filename).SetDiagMsg(pxsFmt(L"Zip entry '%s' failed its CRC check.", WX_STR(entry.name)));
+	}
+
+	if (!ok)
+		throw Exception::BadStream(m_filename).SetDiagMsg(L"Failed to inflate archive data.");
+}
@@ -0,0 +1,95 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "ThreadedZipTools.h"
+
+#include <wx/ffile.h>
+#include <vector>
+
+// --------------------------------------------------------------------------------------
+//  ParallelZip
+// --------------------------------------------------------------------------------------
+// Plain zip archives whose deflated entries are built from independently compressed
+// chunks.  Every chunk but the last ends on a sync flush, so each entry is still a single
+// ordinary deflate stream that any zip reader (including older PCSX2 versions) can
+// inflate.  The compressed size of every chunk is recorded in a private extra field, which
+// lets the chunks of all entries be compressed and inflated on several threads at once.
+//
+// Entries are limited to 4GB and archives to 65535 entries (no zip64).
+//
+namespace ParallelZip
+{
+	static const uint ChunkSize = _256kb;
+
+	// Extra field ID holding the chunk table ("PX").
+	static const u16 ChunkTableTag = 0x5850;
+
+	// Returns the number of workers to use; saving leaves cores to the running emulator.
+	extern uint GetWorkerCount(bool background);
+
+	// Writes every non-empty entry of list to filename.
+	extern void WriteArchive(const wxString& filename, const ArchiveEntryList& list, uint workers);
+
+	class Reader
+	{
+	public:
+		struct Entry
+		{
+			wxString name;
+			u16 method;
+			u32 crc;
+			u32 compressedSize;
+			u32 size;
+			u32 localOffset;
+
+			// Uncompressed and compressed size of each chunk; no chunks for entries written
+			// by other tools.
+			u32 chunkSize;
+			std::vector<u32> chunks;
+		};
+
+		// An entry to read, and where to put its size bytes of data.
+		struct Request
+		{
+			const Entry* entry;
+			void* dest;
+		};
+
+	protected:
+		wxString m_filename;
+		wxFFile m_file;
+		std::vector<Entry> m_entries;
+
+	public:
+		Reader() = default;
+		virtual ~Reader() = default;
+
+		// Returns false if the file is not a zip archive this reader understands.
+		bool Open(const wxString& filename);
+
+		const std::vector<Entry>& GetEntries() const { return m_entries; }
+		const Entry* Find(const wxString& name) const;
+
+		// Reads and inflates the requested entries, spreading their chunks over the workers.
+		// Throws BadStream if any entry is corrupt.
+		void Read(const Request* requests, uint count, uint workers);
+
+	protected:
+		bool ReadCentralDirectory();
+		void ReadCompressed(const Entry& entry, std::vector<u8>& dest);
+	};
+} // namespace ParallelZip
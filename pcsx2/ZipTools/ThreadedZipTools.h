@@ -148,7 +148,6 @@ class BaseCompressThread
 	typedef pxThread _parent;
 
 protected:
-	pxOutputStream*					m_gzfp;
 	ArchiveEntryList*				m_src_list;
 	bool							m_PendingSaveFlag;
 	
@@ -169,25 +168,14 @@ public:
 		return *this;
 	}
 
-	BaseCompressThread& SetOutStream( pxOutputStream* out )
-	{
-		m_gzfp = out;
-		return *this;
-	}
-
-	BaseCompressThread& SetOutStream( pxOutputStream& out )
-	{
-		m_gzfp = &out;
-		return *this;
-	}
-
 	BaseCompressThread& SetFinishedPath( const wxString& path )
 	{
 		m_final_filename = path;
 		return *this;
 	}
 
-	wxString GetStreamName() const { return m_gzfp->GetStreamName(); }
+	// The archive is written here, and only moved over the final filename once complete.
+	wxString GetStreamName() const { return m_final_filename + L".tmp"; }
 
 	BaseCompressThread& SetTargetFilename(const wxString& filename)
 	{
@@ -198,7 +186,6 @@ public:
 protected:
 	BaseCompressThread()
 	{
-		m_gzfp				= NULL;
 		m_src_list			= NULL;
 		m_PendingSaveFlag	= false;
 	}
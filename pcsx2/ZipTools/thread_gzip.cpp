@@ -18,6 +18,7 @@
 #include "App.h"
 #include "SaveState.h"
 #include "ThreadedZipTools.h"
+#include "ParallelZip.h"
 #include "Utilities/SafeArray.inl"
 #include "wx/wfstream.h"
 
@@ -55,31 +56,10 @@ void BaseCompressThread::ExecuteTaskInThread()
 	
 	Yield( 3 );
 
-	uint listlen = m_src_list->GetLength();
-	for( uint i=0; i<listlen; ++i )
-	{
-		const ArchiveEntry& entry = (*m_src_list)[i];
-		if (!entry.GetDataSize()) continue;
+	// Entries are deflated in chunks on several workers; see ParallelZip.
+	ParallelZip::WriteArchive( GetStreamName(), *m_src_list, ParallelZip::GetWorkerCount(true) );
 
-		wxArchiveOutputStream& woot = *(wxArchiveOutputStream*)m_gzfp->GetWxStreamBase();
-		woot.PutNextEntry( entry.GetFilename() );
-
-		static const uint BlockSize = 0x64000;
-		uint curidx = 0;
-
-		do {
-			uint thisBlockSize = std::min( BlockSize, entry.GetDataSize() - curidx );
-			m_gzfp->Write(m_src_list->GetPtr( entry.GetDataIndex() + curidx ), thisBlockSize);
-			curidx += thisBlockSize;
-			Yield( 2 );
-		} while( curidx < entry.GetDataSize() );
-		
-		woot.CloseEntry();
-	}
-
-	m_gzfp->Close();
-
-	if( !wxRenameFile( m_gzfp->GetStreamName(), m_final_filename, true ) )
+	if( !wxRenameFile( GetStreamName(), m_final_filename, true ) )
 		throw Exception::BadStream( m_final_filename )
 		.SetDiagMsg(L"Failed to move or copy the temporary archive to the destination filename.")
 		.SetUserMsg(_("The savestate was not properly saved. The temporary file was created successfully but could not be moved to its final resting place."));
@@ -92,7 +72,6 @@ void BaseCompressThread::OnCleanupInThread()
 	_parent::OnCleanupInThread();
 	wxGetApp().DeleteThread( this );
 
-	safe_delete(m_gzfp);
 	safe_delete(m_src_list);
 }
 
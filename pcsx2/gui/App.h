@@ -200,6 +200,7 @@ enum MenuIdentifiers
 	MenuId_Recording_TogglePause,
 	MenuId_Recording_FrameAdvance,
 	MenuId_Recording_ToggleRecordingMode,
+	MenuId_Recording_GoToFrame,
 	MenuId_Recording_VirtualPad_Port0,
 	MenuId_Recording_VirtualPad_Port1,
 #endif
@@ -340,6 +341,20 @@ public:
 	bool SysAutoRunElf;
 	bool SysAutoRunIrx;
 
+	// Replays this GS dump headless and exits instead of starting the GUI (--gsbench).
+	wxString GSBenchmarkDump;
+	wxString GSBenchmarkReport;
+	wxString GSBenchmarkRenderer;
+	long GSBenchmarkLoops;
+	long GSBenchmarkThreads;
+	bool GSBenchmarkHash;
+
+	// Times the VIF unpack recompiler and exits instead of starting the GUI (--vifbench).
+	long VifBenchmarkLoops;
+
+	// Converts this disc image to a seekable .xz image and exits instead of starting the GUI (--isotoxz).
+	wxString IsoToXzSource;
+
 	StartupOptions()
 	{
 		ForceWizard = false;
@@ -350,6 +365,10 @@ public:
 		SysAutoRunElf = false;
 		SysAutoRunIrx = false;
 		CdvdSource = CDVD_SourceType::NoDisc;
+		GSBenchmarkLoops = 1;
+		GSBenchmarkThreads = -1;
+		GSBenchmarkHash = false;
+		VifBenchmarkLoops = 0;
 	}
 };
 
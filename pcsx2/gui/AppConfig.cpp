@@ -847,6 +847,7 @@ void AppConfig::GSWindowOptions::LoadSave( IniInterface& ini )
 AppConfig::InputRecordingOptions::InputRecordingOptions()
 	: VirtualPadPosition(wxDefaultPosition)
 	, m_frame_advance_amount(1)
+	, m_keyframe_interval(3600)
 {
 }
 
@@ -856,6 +857,7 @@ void AppConfig::InputRecordingOptions::loadSave(IniInterface& ini)
 
 	IniEntry(VirtualPadPosition);
 	IniEntry(m_frame_advance_amount);
+	IniEntry(m_keyframe_interval);
 }
 #endif
 
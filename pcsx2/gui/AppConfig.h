@@ -255,6 +255,8 @@ public:
 	{
 		wxPoint VirtualPadPosition;
 		int m_frame_advance_amount;
+		// Frames between keyframe snapshots embedded in recordings, 0 disables them
+		int m_keyframe_interval;
 
 		InputRecordingOptions();
 		void loadSave(IniInterface& conf);
@@ -620,6 +620,7 @@ void AppCoreThread::OnCleanupInThread()
 void AppCoreThread::VsyncInThread()
 {
 	wxGetApp().LogicalVsync();
+	StateCopy_RewindFrame();
 	_parent::VsyncInThread();
 }
 
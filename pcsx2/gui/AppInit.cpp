@@ -25,6 +25,10 @@
 #include "Dialogs/ModalPopups.h"
 
 #include "Debugger/DisassemblyDialog.h"
+#include "GS/GSBenchmark.h"
+#include "x86/newVif.h"
+#include "CDVD/IsoFileFormats.h"
+#include "Utilities/Perf.h"
 
 #ifndef DISABLE_RECORDING
 #include "Recording/InputRecording.h"
@@ -233,6 +237,18 @@ void Pcsx2App::OnInitCmdLine(wxCmdLineParser& parser)
 
 	parser.AddSwitch(wxEmptyString, L"profiling", _("update options to ease profiling (debug)"));
 
+	parser.AddOption(wxEmptyString, L"gsbench", _("replays a .gs or .gs.xz dump without a window, prints the frame timings and exits"), wxCMD_LINE_VAL_STRING);
+	parser.AddOption(wxEmptyString, L"gsbench-renderer", _("renderer used by --gsbench: sw (default) or null"), wxCMD_LINE_VAL_STRING);
+	parser.AddOption(wxEmptyString, L"gsbench-loops", _("number of times --gsbench replays the dump"), wxCMD_LINE_VAL_NUMBER);
+	parser.AddOption(wxEmptyString, L"gsbench-threads", _("software renderer threads used by --gsbench"), wxCMD_LINE_VAL_NUMBER);
+	parser.AddOption(wxEmptyString, L"gsbench-report", _("writes the --gsbench per frame report to a .csv or .json file"), wxCMD_LINE_VAL_STRING);
+	parser.AddSwitch(wxEmptyString, L"gsbench-hash", _("adds a hash of the displayed frame to the --gsbench report"));
+	parser.AddOption(wxEmptyString, L"isotoxz", _("converts the given disc image to a seekable <image>.xz next to it and exits"), wxCMD_LINE_VAL_STRING);
+	parser.AddOption(wxEmptyString, L"vifbench", _("times the VIF unpack recompiler over synthetic data for the given number of loops and exits"), wxCMD_LINE_VAL_NUMBER);
+
+	parser.AddSwitch(wxEmptyString, L"jitdump", _("writes the recompiled code to /tmp/jit-PID.dump for perf (Linux)"));
+	parser.AddOption(wxEmptyString, L"jitprofile", _("samples the recompiled code and writes the hottest guest blocks of each game to this folder (Linux)"), wxCMD_LINE_VAL_STRING);
+
 	parser.SetSwitchChars(L"-");
 }
 
@@ -337,6 +353,25 @@ bool Pcsx2App::OnCmdLineParsed(wxCmdLineParser& parser)
 		Startup.SysAutoRun = true;
 	}
 
+	if (parser.Found(L"gsbench", &Startup.GSBenchmarkDump))
+	{
+		parser.Found(L"gsbench-renderer", &Startup.GSBenchmarkRenderer);
+		parser.Found(L"gsbench-loops", &Startup.GSBenchmarkLoops);
+		parser.Found(L"gsbench-threads", &Startup.GSBenchmarkThreads);
+		parser.Found(L"gsbench-report", &Startup.GSBenchmarkReport);
+		Startup.GSBenchmarkHash = parser.Found(L"gsbench-hash");
+	}
+
+	parser.Found(L"vifbench", &Startup.VifBenchmarkLoops);
+	parser.Found(L"isotoxz", &Startup.IsoToXzSource);
+
+	if (parser.Found(L"jitdump") && !Perf::EnableJitDump())
+		Console.Warning(L"jitdump isn't available on this platform.");
+
+	wxString profile;
+	if (parser.Found(L"jitprofile", &profile) && !Perf::StartSampling(profile.ToUTF8()))
+		Console.Warning(L"The recompiler profiler isn't available on this platform.");
+
 	return true;
 }
 
@@ -384,6 +419,43 @@ protected:
 	}
 };
 
+static int RunGSBenchmark(const StartupOptions& startup)
+{
+	GSBenchmarkOptions options;
+
+	options.dump = startup.GSBenchmarkDump.ToUTF8();
+	options.report = startup.GSBenchmarkReport.ToUTF8();
+	options.loops = std::max(1L, startup.GSBenchmarkLoops);
+	options.threads = startup.GSBenchmarkThreads;
+	options.hash = startup.GSBenchmarkHash;
+
+	if (startup.GSBenchmarkRenderer.IsSameAs(L"null", false))
+		options.renderer = GSRendererType::Null;
+	else if (startup.GSBenchmarkRenderer.IsEmpty() || startup.GSBenchmarkRenderer.IsSameAs(L"sw", false))
+		options.renderer = GSRendererType::OGL_SW;
+	else
+	{
+		Console.Error(L"GS benchmark: unknown renderer " + startup.GSBenchmarkRenderer);
+		return 1;
+	}
+
+	return GSBenchmark(options);
+}
+
+static int RunIsoToXz(const wxString& srcfile)
+{
+	try
+	{
+		ConvertIsoToXz(srcfile, srcfile + L".xz");
+		return EXIT_SUCCESS;
+	}
+	catch (Exception::BaseException& ex)
+	{
+		Console.Error(ex.FormatDiagnosticMessage());
+		return EXIT_FAILURE;
+	}
+}
+
 bool Pcsx2App::OnInit()
 {
 	EnableAllLogging();
@@ -434,6 +506,29 @@ bool Pcsx2App::OnInit()
 		SysExecutorThread.Start();
 		DetectCpuAndUserMode();
 
+		if (!Startup.GSBenchmarkDump.IsEmpty())
+		{
+			// Batch mode: no GUI and no emulation. wx has no way to return a status
+			// from OnInit, so leave with the benchmark's own exit code.
+			const int result = RunGSBenchmark(Startup);
+			CleanupOnExit();
+			exit(result);
+		}
+
+		if (Startup.VifBenchmarkLoops > 0)
+		{
+			const int result = dVifBenchmark(Startup.VifBenchmarkLoops);
+			CleanupOnExit();
+			exit(result);
+		}
+
+		if (!Startup.IsoToXzSource.IsEmpty())
+		{
+			const int result = RunIsoToXz(Startup.IsoToXzSource);
+			CleanupOnExit();
+			exit(result);
+		}
+
 		//   Set Manual Exit Handling
 		// ----------------------------
 		// PCSX2 has a lot of event handling logistics, so we *cannot* depend on wxWidgets automatic event
@@ -601,6 +696,8 @@ void Pcsx2App::CleanupOnExit()
 		Console.Indent().Error(ex.FormatDiagnosticMessage());
 	}
 
+	Perf::StopSampling();
+
 	// FIXME: performing a wxYield() here may fix that problem. -- air
 
 	pxDoAssert = pxAssertImpl_LogIt;
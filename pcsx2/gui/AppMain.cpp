@@ -741,6 +741,7 @@ void AppApplySettings( const AppConfig* oldconf )
 	g_Conf->Folders.CheatsWS.Mkdir();
 
 	g_Conf->EmuOptions.BiosFilename = g_Conf->FullpathToBios();
+	g_Conf->EmuOptions.VUCacheFolder = wxFileName::DirName(GetSettingsFolder().Combine(wxDirName(L"mvu_cache")).ToString());
 
 	RelocateLogfile();
 
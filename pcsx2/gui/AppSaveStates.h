@@ -19,7 +19,18 @@
 #include "SaveState.h"
 #include "Saveslots.h"
 
+#include <functional>
+#include <vector>
+
+// Receives a compressed snapshot of the whole VM and the g_FrameCount it was taken at.
+// Called on the SysExecutor thread.
+typedef std::function<void(u32 frame, std::vector<u8>& snapshot)> StateSnapshotHandler;
+
 extern void StateCopy_SaveToFile(const wxString& file);
 extern void StateCopy_LoadFromFile(const wxString& file);
 extern void StateCopy_SaveToSlot(uint num);
 extern void StateCopy_LoadFromSlot(uint slot, bool isFromBackup = false);
+extern void StateCopy_RewindFrame();
+extern void StateCopy_Rewind(bool stayPaused = false);
+extern bool StateCopy_SaveSnapshot(const StateSnapshotHandler& handler);
+extern void StateCopy_LoadSnapshot(std::vector<u8> snapshot);
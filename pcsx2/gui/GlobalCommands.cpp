@@ -514,6 +514,17 @@ namespace Implementations
 		if (GSFrame* gsframe = wxGetApp().GetGsFramePtr())
 			gsframe->ShowFullScreen(!gsframe->IsFullScreen());
 	}
+
+	void States_Rewind()
+	{
+		if (!EmuConfig.Rewind.Enabled)
+		{
+			OSDlog(Color_StrongRed, true, "Rewind is disabled.");
+			return;
+		}
+
+		StateCopy_Rewind();
+	}
 #ifndef DISABLE_RECORDING
 	void FrameAdvance()
 	{
@@ -539,6 +550,14 @@ namespace Implementations
 		}
 	}
 
+	void FrameRewind()
+	{
+		if (g_Conf->EmuOptions.EnableRecordingTools && EmuConfig.Rewind.Enabled)
+		{
+			g_InputRecordingControls.FrameRewind();
+		}
+	}
+
 	void GoToFirstFrame()
 	{
 		if (g_Conf->EmuOptions.EnableRecordingTools && g_InputRecording.IsActive())
@@ -712,6 +731,14 @@ static const GlobalCommandDescriptor CommandDeclarations[] =
 			false,
 		},
 
+		{
+			"States_Rewind",
+			Implementations::States_Rewind,
+			pxL("Rewind"),
+			pxL("Restores the most recent in-memory rewind snapshot; repeat to step further back."),
+			false,
+		},
+
 		{
 			"Frameskip_Toggle",
 			Implementations::Frameskip_Toggle,
@@ -843,6 +870,7 @@ static const GlobalCommandDescriptor CommandDeclarations[] =
 
 #ifndef DISABLE_RECORDING
 		{"FrameAdvance", Implementations::FrameAdvance, NULL, NULL, false},
+		{"FrameRewind", Implementations::FrameRewind, NULL, NULL, false},
 		{"TogglePause", Implementations::TogglePause, NULL, NULL, false},
 		{"InputRecordingModeToggle", Implementations::InputRecordingModeToggle, NULL, NULL, false},
 		{"GoToFirstFrame", Implementations::GoToFirstFrame, NULL, NULL, false},
@@ -1022,6 +1050,7 @@ void Pcsx2App::InitDefaultGlobalAccelerators()
 	GlobalAccels->Map(AAC(WXK_F3), "States_DefrostCurrentSlot");
 	GlobalAccels->Map(AAC(WXK_F2), "States_CycleSlotForward");
 	GlobalAccels->Map(AAC(WXK_F2).Shift(), "States_CycleSlotBackward");
+	GlobalAccels->Map(AAC(WXK_BACK), "States_Rewind");
 
 	GlobalAccels->Map(AAC(WXK_F4), "Framelimiter_MasterToggle");
 	GlobalAccels->Map(AAC(WXK_F4).Shift(), "Frameskip_Toggle");
@@ -398,8 +398,8 @@ bool MainEmuFrame::_DoSelectIsoBrowser(wxString& result)
 
 	wxArrayString isoFilterTypes;
 
-	isoFilterTypes.Add(pxsFmt(_("All Supported (%s)"), WX_STR((isoSupportedLabel + L" .dump" + L" .gz" + L" .cso" + L" .chd"))));
-	isoFilterTypes.Add(isoSupportedList + L";*.dump" + L";*.gz" + L";*.cso" + L";*.chd");
+	isoFilterTypes.Add(pxsFmt(_("All Supported (%s)"), WX_STR((isoSupportedLabel + L" .dump" + L" .gz" + L" .cso" + L" .chd" + L" .xz"))));
+	isoFilterTypes.Add(isoSupportedList + L";*.dump" + L";*.gz" + L";*.cso" + L";*.chd" + L";*.xz");
 
 	isoFilterTypes.Add(pxsFmt(_("Disc Images (%s)"), WX_STR(isoSupportedLabel)));
 	isoFilterTypes.Add(isoSupportedList);
@@ -407,8 +407,8 @@ bool MainEmuFrame::_DoSelectIsoBrowser(wxString& result)
 	isoFilterTypes.Add(pxsFmt(_("Blockdumps (%s)"), L".dump"));
 	isoFilterTypes.Add(L"*.dump");
 
-	isoFilterTypes.Add(pxsFmt(_("Compressed (%s)"), L".gz .cso .chd"));
-	isoFilterTypes.Add(L"*.gz;*.cso;*.chd");
+	isoFilterTypes.Add(pxsFmt(_("Compressed (%s)"), L".gz .cso .chd .xz"));
+	isoFilterTypes.Add(L"*.gz;*.cso;*.chd;*.xz");
 
 	isoFilterTypes.Add(_("All Files (*.*)"));
 	isoFilterTypes.Add(L"*.*");
@@ -1124,6 +1124,7 @@ void MainEmuFrame::StartInputRecording()
 	m_menuRecording.FindChildItem(MenuId_Recording_New)->Enable(false);
 	m_menuRecording.FindChildItem(MenuId_Recording_Stop)->Enable(true);
 	m_menuRecording.FindChildItem(MenuId_Recording_ToggleRecordingMode)->Enable(true);
+	m_menuRecording.FindChildItem(MenuId_Recording_GoToFrame)->Enable(true);
 	ApplyFirstFrameStatus();
 }
 
@@ -1135,6 +1136,7 @@ void MainEmuFrame::StopInputRecording()
 		m_menuRecording.FindChildItem(MenuId_Recording_New)->Enable(true);
 		m_menuRecording.FindChildItem(MenuId_Recording_Stop)->Enable(false);
 		m_menuRecording.FindChildItem(MenuId_Recording_ToggleRecordingMode)->Enable(false);
+		m_menuRecording.FindChildItem(MenuId_Recording_GoToFrame)->Enable(false);
 		ApplyCDVDStatus();
 	}
 }
@@ -1157,6 +1159,17 @@ void MainEmuFrame::Menu_Recording_ToggleRecordingMode_Click(wxCommandEvent& even
 		g_InputRecordingControls.RecordModeToggle();
 }
 
+void MainEmuFrame::Menu_Recording_GoToFrame_Click(wxCommandEvent& event)
+{
+	if (!g_Conf->EmuOptions.EnableRecordingTools || !g_InputRecording.IsActive())
+		return;
+
+	const long totalFrames = g_InputRecording.GetInputRecordingData().GetTotalFrames();
+	long result = wxGetNumberFromUser(_("Enter the frame of the recording to go to"), _("Frame"), _("Go to Frame"), g_InputRecording.GetFrameCounter(), 0, totalFrames);
+	if (result != -1)
+		g_InputRecording.GoToFrame(result);
+}
+
 void MainEmuFrame::Menu_Recording_VirtualPad_Open_Click(wxCommandEvent& event)
 {
 	g_InputRecording.ShowVirtualPad(event.GetId() - MenuId_Recording_VirtualPad_Port0);
@@ -22,6 +22,7 @@
 #include "VUmicro.h"
 
 #include "ZipTools/ThreadedZipTools.h"
+#include "ZipTools/ParallelZip.h"
 #include "Utilities/pxStreams.h"
 #include "SPU2/spu2.h"
 #include "USB/USB.h"
@@ -33,8 +34,11 @@
 
 #include "ConsoleLogger.h"
 
-#include <wx/wfstream.h>
+#include <wx/mstream.h>
+#include <atomic>
+#include <deque>
 #include <memory>
+#include <zlib.h>
 
 #include "Patch.h"
 
@@ -44,6 +48,7 @@
 static const wxChar* EntryFilename_StateVersion = L"PCSX2 Savestate Version.id";
 static const wxChar* EntryFilename_Screenshot = L"Screenshot.jpg";
 static const wxChar* EntryFilename_InternalStructures = L"PCSX2 Internal Structures.dat";
+static const wxChar* EntryFilename_Delta = L"PCSX2 Delta Savestate.dat";
 
 struct SysState_Component
 {
@@ -352,26 +357,371 @@ static const std::unique_ptr<BaseSavestateEntry> SavestateEntries[] = {
 //
 static Mutex mtx_CompressToDisk;
 
-static void CheckVersion(pxInputStream& thr)
+static void CheckVersion(const wxString& filename, u32 savever)
 {
-	u32 savever;
-	thr.Read(savever);
-
 	// Major version mismatch.  Means we can't load this savestate at all.  Support for it
 	// was removed entirely.
 	if (savever > g_SaveVersion)
-		throw Exception::SaveStateLoadError(thr.GetStreamName())
+		throw Exception::SaveStateLoadError(filename)
 			.SetDiagMsg(pxsFmt(L"Savestate uses an unsupported or unknown savestate version.\n(PCSX2 ver=%x, state ver=%x)", g_SaveVersion, savever))
 			.SetUserMsg(_("Cannot load this savestate. The state is an unsupported version."));
 
 	// check for a "minor" version incompatibility; which happens if the savestate being loaded is a newer version
 	// than the emulator recognizes.  99% chance that trying to load it will just corrupt emulation or crash.
 	if ((savever >> 16) != (g_SaveVersion >> 16))
-		throw Exception::SaveStateLoadError(thr.GetStreamName())
+		throw Exception::SaveStateLoadError(filename)
 			.SetDiagMsg(pxsFmt(L"Savestate uses an unknown savestate version.\n(PCSX2 ver=%x, state ver=%x)", g_SaveVersion, savever))
 			.SetUserMsg(_("Cannot load this savestate. The state is an unsupported version."));
 };
 
+// --------------------------------------------------------------------------------------
+//  Flat savestate images and delta savestates
+// --------------------------------------------------------------------------------------
+// A flat image is the internal structures block followed by every SavestateEntries
+// component, in order -- the buffer layout SysExecEvent_DownloadState produces.  When
+// DeltaSavestates is enabled, a state is saved as the pages of its flat image that differ
+// from the last full state saved or loaded (its parent), plus the parent's filename.
+// Deltas always refer to a full state, so loading one reads at most two archives.
+//
+// Both the ZipToDisk and UnzipFromDisk events run on the SysExecutor thread, which is
+// the only user of s_delta_parent.
+//
+static const uint FlatStateEntries = 1 + ArraySize(SavestateEntries);
+
+struct FlatVmState
+{
+	wxString filename;
+	std::unique_ptr<VmStateBuffer> buffer;
+	u32 sizes[FlatStateEntries];
+	uint size;
+	u32 crc;
+
+	FlatVmState()
+		: size(0)
+		, crc(0)
+	{
+		memzero(sizes);
+	}
+};
+
+static FlatVmState s_delta_parent;
+
+// Gets the flat layout of a downloaded state.  Returns false if the entry list does not
+// follow it (which means it can't be used with deltas).
+static bool GetFlatLayout(const ArchiveEntryList& list, u32* sizes, uint& size)
+{
+	if (list.GetLength() != FlatStateEntries)
+		return false;
+
+	size = 0;
+	for (uint i = 0; i < FlatStateEntries; ++i)
+	{
+		if (list[i].GetDataIndex() != size)
+			return false;
+
+		sizes[i] = list[i].GetDataSize();
+		size += sizes[i];
+	}
+
+	return true;
+}
+
+// Remembers a full state that is being saved as the parent of future delta states.
+static void SetDeltaParent(const ArchiveEntryList& list, const wxString& filename)
+{
+	FlatVmState parent;
+	if (!GetFlatLayout(list, parent.sizes, parent.size))
+	{
+		s_delta_parent = FlatVmState();
+		return;
+	}
+
+	parent.filename = filename;
+	parent.buffer = std::make_unique<VmStateBuffer>(parent.size, L"Delta Savestate Parent");
+	memcpy(parent.buffer->GetPtr(), list.GetPtr(0), parent.size);
+	parent.crc = SaveStateDelta::Checksum(parent.buffer->GetPtr(), parent.size);
+
+	s_delta_parent = std::move(parent);
+}
+
+// Builds the archive contents of a delta savestate for the given full download, or
+// returns NULL if the state should be saved in full instead.
+static ArchiveEntryList* MakeDeltaList(const ArchiveEntryList& full, const wxString& filename)
+{
+	if (!s_delta_parent.buffer)
+		return NULL;
+
+	// Overwriting the parent itself, or the parent was moved away (slot backups).
+	if (s_delta_parent.filename == filename || !wxFileExists(s_delta_parent.filename))
+		return NULL;
+
+	u32 sizes[FlatStateEntries];
+	uint size;
+	if (!GetFlatLayout(full, sizes, size))
+		return NULL;
+
+	VmStateBuffer pages(L"Delta Savestate Pages");
+	const uint pagesSize = SaveStateDelta::Create(s_delta_parent.buffer->GetPtr(), s_delta_parent.size, s_delta_parent.crc,
+												  full.GetPtr(0), size, pages);
+
+	// Too far from the parent to be worth it; this state becomes the new parent.
+	if (pagesSize > size / 2)
+		return NULL;
+
+	std::unique_ptr<ArchiveEntryList> list(new ArchiveEntryList(new VmStateBuffer(L"Delta Savestate")));
+	memSavingState saveme(list->GetBuffer());
+
+	pxToUTF8 utf8(s_delta_parent.filename);
+	u32 parentLen = utf8.Length();
+
+	saveme.FreezeTag("DeltaParent");
+	saveme.Freeze(parentLen);
+	saveme.FreezeMem(const_cast<char*>((const char*)utf8), parentLen);
+	saveme.Freeze(sizes);
+	saveme.FreezeMem(pages.GetPtr(), pagesSize);
+
+	list->Add(ArchiveEntry(EntryFilename_Delta).SetDataIndex(0).SetDataSize(saveme.GetCurrentPos()));
+
+	Console.Indent().WriteLn(Color_StrongGreen, L"Saving delta state against %s (%u KB of %u KB)",
+							 WX_STR(Path::GetFilename(s_delta_parent.filename)), pagesSize / 1024, size / 1024);
+
+	return list.release();
+}
+
+// Reads a savestate archive.  Full states are unpacked into `state` in the flat layout
+// and 0 is returned; delta states are copied into `delta` and their size is returned.
+// The components are inflated in parallel, straight into their place in the flat image.
+static uint ReadStateArchive(const wxString& filename, FlatVmState& state, VmStateBuffer& delta)
+{
+	ParallelZip::Reader zip;
+	if (!zip.Open(filename))
+	{
+		throw Exception::SaveStateLoadError(filename)
+			.SetDiagMsg(L"Savestate file is not a valid gzip archive.")
+			.SetUserMsg(_("This savestate cannot be loaded because it is not a valid gzip archive.  It may have been created by an older unsupported version of PCSX2, or it may be corrupted."));
+	}
+
+	const uint workers = ParallelZip::GetWorkerCount(false);
+
+	// look for version and screenshot information in the zip stream:
+
+	const ParallelZip::Reader::Entry* foundVersion = zip.Find(EntryFilename_StateVersion);
+	const ParallelZip::Reader::Entry* foundInternal = zip.Find(EntryFilename_InternalStructures);
+	const ParallelZip::Reader::Entry* foundDelta = zip.Find(EntryFilename_Delta);
+	const ParallelZip::Reader::Entry* foundEntry[ArraySize(SavestateEntries)];
+
+	// No point in finding screenshots when loading states -- the screenshots are
+	// only useful for the UI savestate browser.
+
+	for (uint i = 0; i < ArraySize(SavestateEntries); ++i)
+	{
+		foundEntry[i] = zip.Find(SavestateEntries[i]->GetFilename());
+		if (foundEntry[i])
+			DevCon.WriteLn(Color_Green, L" ... found '%s'", WX_STR(SavestateEntries[i]->GetFilename()));
+	}
+
+	if (foundVersion && foundVersion->size == sizeof(u32))
+	{
+		DevCon.WriteLn(Color_Green, L" ... found '%s'", EntryFilename_StateVersion);
+
+		u32 savever;
+		const ParallelZip::Reader::Request request = {foundVersion, &savever};
+		zip.Read(&request, 1, 1);
+		CheckVersion(filename, savever);
+	}
+	else
+		foundVersion = nullptr;
+
+	if (foundVersion && foundDelta)
+	{
+		DevCon.WriteLn(Color_Green, L" ... found '%s'", EntryFilename_Delta);
+
+		const uint size = foundDelta->size;
+		delta.MakeRoomFor(size);
+		const ParallelZip::Reader::Request request = {foundDelta, delta.GetPtr()};
+		zip.Read(&request, 1, workers);
+		return size;
+	}
+
+	if (!foundVersion || !foundInternal)
+	{
+		throw Exception::SaveStateLoadError(filename)
+			.SetDiagMsg(pxsFmt(L"Savestate file does not contain '%s'",
+							   !foundVersion ? EntryFilename_StateVersion : EntryFilename_InternalStructures))
+			.SetUserMsg(_("This file is not a valid PCSX2 savestate.  See the logfile for details."));
+	}
+
+	// Log any parts and pieces that are missing, and then generate an exception.
+	bool throwIt = false;
+	for (uint i = 0; i < ArraySize(SavestateEntries); ++i)
+	{
+		if (foundEntry[i])
+			continue;
+
+		if (SavestateEntries[i]->IsRequired())
+		{
+			throwIt = true;
+			Console.WriteLn(Color_Red, " ... not found '%s'!", WX_STR(SavestateEntries[i]->GetFilename()));
+		}
+	}
+
+	if (throwIt)
+		throw Exception::SaveStateLoadError(filename)
+			.SetDiagMsg(L"Savestate cannot be loaded: some required components were not found or are incomplete.")
+			.SetUserMsg(_("This savestate cannot be loaded due to missing critical components.  See the log file for details."));
+
+	state.filename = filename;
+	state.sizes[0] = foundInternal->size;
+	state.size = state.sizes[0];
+	for (uint i = 0; i < ArraySize(SavestateEntries); ++i)
+	{
+		state.sizes[i + 1] = foundEntry[i] ? foundEntry[i]->size : 0;
+		state.size += state.sizes[i + 1];
+	}
+
+	state.buffer = std::make_unique<VmStateBuffer>(state.size, L"StateBuffer_UnzipFromDisk");
+
+	ParallelZip::Reader::Request requests[FlatStateEntries];
+	uint count = 0;
+
+	requests[count++] = {foundInternal, state.buffer->GetPtr()};
+
+	uint offset = state.sizes[0];
+	for (uint i = 0; i < ArraySize(SavestateEntries); ++i)
+	{
+		if (foundEntry[i])
+			requests[count++] = {foundEntry[i], state.buffer->GetPtr(offset)};
+		offset += state.sizes[i + 1];
+	}
+
+	Threading::pxTestCancel();
+
+	try
+	{
+		zip.Read(requests, count, workers);
+	}
+	catch (Exception::BadStream& ex)
+	{
+		throw Exception::SaveStateLoadError(filename)
+			.SetDiagMsg(ex.DiagMsg())
+			.SetUserMsg(_("This savestate cannot be loaded because it is corrupted.  See the log file for details."));
+	}
+
+	return 0;
+}
+
+// Rebuilds the flat image of a delta savestate, reading its parent from disk unless it
+// is the parent we already hold in memory.
+static void ResolveDeltaState(const wxString& filename, const VmStateBuffer& delta, uint deltaSize, FlatVmState& state)
+{
+	memLoadingState loader(delta);
+
+	u32 parentLen;
+	loader.FreezeTag("DeltaParent");
+	loader.Freeze(parentLen);
+	if (loader.GetCurrentPos() + parentLen + sizeof(state.sizes) > deltaSize)
+		throw Exception::SaveStateLoadError(filename).SetDiagMsg(L"Delta savestate is truncated.");
+
+	std::string utf8(parentLen, '\0');
+	loader.FreezeMem(&utf8[0], parentLen);
+	loader.Freeze(state.sizes);
+
+	const wxString parent(fromUTF8(utf8.c_str()));
+	if (!s_delta_parent.buffer || s_delta_parent.filename != parent)
+	{
+		if (!wxFileExists(parent))
+			throw Exception::SaveStateLoadError(filename)
+				.SetDiagMsg(pxsFmt(L"Parent savestate '%s' of delta savestate was not found.", WX_STR(parent)))
+				.SetUserMsg(_("This savestate cannot be loaded because the state it was saved against no longer exists."));
+
+		FlatVmState full;
+		VmStateBuffer unused(L"Delta Savestate Parent");
+		if (ReadStateArchive(parent, full, unused) != 0)
+			throw Exception::SaveStateLoadError(filename)
+				.SetDiagMsg(pxsFmt(L"Parent savestate '%s' is itself a delta savestate.", WX_STR(parent)));
+
+		full.crc = SaveStateDelta::Checksum(full.buffer->GetPtr(), full.size);
+		s_delta_parent = std::move(full);
+	}
+
+	const uint pos = loader.GetCurrentPos();
+
+	state.filename = filename;
+	state.buffer = std::make_unique<VmStateBuffer>(L"StateBuffer_UnzipFromDisk");
+	state.size = SaveStateDelta::Apply(s_delta_parent.buffer->GetPtr(), s_delta_parent.size, s_delta_parent.crc,
+									   delta.GetPtr(pos), deltaSize - pos, *state.buffer);
+
+	uint total = 0;
+	for (uint i = 0; i < FlatStateEntries; ++i)
+		total += state.sizes[i];
+
+	if (total != state.size)
+		throw Exception::SaveStateLoadError(filename).SetDiagMsg(L"Delta savestate layout does not match its contents.");
+}
+
+// Bumped by every state load.  Rewind snapshots are downloaded by the core thread and filed
+// later, so one downloaded before a load is stale by the time it's filed.
+static std::atomic<u32> s_rewind_timeline(0);
+
+// Uploads a flat image into the virtual machine.  Unless resume is false, the core is
+// resumed afterwards.
+static void LoadFlatState(const FlatVmState& state, bool resume = true)
+{
+	// We use direct Suspend/Resume control here, since it's desirable that emulation
+	// *ALWAYS* start execution after the new savestate is loaded.
+
+	PatchesVerboseReset();
+
+	GetCoreThread().Pause();
+	SysClearExecutionCache();
+
+	uint offset = state.sizes[0];
+	for (uint i = 0; i < ArraySize(SavestateEntries); ++i)
+	{
+		const uint size = state.sizes[i + 1];
+
+		Threading::pxTestCancel();
+
+		pxInputStream reader(state.filename, new wxMemoryInputStream(state.buffer->GetPtr(offset), size));
+		SavestateEntries[i]->FreezeIn(reader);
+		offset += size;
+	}
+
+	// Load all the internal data
+
+	VmStateBuffer buffer(state.sizes[0], L"StateBuffer_UnzipFromDisk");
+	memcpy(buffer.GetPtr(), state.buffer->GetPtr(), state.sizes[0]);
+
+	memLoadingState(buffer).FreezeBios().FreezeInternals();
+	s_rewind_timeline++;
+	if (resume)
+		GetCoreThread().Resume(); // force resume regardless of emulation state earlier.
+}
+
+// Freezes the whole virtual machine into dest_list, in the flat layout.  The core thread
+// must be paused, unless this is called from the core thread itself at vsync.
+static void DownloadFlatState(ArchiveEntryList& dest_list)
+{
+	memSavingState saveme(dest_list.GetBuffer());
+	ArchiveEntry internals(EntryFilename_InternalStructures);
+	internals.SetDataIndex(saveme.GetCurrentPos());
+
+	saveme.FreezeBios();
+	saveme.FreezeInternals();
+
+	internals.SetDataSize(saveme.GetCurrentPos() - internals.GetDataIndex());
+	dest_list.Add(internals);
+
+	for (uint i = 0; i < ArraySize(SavestateEntries); ++i)
+	{
+		uint startpos = saveme.GetCurrentPos();
+		SavestateEntries[i]->FreezeOut(saveme);
+		dest_list.Add(ArchiveEntry(SavestateEntries[i]->GetFilename())
+						  .SetDataIndex(startpos)
+						  .SetDataSize(saveme.GetCurrentPos() - startpos));
+	}
+}
+
 // --------------------------------------------------------------------------------------
 //  SysExecEvent_DownloadState
 // --------------------------------------------------------------------------------------
@@ -407,24 +757,7 @@ protected:
 				.SetDiagMsg(L"SysExecEvent_DownloadState: Cannot freeze/download an invalid VM state!")
 				.SetUserMsg(_("There is no active virtual machine state to download or save."));
 
-		memSavingState saveme(m_dest_list->GetBuffer());
-		ArchiveEntry internals(EntryFilename_InternalStructures);
-		internals.SetDataIndex(saveme.GetCurrentPos());
-
-		saveme.FreezeBios();
-		saveme.FreezeInternals();
-
-		internals.SetDataSize(saveme.GetCurrentPos() - internals.GetDataIndex());
-		m_dest_list->Add(internals);
-
-		for (uint i = 0; i < ArraySize(SavestateEntries); ++i)
-		{
-			uint startpos = saveme.GetCurrentPos();
-			SavestateEntries[i]->FreezeOut(saveme);
-			m_dest_list->Add(ArchiveEntry(SavestateEntries[i]->GetFilename())
-								 .SetDataIndex(startpos)
-								 .SetDataSize(saveme.GetCurrentPos() - startpos));
-		}
+		DownloadFlatState(*m_dest_list);
 
 		UI_EnableStateActions();
 		paused_core.AllowResume();
@@ -501,11 +834,23 @@ protected:
 		// Provisionals for scoped cleanup, in case of exception:
 		std::unique_ptr<ArchiveEntryList> elist(m_src_list);
 
-		wxString tempfile(m_filename + L".tmp");
+		if (EmuConfig.DeltaSavestates)
+		{
+			std::unique_ptr<ArchiveEntryList> delta(MakeDeltaList(*elist, m_filename));
+			if (delta)
+				elist = std::move(delta);
+			else
+				SetDeltaParent(*elist, m_filename);
+		}
+
+		// The version goes after all the data so the flat layout in front of it is unchanged.
+		uint verpos = 0;
+		for (uint i = 0; i < elist->GetLength(); ++i)
+			verpos = std::max<uint>(verpos, (*elist)[i].GetDataIndex() + (*elist)[i].GetDataSize());
 
-		wxFFileOutputStream* woot = new wxFFileOutputStream(tempfile);
-		if (!woot->IsOk())
-			throw Exception::CannotCreateStream(tempfile);
+		elist->GetBuffer()->MakeRoomFor(verpos + sizeof(g_SaveVersion));
+		memcpy(elist->GetPtr(verpos), &g_SaveVersion, sizeof(g_SaveVersion));
+		elist->Add(ArchiveEntry(EntryFilename_StateVersion).SetDataIndex(verpos).SetDataSize(sizeof(g_SaveVersion)));
 
 		// Scheduler hint (yield) -- creating and saving the file is low priority compared to
 		// the emulator/vm thread.  Sleeping the executor thread briefly before doing file
@@ -513,38 +858,13 @@ protected:
 
 		pxYield(4);
 
-		// Write the version and screenshot:
-		std::unique_ptr<pxOutputStream> out(new pxOutputStream(tempfile, new wxZipOutputStream(woot)));
-		wxZipOutputStream* gzfp = (wxZipOutputStream*)out->GetWxStreamBase();
-
-		{
-			wxZipEntry* vent = new wxZipEntry(EntryFilename_StateVersion);
-			vent->SetMethod(wxZIP_METHOD_STORE);
-			gzfp->PutNextEntry(vent);
-			out->Write(g_SaveVersion);
-			gzfp->CloseEntry();
-		}
-
-		std::unique_ptr<wxImage> m_screenshot;
-
-		if (m_screenshot)
-		{
-			wxZipEntry* vent = new wxZipEntry(EntryFilename_Screenshot);
-			vent->SetMethod(wxZIP_METHOD_STORE);
-			gzfp->PutNextEntry(vent);
-			m_screenshot->SaveFile(*gzfp, wxBITMAP_TYPE_JPEG);
-			gzfp->CloseEntry();
-		}
-
 		(*new VmStateCompressThread())
 			.SetSource(elist.get())
-			.SetOutStream(out.get())
 			.SetFinishedPath(m_filename)
 			.Start();
 
 		// No errors?  Release cleanup handlers:
 		elist.release();
-		out.release();
 	}
 
 	void CleanupEvent()
@@ -581,129 +901,386 @@ protected:
 	{
 		ScopedLock lock(mtx_CompressToDisk);
 
-		// Ugh.  Exception handling made crappy because wxWidgets classes don't support scoped pointers yet.
+		FlatVmState state;
+		VmStateBuffer delta(L"StateBuffer_UnzipFromDisk_Delta");
 
-		std::unique_ptr<wxFFileInputStream> woot(new wxFFileInputStream(m_filename));
-		if (!woot->IsOk())
-			throw Exception::CannotCreateStream(m_filename).SetDiagMsg(L"Cannot open file for reading.");
+		const uint deltaSize = ReadStateArchive(m_filename, state, delta);
+		if (deltaSize)
+			ResolveDeltaState(m_filename, delta, deltaSize, state);
 
-		std::unique_ptr<pxInputStream> reader(new pxInputStream(m_filename, new wxZipInputStream(woot.get())));
-		woot.release();
+		LoadFlatState(state);
 
-		if (!reader->IsOk())
+		// A full state that was just loaded is the natural parent for the next deltas.
+		if (EmuConfig.DeltaSavestates && !deltaSize)
 		{
-			throw Exception::SaveStateLoadError(m_filename)
-				.SetDiagMsg(L"Savestate file is not a valid gzip archive.")
-				.SetUserMsg(_("This savestate cannot be loaded because it is not a valid gzip archive.  It may have been created by an older unsupported version of PCSX2, or it may be corrupted."));
+			state.crc = SaveStateDelta::Checksum(state.buffer->GetPtr(), state.size);
+			s_delta_parent = std::move(state);
 		}
+	}
+};
 
-		wxZipInputStream* gzreader = (wxZipInputStream*)reader->GetWxStreamBase();
+// --------------------------------------------------------------------------------------
+//  Rewind ring
+// --------------------------------------------------------------------------------------
+// While EmuConfig.Rewind.Enabled is set, the virtual machine is downloaded in the flat
+// layout every FrameInterval frames.  Only the newest snapshot is kept whole; each older
+// snapshot is kept as the zlib-compressed page delta which turns the snapshot after it
+// back into it, so the ring costs about one full image plus the pages dirtied between
+// snapshots.  Stepping back rebuilds the previous snapshot from the newest one and drops
+// the newest, and dropping the oldest snapshot is a plain pop from the front.
+//
+// The ring is only ever touched by events running on the SysExecutor thread.
+//
+struct RewindSnapshot
+{
+	u32 frame;
+	u32 sizes[FlatStateEntries];
+	uint deltaSize;
+	uint compressedSize;
+	std::unique_ptr<VmStateBuffer> compressed;
+};
 
-		// look for version and screenshot information in the zip stream:
+class RewindRing
+{
+protected:
+	FlatVmState m_newest;
+	u32 m_newest_frame;
+	std::deque<RewindSnapshot> m_history;
+	size_t m_history_bytes;
+
+	// Set when the newest snapshot was just restored, so the next rewind steps back
+	// instead of restoring it again.
+	bool m_restored;
+
+public:
+	RewindRing()
+	{
+		Clear();
+	}
+
+	bool IsEmpty() const { return !m_newest.buffer; }
+	uint GetCount() const { return IsEmpty() ? 0 : (uint)m_history.size() + 1; }
+	u32 GetNewestFrame() const { return m_newest_frame; }
 
-		bool foundVersion = false;
-		//bool foundScreenshot = false;
-		//bool foundEntry[ArraySize(SavestateEntries)] = false;
+	void Clear()
+	{
+		m_newest = FlatVmState();
+		m_newest_frame = 0;
+		m_history.clear();
+		m_history_bytes = 0;
+		m_restored = false;
+	}
 
-		std::unique_ptr<wxZipEntry> foundInternal;
-		std::unique_ptr<wxZipEntry> foundEntry[ArraySize(SavestateEntries)];
+	void Push(const ArchiveEntryList& list, u32 frame);
+	const FlatVmState& Restore(u32 frame);
+
+protected:
+	void StepBack();
+	void Trim();
+};
+
+static RewindRing s_rewind;
+
+// Set while a capture is queued on the SysExecutor, so a slow one can't pile up more.  Only
+// the EE thread sets it.
+static std::atomic<bool> s_rewind_capture_pending(false);
+
+// Frames since the last capture, and the size of its download buffer (EE thread only).
+static u32 s_rewind_frames = 0;
+static uint s_rewind_download_size = 0;
+
+void RewindRing::Push(const ArchiveEntryList& list, u32 frame)
+{
+	u32 sizes[FlatStateEntries];
+	uint size;
+	if (!GetFlatLayout(list, sizes, size))
+		return;
 
-		while (true)
+	// The frame counter going backwards means the VM was reset or a state was loaded;
+	// the ring belongs to the old timeline.
+	if (!IsEmpty() && frame < m_newest_frame)
+		Clear();
+
+	if (!IsEmpty())
+	{
+		VmStateBuffer delta(L"Rewind Delta");
+
+		RewindSnapshot older;
+		older.frame = m_newest_frame;
+		memcpy(older.sizes, m_newest.sizes, sizeof(older.sizes));
+		older.deltaSize = SaveStateDelta::Create(list.GetPtr(0), size, 0, m_newest.buffer->GetPtr(), m_newest.size, delta);
+
+		uLongf compressedSize = compressBound(older.deltaSize);
+		older.compressed = std::make_unique<VmStateBuffer>(compressedSize, L"Rewind Delta (compressed)");
+		if (compress2(older.compressed->GetPtr(), &compressedSize, delta.GetPtr(), older.deltaSize, Z_BEST_SPEED) == Z_OK)
 		{
-			Threading::pxTestCancel();
-
-			std::unique_ptr<wxZipEntry> entry(gzreader->GetNextEntry());
-			if (!entry)
-				break;
-
-			if (entry->GetName().CmpNoCase(EntryFilename_StateVersion) == 0)
-			{
-				DevCon.WriteLn(Color_Green, L" ... found '%s'", EntryFilename_StateVersion);
-				foundVersion = true;
-				CheckVersion(*reader);
-				continue;
-			}
-
-			if (entry->GetName().CmpNoCase(EntryFilename_InternalStructures) == 0)
-			{
-				DevCon.WriteLn(Color_Green, L" ... found '%s'", EntryFilename_InternalStructures);
-				foundInternal = std::move(entry);
-				continue;
-			}
-
-			// No point in finding screenshots when loading states -- the screenshots are
-			// only useful for the UI savestate browser.
-			/*if (entry->GetName().CmpNoCase(EntryFilename_Screenshot) == 0)
-			{
-				foundScreenshot = true;
-			}*/
-
-			for (uint i = 0; i < ArraySize(SavestateEntries); ++i)
-			{
-				if (entry->GetName().CmpNoCase(SavestateEntries[i]->GetFilename()) == 0)
-				{
-					DevCon.WriteLn(Color_Green, L" ... found '%s'", WX_STR(SavestateEntries[i]->GetFilename()));
-					foundEntry[i] = std::move(entry);
-					break;
-				}
-			}
+			older.compressed->ExactAlloc(compressedSize);
+			older.compressedSize = compressedSize;
+			m_history_bytes += compressedSize;
+			m_history.push_back(std::move(older));
 		}
-
-		if (!foundVersion || !foundInternal)
+		else
 		{
-			throw Exception::SaveStateLoadError(m_filename)
-				.SetDiagMsg(pxsFmt(L"Savestate file does not contain '%s'",
-								   !foundVersion ? EntryFilename_StateVersion : EntryFilename_InternalStructures))
-				.SetUserMsg(_("This file is not a valid PCSX2 savestate.  See the logfile for details."));
+			// The history can't be chained past a missing snapshot.
+			Console.Warning("Rewind: failed to compress snapshot of frame %u; history dropped.", older.frame);
+			m_history.clear();
+			m_history_bytes = 0;
 		}
+	}
+	else
+	{
+		m_newest.buffer = std::make_unique<VmStateBuffer>(size, L"Rewind Snapshot");
+	}
+
+	m_newest.filename = L"Rewind";
+	m_newest.buffer->MakeRoomFor(size);
+	memcpy(m_newest.buffer->GetPtr(), list.GetPtr(0), size);
+	memcpy(m_newest.sizes, sizes, sizeof(sizes));
+	m_newest.size = size;
+	m_newest_frame = frame;
+	m_restored = false;
+
+	Trim();
+}
+
+// Returns the snapshot to load when rewinding from the given frame: the newest one, unless
+// it was taken (or restored) at or after that frame.
+const FlatVmState& RewindRing::Restore(u32 frame)
+{
+	if ((m_restored || frame <= m_newest_frame) && !m_history.empty())
+		StepBack();
+
+	m_restored = true;
+	return m_newest;
+}
+
+void RewindRing::StepBack()
+{
+	const RewindSnapshot& older = m_history.back();
+
+	VmStateBuffer delta(older.deltaSize, L"Rewind Delta");
+	uLongf deltaSize = older.deltaSize;
+	if (uncompress(delta.GetPtr(), &deltaSize, older.compressed->GetPtr(), older.compressedSize) != Z_OK || deltaSize != older.deltaSize)
+		throw Exception::SaveStateLoadError().SetDiagMsg(pxsFmt(L"Rewind snapshot of frame %u is corrupted.", older.frame));
 
-		// Log any parts and pieces that are missing, and then generate an exception.
-		bool throwIt = false;
-		for (uint i = 0; i < ArraySize(SavestateEntries); ++i)
+	std::unique_ptr<VmStateBuffer> image(new VmStateBuffer(L"Rewind Snapshot"));
+	m_newest.size = SaveStateDelta::Apply(m_newest.buffer->GetPtr(), m_newest.size, 0, delta.GetPtr(), deltaSize, *image);
+	m_newest.buffer = std::move(image);
+	memcpy(m_newest.sizes, older.sizes, sizeof(m_newest.sizes));
+	m_newest_frame = older.frame;
+
+	m_history_bytes -= older.compressedSize;
+	m_history.pop_back();
+}
+
+void RewindRing::Trim()
+{
+	const size_t budget = (size_t)EmuConfig.Rewind.MaxMemoryMb * _1mb;
+	while (!m_history.empty() && (m_history.size() > EmuConfig.Rewind.MaxSnapshots || m_history_bytes > budget))
+	{
+		m_history_bytes -= m_history.front().compressedSize;
+		m_history.pop_front();
+	}
+}
+
+// --------------------------------------------------------------------------------------
+//  SysExecEvent_RewindCapture
+// --------------------------------------------------------------------------------------
+// Files a snapshot downloaded by the core thread into the rewind ring.  The delta and the
+// compression run here on the SysExecutor, so the core only pays for the download.
+//
+class SysExecEvent_RewindCapture : public SysExecEvent
+{
+protected:
+	ArchiveEntryList* m_list;
+	u32 m_frame;
+	u32 m_timeline;
+
+public:
+	wxString GetEventName() const { return L"VM_RewindCapture"; }
+
+	virtual ~SysExecEvent_RewindCapture() = default;
+	SysExecEvent_RewindCapture* Clone() const { return new SysExecEvent_RewindCapture(*this); }
+	SysExecEvent_RewindCapture(ArchiveEntryList* list = NULL, u32 frame = 0, u32 timeline = 0)
+	{
+		m_list = list;
+		m_frame = frame;
+		m_timeline = timeline;
+	}
+
+protected:
+	void InvokeEvent()
+	{
+		std::unique_ptr<ArchiveEntryList> list(m_list);
+		m_list = NULL;
+
+		if (!EmuConfig.Rewind.Enabled || !list)
 		{
-			if (foundEntry[i])
-				continue;
-
-			if (SavestateEntries[i]->IsRequired())
-			{
-				throwIt = true;
-				Console.WriteLn(Color_Red, " ... not found '%s'!", WX_STR(SavestateEntries[i]->GetFilename()));
-			}
+			s_rewind.Clear();
+			return;
 		}
 
-		if (throwIt)
-			throw Exception::SaveStateLoadError(m_filename)
-				.SetDiagMsg(L"Savestate cannot be loaded: some required components were not found or are incomplete.")
-				.SetUserMsg(_("This savestate cannot be loaded due to missing critical components.  See the log file for details."));
+		if (m_timeline == s_rewind_timeline)
+			s_rewind.Push(*list, m_frame);
+	}
+
+	void CleanupEvent()
+	{
+		delete m_list;
+		m_list = NULL;
+		s_rewind_capture_pending = false;
+		SysExecEvent::CleanupEvent();
+	}
+};
 
-		// We use direct Suspend/Resume control here, since it's desirable that emulation
-		// *ALWAYS* start execution after the new savestate is loaded.
+// --------------------------------------------------------------------------------------
+//  SysExecEvent_Rewind
+// --------------------------------------------------------------------------------------
+class SysExecEvent_Rewind : public SysExecEvent
+{
+protected:
+	bool m_stayPaused;
 
-		PatchesVerboseReset();
+public:
+	wxString GetEventName() const { return L"VM_Rewind"; }
 
+	virtual ~SysExecEvent_Rewind() = default;
+	SysExecEvent_Rewind* Clone() const { return new SysExecEvent_Rewind(*this); }
+	SysExecEvent_Rewind(bool stayPaused)
+		: m_stayPaused(stayPaused)
+	{
+	}
+
+protected:
+	void InvokeEvent()
+	{
+		if (s_rewind.IsEmpty() || !SysHasValidState())
+		{
+			OSDlog(Color_StrongGreen, true, "Rewind: no snapshots to rewind to.");
+			return;
+		}
+
+		// Read the frame counter only once the core has stopped advancing it.
 		GetCoreThread().Pause();
-		SysClearExecutionCache();
 
-		for (uint i = 0; i < ArraySize(SavestateEntries); ++i)
+		const FlatVmState& state = s_rewind.Restore(g_FrameCount);
+		LoadFlatState(state, !m_stayPaused);
+
+		OSDlog(Color_StrongGreen, true, "Rewound to frame %u (%u snapshots left).", s_rewind.GetNewestFrame(), s_rewind.GetCount());
+	}
+};
+
+// --------------------------------------------------------------------------------------
+//  SysExecEvent_SaveSnapshot / SysExecEvent_LoadSnapshot
+// --------------------------------------------------------------------------------------
+// Self-contained snapshots of the VM, for callers that store states themselves (input
+// recording keyframes).  A snapshot is the flat image compressed with zlib:
+//   [u32 entry count][u32 entry sizes...][u32 image size][zlib data]
+//
+static std::atomic<bool> s_snapshot_pending(false);
+
+class SysExecEvent_SaveSnapshot : public SysExecEvent
+{
+protected:
+	StateSnapshotHandler m_handler;
+
+public:
+	wxString GetEventName() const { return L"VM_SaveSnapshot"; }
+
+	virtual ~SysExecEvent_SaveSnapshot() = default;
+	SysExecEvent_SaveSnapshot* Clone() const { return new SysExecEvent_SaveSnapshot(*this); }
+	SysExecEvent_SaveSnapshot(const StateSnapshotHandler& handler)
+		: m_handler(handler)
+	{
+	}
+
+protected:
+	void InvokeEvent()
+	{
+		ArchiveEntryList list(new VmStateBuffer(L"Snapshot Download"));
+		u32 frame;
 		{
-			if (!foundEntry[i])
-				continue;
+			ScopedCoreThreadPause paused_core;
 
-			Threading::pxTestCancel();
+			if (!SysHasValidState())
+				return;
 
-			gzreader->OpenEntry(*foundEntry[i]);
-			SavestateEntries[i]->FreezeIn(*reader);
+			frame = g_FrameCount;
+			DownloadFlatState(list);
+			paused_core.AllowResume();
 		}
 
-		// Load all the internal data
+		u32 sizes[FlatStateEntries];
+		uint size;
+		if (!GetFlatLayout(list, sizes, size))
+			return;
 
-		gzreader->OpenEntry(*foundInternal);
+		const uint headerSize = sizeof(u32) * (FlatStateEntries + 2);
+		uLongf compressedSize = compressBound(size);
+		std::vector<u8> snapshot(headerSize + compressedSize);
 
-		VmStateBuffer buffer(foundInternal->GetSize(), L"StateBuffer_UnzipFromDisk"); // start with an 8 meg buffer to avoid frequent reallocation.
-		reader->Read(buffer.GetPtr(), foundInternal->GetSize());
+		u32* header = (u32*)snapshot.data();
+		header[0] = FlatStateEntries;
+		memcpy(&header[1], sizes, sizeof(sizes));
+		header[FlatStateEntries + 1] = size;
 
-		memLoadingState(buffer).FreezeBios().FreezeInternals();
-		GetCoreThread().Resume(); // force resume regardless of emulation state earlier.
+		if (compress2(&snapshot[headerSize], &compressedSize, list.GetPtr(0), size, Z_BEST_SPEED) != Z_OK)
+		{
+			Console.Warning("Failed to compress the snapshot of frame %u.", frame);
+			return;
+		}
+		snapshot.resize(headerSize + compressedSize);
+
+		m_handler(frame, snapshot);
+	}
+
+	void CleanupEvent()
+	{
+		s_snapshot_pending = false;
+		SysExecEvent::CleanupEvent();
+	}
+};
+
+class SysExecEvent_LoadSnapshot : public SysExecEvent
+{
+protected:
+	std::vector<u8> m_snapshot;
+
+public:
+	wxString GetEventName() const { return L"VM_LoadSnapshot"; }
+
+	virtual ~SysExecEvent_LoadSnapshot() = default;
+	SysExecEvent_LoadSnapshot* Clone() const { return new SysExecEvent_LoadSnapshot(*this); }
+	SysExecEvent_LoadSnapshot(std::vector<u8> snapshot)
+		: m_snapshot(std::move(snapshot))
+	{
+	}
+
+protected:
+	void InvokeEvent()
+	{
+		const uint headerSize = sizeof(u32) * (FlatStateEntries + 2);
+		const u32* header = (const u32*)m_snapshot.data();
+		if (m_snapshot.size() < headerSize || header[0] != FlatStateEntries)
+			throw Exception::SaveStateLoadError().SetDiagMsg(L"Snapshot was made by an incompatible version of PCSX2.");
+
+		FlatVmState state;
+		state.filename = L"Snapshot";
+		memcpy(state.sizes, &header[1], sizeof(state.sizes));
+		state.size = header[FlatStateEntries + 1];
+		state.buffer = std::make_unique<VmStateBuffer>(state.size, L"Snapshot");
+
+		uLongf size = state.size;
+		if (uncompress(state.buffer->GetPtr(), &size, &m_snapshot[headerSize], m_snapshot.size() - headerSize) != Z_OK || size != state.size)
+			throw Exception::SaveStateLoadError().SetDiagMsg(L"Snapshot is corrupted.");
+
+		uint total = 0;
+		for (uint i = 0; i < FlatStateEntries; ++i)
+			total += state.sizes[i];
+		if (total != state.size)
+			throw Exception::SaveStateLoadError().SetDiagMsg(L"Snapshot layout does not match its contents.");
+
+		LoadFlatState(state);
 	}
 };
 
@@ -774,3 +1351,64 @@ void StateCopy_LoadFromSlot(uint slot, bool isFromBackup)
 #endif
 }
 
+// Called by the EE at the end of every frame; takes a rewind snapshot every
+// Rewind.FrameInterval frames while rewind is enabled.  The download is done right here on
+// the core thread, which is at a point where it could be paused anyway, so capturing costs
+// no pause/resume round trip through the SysExecutor.
+void StateCopy_RewindFrame()
+{
+	if (!EmuConfig.Rewind.Enabled)
+	{
+		// Rewind was just turned off: one more capture event frees the ring.
+		if (!s_rewind_frames)
+			return;
+	}
+	else if (++s_rewind_frames < EmuConfig.Rewind.FrameInterval)
+		return;
+
+	if (s_rewind_capture_pending)
+		return;
+
+	s_rewind_frames = 0;
+
+	std::unique_ptr<ArchiveEntryList> list;
+	if (EmuConfig.Rewind.Enabled)
+	{
+		// Presize for the last snapshot, so the download doesn't reallocate as it grows.
+		list.reset(new ArchiveEntryList(new VmStateBuffer(L"Rewind Download")));
+		if (s_rewind_download_size)
+			list->GetBuffer()->MakeRoomFor(s_rewind_download_size);
+
+		DownloadFlatState(*list);
+		s_rewind_download_size = list->GetBuffer()->GetSizeInBytes();
+	}
+	else
+		s_rewind_download_size = 0;
+
+	s_rewind_capture_pending = true;
+	GetSysExecutorThread().PostEvent(new SysExecEvent_RewindCapture(list.release(), g_FrameCount, s_rewind_timeline));
+}
+
+// Restores the newest rewind snapshot, or the one before it if no time has passed since
+// the newest was taken or restored.  With stayPaused the core is left paused on the
+// restored frame.
+void StateCopy_Rewind(bool stayPaused)
+{
+	GetSysExecutorThread().PostEvent(new SysExecEvent_Rewind(stayPaused));
+}
+
+// Takes a compressed snapshot of the VM and hands it to the handler, unless a snapshot is
+// already being taken.  Returns false in that case.
+bool StateCopy_SaveSnapshot(const StateSnapshotHandler& handler)
+{
+	if (s_snapshot_pending.exchange(true))
+		return false;
+
+	GetSysExecutorThread().PostEvent(new SysExecEvent_SaveSnapshot(handler));
+	return true;
+}
+
+void StateCopy_LoadSnapshot(std::vector<u8> snapshot)
+{
+	GetSysExecutorThread().PostEvent(new SysExecEvent_LoadSnapshot(std::move(snapshot)));
+}
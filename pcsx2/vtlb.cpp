@@ -315,6 +315,62 @@ template void vtlb_memWrite<mem8_t>(u32 mem, mem8_t data);
 template void vtlb_memWrite<mem16_t>(u32 mem, mem16_t data);
 template void vtlb_memWrite<mem32_t>(u32 mem, mem32_t data);
 
+// Returns whether every page of a span of EE virtual memory is mapped straight to host
+// memory, so it can be accessed without running I/O handlers or raising TLB misses.
+bool vtlb_memIsDirect(u32 mem, u32 size)
+{
+	if (!vtlbdata.vmap || (u64)mem + size > (u64)_4gb)
+		return false;
+
+	for (u64 page = mem & ~VTLB_PAGE_MASK; page < (u64)mem + size; page += VTLB_PAGE_SIZE)
+	{
+		if (vtlbdata.vmap[page >> VTLB_PAGE_BITS].isHandler((u32)page))
+			return false;
+	}
+	return true;
+}
+
+// Copies a span of EE virtual memory for external tools.  Only pages mapped straight to
+// host memory are accessed (bypassing the data cache emulation), so nothing observable by
+// the emulated machine happens; fails without copying anything otherwise.
+bool vtlb_memReadBlock(u32 mem, void* dest, u32 size)
+{
+	if (!vtlb_memIsDirect(mem, size))
+		return false;
+
+	u8* out = (u8*)dest;
+	while (size)
+	{
+		const u32 len = std::min(size, VTLB_PAGE_SIZE - (mem & VTLB_PAGE_MASK));
+		memcpy(out, (void*)vtlbdata.vmap[mem>>VTLB_PAGE_BITS].assumePtr(mem), len);
+
+		mem += len;
+		out += len;
+		size -= len;
+	}
+	return true;
+}
+
+bool vtlb_memWriteBlock(u32 mem, const void* src, u32 size)
+{
+	if (!vtlb_memIsDirect(mem, size))
+		return false;
+
+	const u8* in = (const u8*)src;
+	while (size)
+	{
+		const u32 len = std::min(size, VTLB_PAGE_SIZE - (mem & VTLB_PAGE_MASK));
+		// Direct writes to recompiled code pages are caught by the same page protection
+		// as the recompilers' own stores.
+		memcpy((void*)vtlbdata.vmap[mem>>VTLB_PAGE_BITS].assumePtr(mem), in, len);
+
+		mem += len;
+		in += len;
+		size -= len;
+	}
+	return true;
+}
+
 // --------------------------------------------------------------------------------------
 //  TLB Miss / BusError Handlers
 // --------------------------------------------------------------------------------------
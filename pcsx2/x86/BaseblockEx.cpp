@@ -80,3 +80,30 @@ void BaseBlocks::Link(u32 pc, s32* jumpptr)
 	links.insert(std::pair<u32, uptr>(pc, (uptr)jumpptr));
 }
 
+// Forgets every block whose code lies in [begin, end) so that the range can be reused.
+// Jumps from other blocks into the range go back to the recompiler, and the jumps that
+// live in the range are no longer patched when their target gets recompiled.
+void BaseBlocks::Evict(uptr begin, uptr end)
+{
+	for (linkiter_t i = links.begin(); i != links.end();)
+	{
+		if (i->second >= begin && i->second < end)
+			i = links.erase(i);
+		else
+			++i;
+	}
+
+	for (u32 idx = 0; idx < blocks.size(); idx++)
+	{
+		if (blocks[idx].fnptr < begin || blocks[idx].fnptr >= end)
+			continue;
+
+		std::pair<linkiter_t, linkiter_t> range = links.equal_range(blocks[idx].startpc);
+		for (linkiter_t i = range.first; i != range.second; ++i)
+			*(u32*)i->second = recompiler - (i->second + 4);
+	}
+
+	blocks.erase_if([begin, end](const BASEBLOCKEX& block) {
+		return block.fnptr >= begin && block.fnptr < end;
+	});
+}
@@ -138,6 +138,20 @@ public:
 
 		_Size -= range;
 	}
+
+	// Removes the blocks matching pred, keeping the others in startpc order
+	template <typename Pred>
+	void erase_if(Pred pred)
+	{
+		s32 kept = 0;
+
+		for (s32 i = 0; i < _Size; i++) {
+			if (!pred(blocks[i]))
+				blocks[kept++] = blocks[i];
+		}
+
+		_Size = kept;
+	}
 };
 
 class BaseBlocks
@@ -220,6 +234,7 @@ public:
 	}
 
 	void Link(u32 pc, s32* jumpptr);
+	void Evict(uptr begin, uptr end);
 
 	__fi void Reset()
 	{
@@ -88,6 +88,7 @@ static BASEBLOCK *recROM2 = NULL;       // also here
 static BaseBlocks recBlocks;
 static u8* recPtr = NULL;
 static u32 *recConstBufPtr = NULL;
+static u32 *recConstBufEnd = NULL;
 EEINST* s_pInstCache = NULL;
 static u32 s_nInstCacheSize = 0;
 
@@ -254,17 +255,18 @@ int _flushUnusedConstReg()
 // Some of the generated MMX code needs 64-bit immediates but x86 doesn't
 // provide this.  One of the reasons we are probably better off not doing
 // MMX register allocation for the EE.
+static u32 *imm64_cache[509];
+
 u32* recGetImm64(u32 hi, u32 lo)
 {
 	u32 *imm64; // returned pointer
-	static u32 *imm64_cache[509];
 	int cacheidx = lo % (sizeof imm64_cache / sizeof *imm64_cache);
 
 	imm64 = imm64_cache[cacheidx];
 	if (imm64 && imm64[0] == lo && imm64[1] == hi)
 		return imm64;
 
-	if (recConstBufPtr >= recConstBuf + RECCONSTBUF_SIZE)
+	if (recConstBufPtr >= recConstBufEnd)
 	{
 		Console.WriteLn( "EErec const buffer filled; Resetting..." );
 		throw Exception::ExitCpuExecute();
@@ -334,10 +336,14 @@ static DynGenFunc* ExitRecompiledCode	= NULL;
 static DynGenFunc* DispatchBlockDiscard = NULL;
 static DynGenFunc* DispatchPageReset    = NULL;
 
+static void recSegmentSample(u32 pc);
+
 static void recEventTest()
 {
 	_cpuEventTest_Shared();
 
+	recSegmentSample(cpuRegs.pc);
+
 	if (iopBreakpoint) {
 		iopBreakpoint = false;
 		recExitExecution();
@@ -591,6 +597,115 @@ static bool eeCpuExecuting = false;
 static bool g_resetEeScalingStats = false;
 static int g_patchesNeedRedo = 0;
 
+// The code cache is split in segments which are filled one after the other.  When the
+// current segment is full, the coldest of the others is evicted and filled next instead
+// of throwing away every block.  The recompiled code can't be moved, so hot blocks of an
+// evicted segment are simply recompiled on their next run; picking the coldest segment
+// keeps that to a minimum.  Each segment also owns a slice of the 64 bit constants, as
+// its code is the only one referencing them.
+static const uint RECSEGMENT_COUNT = 8;
+static const uint RECSEGMENT_CONSTS = RECCONSTBUF_SIZE / RECSEGMENT_COUNT;
+
+static uint recSegmentCur = 0;
+static uint recSegmentPrev = 0;
+static u32 recSegmentHits[RECSEGMENT_COUNT];
+
+static __fi uptr recSegmentSize()
+{
+	return (recMem->GetPtrEnd() - (u8*)*recMem) / RECSEGMENT_COUNT;
+}
+
+static __fi u8* recSegmentBegin(uint seg)
+{
+	return (u8*)*recMem + seg * recSegmentSize();
+}
+
+static __fi u8* recSegmentEnd(uint seg)
+{
+	return recSegmentBegin(seg) + recSegmentSize();
+}
+
+// Hotness is sampled at event tests: the block about to run gets a hit for its segment.
+// That's cheap and frequent enough to tell the main loop of a game from the code it only
+// ran while loading a level.  The counts are halved at every eviction, and also whenever one
+// of them gets large, so a segment that stays resident for long can't wrap its count.
+static void recSegmentSample(u32 pc)
+{
+	if (PC_GETBLOCK(pc & ~0xffffu) == NULL) // unmapped page
+		return;
+
+	uptr fnptr = PC_GETBLOCK(pc)->GetFnptr();
+
+	if (fnptr < (uptr)(u8*)*recMem || fnptr >= (uptr)recMem->GetPtrEnd())
+		return;
+
+	if (++recSegmentHits[(fnptr - (uptr)(u8*)*recMem) / recSegmentSize()] >= 0x80000000u)
+	{
+		for (uint i = 0; i < RECSEGMENT_COUNT; i++)
+			recSegmentHits[i] >>= 1;
+	}
+}
+
+static void recSegmentEvict(uint seg)
+{
+	const uptr begin = (uptr)recSegmentBegin(seg);
+	const uptr end = (uptr)recSegmentEnd(seg);
+
+	BASEBLOCKEX* pexblock;
+
+	for (int i = 0; pexblock = recBlocks[i]; i++)
+	{
+		if (pexblock->fnptr < begin || pexblock->fnptr >= end)
+			continue;
+
+		// Overlapping blocks share the lookup entries, only drop the evicted ones.
+		BASEBLOCK* pblock = PC_GETBLOCK(pexblock->startpc);
+
+		for (u32 j = 0; j < pexblock->size; j++)
+		{
+			if (pblock[j].GetFnptr() >= begin && pblock[j].GetFnptr() < end)
+				pblock[j].SetFnptr((uptr)JITCompile);
+		}
+	}
+
+	recBlocks.Evict(begin, end);
+}
+
+static void recSegmentNext()
+{
+	// The segment that was just filled is likely still warming up, don't judge it yet.
+	uint victim = RECSEGMENT_COUNT;
+
+	for (uint i = 1; i < RECSEGMENT_COUNT; i++)
+	{
+		uint seg = (recSegmentCur + i) % RECSEGMENT_COUNT;
+
+		if (seg == recSegmentPrev)
+			continue;
+
+		if (victim == RECSEGMENT_COUNT || recSegmentHits[seg] < recSegmentHits[victim])
+			victim = seg;
+	}
+
+	DevCon.WriteLn("EE/iR5900-32 Recompiler evicting segment %u (%u hits)", victim, recSegmentHits[victim]);
+
+	recSegmentEvict(victim);
+
+	for (uint i = 0; i < RECSEGMENT_COUNT; i++)
+		recSegmentHits[i] >>= 1;
+
+	recSegmentPrev = recSegmentCur;
+	recSegmentCur = victim;
+	recSegmentHits[victim] = 0;
+
+	recPtr = recSegmentBegin(victim);
+	recConstBufPtr = recConstBuf + victim * RECSEGMENT_CONSTS;
+	recConstBufEnd = recConstBufPtr + RECSEGMENT_CONSTS;
+
+	// Cached constants may live in another segment, which could be evicted before this one.
+	memzero(imm64_cache);
+}
+
 ////////////////////////////////////////////////////
 static void recResetRaw()
 {
@@ -623,6 +738,11 @@ static void recResetRaw()
 
 	recPtr = *recMem;
 	recConstBufPtr = recConstBuf;
+	recConstBufEnd = recConstBuf + RECSEGMENT_CONSTS;
+	memzero(imm64_cache);
+
+	recSegmentCur = recSegmentPrev = 0;
+	memzero(recSegmentHits);
 
 	g_branch = 0;
 	g_resetEeScalingStats = true;
@@ -1664,17 +1784,12 @@ static void __fastcall recRecompile( const u32 startpc )
 
 	pxAssert( startpc );
 
-	// if recPtr reached the mem limit reset whole mem
-	if (recPtr >= (recMem->GetPtrEnd() - _64kb)) {
-		eeRecNeedsReset = true;
-	}
-	else if ((recConstBufPtr - recConstBuf) >= RECCONSTBUF_SIZE - 64) {
-		Console.WriteLn("EE recompiler stack reset");
-		eeRecNeedsReset = true;
-	}
-
 	if (eeRecNeedsReset) recResetRaw();
 
+	// if recPtr reached the end of its segment, make room in the coldest one
+	if (recPtr >= (recSegmentEnd(recSegmentCur) - _64kb) || (recConstBufEnd - recConstBufPtr) <= 64)
+		recSegmentNext();
+
 	xSetPtr( recPtr );
 	recPtr = xGetAlignedCallTarget();
 
@@ -2134,8 +2249,8 @@ StartRecomp:
 		}
 	}
 
-	pxAssert( xGetPtr() < recMem->GetPtrEnd() );
-	pxAssert( recConstBufPtr < recConstBuf + RECCONSTBUF_SIZE );
+	pxAssert( xGetPtr() < recSegmentEnd(recSegmentCur) );
+	pxAssert( recConstBufPtr < recConstBufEnd );
 
 	pxAssert(xGetPtr() - recPtr < _64kb);
 	s_pCurBlockEx->x86size = xGetPtr() - recPtr;
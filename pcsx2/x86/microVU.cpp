@@ -104,6 +104,12 @@ void mVUreset(microVU& mVU, bool resetReserve) {
 	mVU.prog.cur		= NULL;
 	mVU.prog.total		=  0;
 	mVU.prog.curFrame	=  0;
+	mVU.prog.hashDirty	= ~0ull; // Micro memory may have been loaded without a clear (savestates)
+
+	mVUprintLookupStats(mVU);
+	memzero(mVU.prog.stats);
+	if (!mVU.prog.lookup) mVU.prog.lookup = new std::unordered_map<u64, microProgram*>();
+	else                  mVU.prog.lookup->clear();
 
 	// Setup Dynarec Cache Limits for Each Program
 	u8* z = mVU.cache;
@@ -146,10 +152,20 @@ void mVUclose(microVU& mVU) {
 		}
 		safe_delete(mVU.prog.prog[i]);
 	}
+	safe_delete(mVU.prog.lookup);
+
+	mVUcacheSave(mVU);
 }
 
 // Clears Block Data in specified range
 __fi void mVUclear(mV, u32 addr, u32 size) {
+	if (size) { // Data is written after the clear, so the chunks get rehashed by the next lookup
+		u32 chunkSize = mVU.microMemSize / mHashChunks;
+		u32 first = (addr & (mVU.microMemSize - 1)) / chunkSize;
+		u32 last  = std::min((addr & (mVU.microMemSize - 1)) + size - 1, mVU.microMemSize - 1) / chunkSize;
+		for (u32 i = first; i <= last; i++)
+			mVU.prog.hashDirty |= 1ull << i;
+	}
 	if(!mVU.prog.cleared) {
 		mVU.prog.cleared = 1;		// Next execution searches/creates a new microprogram
 		memzero(mVU.prog.lpState); // Clear pipeline state
@@ -171,10 +187,12 @@ __ri void mVUvsyncUpdate(mV) {
 
 // Deletes a program
 __ri void mVUdeleteProg(microVU& mVU, microProgram*& prog) {
+	mVUcacheStash(mVU, *prog);
 	for (u32 i = 0; i < (mVU.progSize / 2); i++) {
 		safe_delete(prog->block[i]);
 	}
 	safe_delete(prog->ranges);
+	safe_delete(prog->entries);
 	safe_aligned_free(prog);
 }
 
@@ -184,6 +202,7 @@ __ri microProgram* mVUcreateProg(microVU& mVU, int startPC) {
 	memset(prog, 0, sizeof(microProgram));
 	prog->idx     = mVU.prog.total++;
 	prog->ranges  = new std::deque<microRange>();
+	prog->entries = new std::deque<microCacheEntry>();
 	prog->startPC = startPC;
 	mVUcacheProg(mVU, *prog); // Cache Micro Program
 	double cacheSize = (double)((uptr)mVU.prog.x86end - (uptr)mVU.prog.x86start);
@@ -261,6 +280,35 @@ __fi bool mVUcmpProg(microVU& mVU, microProgram& prog, const bool cmpWholeProg)
 	return true;
 }
 
+// Rehashes the chunks of micro memory written since the last lookup, and returns the key
+// of the program table for the current micro memory and startPC
+static u64 mVUprogKey(microVU& mVU, u32 startPC) {
+	const u32 chunkSize = mVU.microMemSize / mHashChunks;
+	for (u32 i = 0; mVU.prog.hashDirty; i++) {
+		if (!(mVU.prog.hashDirty & (1ull << i))) continue;
+		const u64* data = (u64*)(mVU.regs().Micro + i * chunkSize);
+		u64 hash = 0xcbf29ce484222325ull + i;
+		for (u32 j = 0; j < chunkSize / 8; j++) {
+			hash = (hash ^ data[j]) * 0x100000001b3ull;
+			hash ^= hash >> 29;
+		}
+		mVU.prog.hash ^= mVU.prog.hashChunk[i] ^ hash;
+		mVU.prog.hashChunk[i] = hash;
+		mVU.prog.hashDirty &= ~(1ull << i);
+	}
+	return mVU.prog.hash ^ ((u64)startPC * 0x9e3779b97f4a7c15ull);
+}
+
+// Prints how programs were found since the last reset
+void mVUprintLookupStats(microVU& mVU) {
+	const microProgStats& s = mVU.prog.stats;
+	if (!s.lookups) return;
+	DevCon.WriteLn(mVU.index ? Color_Orange : Color_Magenta,
+		"microVU%d: Program lookups = %llu [hash=%llu] [list=%llu] [new=%llu] (compares=%llu, %.1f per list walk) [max list=%u]",
+		mVU.index, s.lookups, s.hashHits, s.listHits, s.created, s.compares,
+		(double)s.compares / std::max<u64>(s.lookups - s.hashHits, 1), s.maxList);
+}
+
 // Searches for Cached Micro Program and sets prog.cur to it (returns entry-point to program)
 _mVUt __fi void* mVUsearchProg(u32 startPC, uptr pState) {
 	microVU& mVU = mVUx;
@@ -268,8 +316,29 @@ _mVUt __fi void* mVUsearchProg(u32 startPC, uptr pState) {
 	microProgramList*  list  = mVU.prog.prog [mVU.regs().start_pc/8];
 
 	if(!quick.prog) { // If null, we need to search for new program
+		// The Ibit gamefixes accept programs the list walk would reject, so their programs
+		// must only be found by the list walk below
+		const bool useLookup = !EmuConfig.Gamefixes.ScarfaceIbit && !EmuConfig.Gamefixes.CrashTagTeamRacingIbit;
+		u64 key = useLookup ? mVUprogKey(mVU, mVU.regs().start_pc/8) : 0;
+		mVU.prog.stats.lookups++;
+
+		// Micro memory was already seen with this startPC, only verify the compiled ranges
+		auto found = useLookup ? mVU.prog.lookup->find(key) : mVU.prog.lookup->end();
+		if (found != mVU.prog.lookup->end()) {
+			if (mVUcmpProg(mVU, *found->second, 0)) {
+				mVU.prog.stats.hashHits++;
+				quick.prog		 = found->second;
+				void* entryPoint = mVUentryFetch(mVU, startPC, pState);
+				quick.block		 = quick.prog->block[startPC/8];
+				return entryPoint;
+			}
+			mVU.prog.lookup->erase(found); // Program got recompiled from other data since
+		}
+
+		mVU.prog.stats.maxList = std::max<u32>(mVU.prog.stats.maxList, list->size());
 		std::deque<microProgram*>::iterator it(list->begin());
 		for ( ; it != list->end(); ++it) {
+			mVU.prog.stats.compares++;
 			bool b = mVUcmpProg(mVU, *it[0], 0);
 			if (EmuConfig.Gamefixes.ScarfaceIbit) {
 				if (isVU1 && ((((u32*)mVU.regs().Micro)[startPC / 4 + 1]) == 0x80200118) &&
@@ -295,7 +364,9 @@ _mVUt __fi void* mVUsearchProg(u32 startPC, uptr pState) {
 				quick.prog  = it[0];
 				list->erase(it);
 				list->push_front(quick.prog);
-				return mVUentryGet(mVU, quick.block, startPC, pState);
+				if (useLookup) (*mVU.prog.lookup)[key] = quick.prog;
+				mVU.prog.stats.listHits++;
+				return mVUentryFetch(mVU, startPC, pState);
 			}
 		}
 
@@ -303,10 +374,12 @@ _mVUt __fi void* mVUsearchProg(u32 startPC, uptr pState) {
 		mVU.prog.cleared	= 0;
 		mVU.prog.isSame		= 1;
 		mVU.prog.cur		= mVUcreateProg(mVU, mVU.regs().start_pc/8);
-		void* entryPoint	= mVUblockFetch(mVU,  startPC, pState);
+		void* entryPoint	= mVUentryFetch(mVU,  startPC, pState);
 		quick.block			= mVU.prog.cur->block[startPC/8];
 		quick.prog			= mVU.prog.cur;
 		list->push_front(mVU.prog.cur);
+		if (useLookup) (*mVU.prog.lookup)[key] = mVU.prog.cur;
+		mVU.prog.stats.created++;
 		//mVUprintUniqueRatio(mVU);
 		return entryPoint;
 	}
@@ -321,10 +394,10 @@ _mVUt __fi void* mVUsearchProg(u32 startPC, uptr pState) {
 	// Sanity check, in case for some reason the program compilation aborted half way through
 	if (quick.block == nullptr)
 	{
-		void* entryPoint = mVUblockFetch(mVU, startPC, pState);
+		void* entryPoint = mVUentryFetch(mVU, startPC, pState);
 		return entryPoint;
 	}
-	return mVUentryGet(mVU, quick.block, startPC, pState);
+	return mVUentryFetch(mVU, startPC, pState);
 }
 
 //------------------------------------------------------------------
@@ -23,6 +23,9 @@ using namespace x86Emitter;
 #include <deque>
 #include <algorithm>
 #include <memory>
+#include <map>
+#include <mutex>
+#include <unordered_map>
 #include "Common.h"
 #include "VU.h"
 #include "MTVU.h"
@@ -140,11 +143,19 @@ struct microRange {
 	s32 end;   // End PC   (The opcode the block ends with)
 };
 
+// Entry point a microProgram was entered with at runtime (see microVU_Cache.inl)
+struct microCacheEntry {
+	u32          startPC;
+	u32          pad[3];
+	microRegInfo pState;
+};
+
 #define mProgSize (0x4000/4)
 struct microProgram {
 	u32				   data [mProgSize];   // Holds a copy of the VU microProgram
 	microBlockManager* block[mProgSize/2]; // Array of Block Managers
 	std::deque<microRange>* ranges;			   // The ranges of the microProgram that have already been recompiled
+	std::deque<microCacheEntry>* entries;	   // The entry points the microProgram was executed from
 	u32 startPC; // Start PC of this program
 	int idx;	 // Program index
 };
@@ -156,6 +167,16 @@ struct microProgramQuick {
 	microProgram*		  prog;	 // The microProgram who is the owner of 'block'
 };
 
+struct microProgStats {
+	u64 lookups;  // Program searches (quick reference was cleared)
+	u64 hashHits; // Programs found by the micro memory hash
+	u64 listHits; // Programs found by walking the program list
+	u64 compares; // mVUcmpProg() calls made while walking program lists
+	u64 created;  // New programs
+	u32 maxList;  // Longest program list walked
+};
+
+#define mHashChunks 64
 struct microProgManager {
 	microIR<mProgSize>	IRinfo;				// IR information
 	microProgramList*	prog [mProgSize/2];	// List of microPrograms indexed by startPC values
@@ -169,6 +190,11 @@ struct microProgManager {
 	u8*					x86start;			// Start of program's rec-cache
 	u8*					x86end;				// Limit of program's rec-cache
 	microRegInfo		lpState;			// Pipeline state from where program left off (useful for continuing execution)
+	u64					hashChunk[mHashChunks]; // Hash of each chunk of micro memory
+	u64					hashDirty;			// Chunks written since they were last hashed (1 bit per chunk, see mVUclear)
+	u64					hash;				// Hash of the whole micro memory (xor of hashChunk)
+	std::unordered_map<u64, microProgram*>* lookup; // Programs indexed by micro memory hash and startPC
+	microProgStats		stats;				// Program lookup statistics
 };
 
 static const uint mVUdispCacheSize	= __pagesize; // Dispatcher Cache Size (in bytes)
@@ -248,6 +274,10 @@ mVUop(mVUopL);
 // Private Functions
 extern void  mVUcacheProg (microVU& mVU, microProgram&  prog);
 extern void  mVUdeleteProg(microVU& mVU, microProgram*& prog);
+extern microProgram* mVUcreateProg(microVU& mVU, int startPC);
+extern void  mVUcacheStash(microVU& mVU, microProgram& prog);
+extern void  mVUcacheSave (microVU& mVU);
+extern void  mVUprintLookupStats(microVU& mVU);
 _mVUt extern void* mVUsearchProg(u32 startPC, uptr pState);
 extern void* __fastcall mVUexecuteVU0(u32 startPC, u32 cycles);
 extern void* __fastcall mVUexecuteVU1(u32 startPC, u32 cycles);
@@ -278,5 +308,6 @@ void sortVector(T& v) {
 #include "microVU_Flags.inl"
 #include "microVU_Branch.inl"
 #include "microVU_Compile.inl"
+#include "microVU_Cache.inl"
 #include "microVU_Execute.inl"
 #include "microVU_Macro.inl"
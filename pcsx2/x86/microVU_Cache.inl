@@ -0,0 +1,279 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "Elfheader.h"
+
+//------------------------------------------------------------------
+// Micro VU - Program Disk Cache
+//------------------------------------------------------------------
+
+// Remembers the entry points (startPC + pipeline state) each microprogram of a game was
+// entered with, together with the micro memory it was compiled from.  On the next boot of
+// the same game the programs are recompiled as soon as the game starts, instead of the
+// first time each of them runs.  The x86 code itself isn't saved, since it references
+// host addresses which change between sessions.
+
+struct microCacheProg {
+	u32 startPC;                          // Program list index (start_pc / 8)
+	u32 uses = 0;                         // Times stashed this session (not saved)
+	std::vector<u32> data;                // Micro memory the program was compiled from
+	std::vector<microCacheEntry> entries; // Entry points reached at runtime
+};
+
+struct microCache {
+	std::mutex mutex;
+	u32 crc = 0;                          // Game the programs belong to
+	std::map<u64, microCacheProg> progs;  // Indexed by mVUcacheHash()
+};
+
+struct microCacheHeader {
+	char magic[4];
+	u32 version;
+	u32 index;
+	u32 entrySize;
+	u64 config;
+	u32 count;
+	u32 pad;
+};
+
+static const u32 mVUcacheVersion    = 1;
+static const u32 mVUcacheMaxProgs   = 256;       // Per VU, the least used program makes room for a new one
+static const u32 mVUcacheMaxEntries = 64;        // Entry points kept per program
+static const u32 mVUcacheMaxFile    = 16 * _1mb; // Only the most used programs which fit are saved
+static microCache mVUdiskCache[2];
+
+static u64 mVUcacheFnv(u64 hash, const void* data, size_t size) {
+	for (size_t i = 0; i < size; i++) {
+		hash ^= ((const u8*)data)[i];
+		hash *= 0x100000001b3ull;
+	}
+	return hash;
+}
+
+static u64 mVUcacheHash(microVU& mVU, const u32* data, u32 startPC) {
+	u64 hash = mVUcacheFnv(0xcbf29ce484222325ull, &startPC, sizeof(startPC));
+	return mVUcacheFnv(hash, data, mVU.microMemSize);
+}
+
+// Compiled code depends on these, a cache made with other settings is ignored
+static u64 mVUcacheConfig() {
+	u64 hash = 0xcbf29ce484222325ull;
+	hash = mVUcacheFnv(hash, &EmuConfig.Cpu.Recompiler.bitset, sizeof(EmuConfig.Cpu.Recompiler.bitset));
+	hash = mVUcacheFnv(hash, &EmuConfig.Gamefixes.bitset, sizeof(EmuConfig.Gamefixes.bitset));
+	hash = mVUcacheFnv(hash, &EmuConfig.Speedhacks.bitset, sizeof(EmuConfig.Speedhacks.bitset));
+	return hash;
+}
+
+static wxString mVUcachePath(microVU& mVU, u32 crc) {
+	wxFileName fn(EmuConfig.VUCacheFolder);
+	fn.Mkdir(wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL);
+	fn.SetFullName(pxsFmt(L"%08X_vu%u.bin", crc, mVU.index));
+	return fn.GetFullPath();
+}
+
+// Moves the entry points of a program which is about to be deleted (or of a live one
+// when the game changes) to the cache of the current game.
+void mVUcacheStash(microVU& mVU, microProgram& prog) {
+	if (!prog.entries || prog.entries->empty()) return;
+
+	microCache& cache = mVUdiskCache[mVU.index];
+	std::lock_guard<std::mutex> lock(cache.mutex);
+
+	const u64 hash = mVUcacheHash(mVU, prog.data, prog.startPC);
+	auto it = cache.progs.find(hash);
+	if (it == cache.progs.end()) {
+		if (cache.progs.size() >= mVUcacheMaxProgs) {
+			auto lessUsed = [](const decltype(cache.progs)::value_type& a, const decltype(cache.progs)::value_type& b) { return a.second.uses < b.second.uses; };
+			cache.progs.erase(std::min_element(cache.progs.begin(), cache.progs.end(), lessUsed));
+		}
+		it = cache.progs.emplace(hash, microCacheProg()).first;
+		it->second.startPC = prog.startPC;
+		it->second.data.assign(prog.data, prog.data + mVU.progSize);
+	}
+
+	microCacheProg& cached = it->second;
+	cached.uses++;
+	for (const microCacheEntry& entry : *prog.entries) {
+		if (cached.entries.size() >= mVUcacheMaxEntries) break;
+		auto same = [&](const microCacheEntry& e) { return !memcmp(&e, &entry, sizeof(entry)); };
+		if (std::none_of(cached.entries.begin(), cached.entries.end(), same))
+			cached.entries.push_back(entry);
+	}
+}
+
+void mVUcacheSave(microVU& mVU) {
+	microCache& cache = mVUdiskCache[mVU.index];
+	std::lock_guard<std::mutex> lock(cache.mutex);
+
+	if (!cache.crc || cache.progs.empty() || !EmuConfig.VUCacheFolder.IsOk()) return;
+
+	// Most used first, as many as fit in mVUcacheMaxFile
+	std::vector<const microCacheProg*> progs;
+	for (const auto& it : cache.progs)
+		progs.push_back(&it.second);
+	std::stable_sort(progs.begin(), progs.end(), [](const microCacheProg* a, const microCacheProg* b) { return a->uses > b->uses; });
+
+	size_t fileSize = sizeof(microCacheHeader);
+	for (size_t i = 0; i < progs.size(); i++) {
+		fileSize += 2 * sizeof(u32) + progs[i]->data.size() * sizeof(u32) + progs[i]->entries.size() * sizeof(microCacheEntry);
+		if (fileSize > mVUcacheMaxFile) {
+			progs.resize(i);
+			break;
+		}
+	}
+
+	FILE* fp = wxFopen(mVUcachePath(mVU, cache.crc), L"wb");
+	if (!fp) {
+		Console.Warning("microVU%d: Couldn't write the program cache of %08X", mVU.index, cache.crc);
+		return;
+	}
+
+	microCacheHeader header;
+	memcpy(header.magic, "MVUC", 4);
+	header.version   = mVUcacheVersion;
+	header.index     = mVU.index;
+	header.entrySize = sizeof(microCacheEntry);
+	header.config    = mVUcacheConfig();
+	header.count     = progs.size();
+	header.pad       = 0;
+	fwrite(&header, sizeof(header), 1, fp);
+
+	for (const microCacheProg* prog : progs) {
+		const microCacheProg& cached = *prog;
+		u32 count = cached.entries.size();
+		fwrite(&cached.startPC, sizeof(u32), 1, fp);
+		fwrite(&count, sizeof(u32), 1, fp);
+		fwrite(cached.data.data(), sizeof(u32), cached.data.size(), fp);
+		fwrite(cached.entries.data(), sizeof(microCacheEntry), count, fp);
+	}
+
+	fclose(fp);
+}
+
+static void mVUcacheLoad(microVU& mVU) {
+	microCache& cache = mVUdiskCache[mVU.index];
+	std::lock_guard<std::mutex> lock(cache.mutex);
+
+	if (!EmuConfig.VUCacheFolder.IsOk()) return;
+
+	FILE* fp = wxFopen(mVUcachePath(mVU, cache.crc), L"rb");
+	if (!fp) return;
+
+	microCacheHeader header;
+	if (fread(&header, sizeof(header), 1, fp) != 1 || memcmp(header.magic, "MVUC", 4)
+	 || header.version != mVUcacheVersion || header.index != mVU.index
+	 || header.entrySize != sizeof(microCacheEntry) || header.config != mVUcacheConfig()) {
+		fclose(fp);
+		return;
+	}
+
+	for (u32 i = 0; i < std::min(header.count, mVUcacheMaxProgs); i++) {
+		microCacheProg cached;
+		u32 count;
+		if (fread(&cached.startPC, sizeof(u32), 1, fp) != 1 || fread(&count, sizeof(u32), 1, fp) != 1)
+			break;
+		if (cached.startPC >= mVU.progSize / 2 || count > mVUcacheMaxEntries)
+			break;
+		cached.data.resize(mVU.progSize);
+		cached.entries.resize(count);
+		if (fread(cached.data.data(), sizeof(u32), mVU.progSize, fp) != mVU.progSize
+		 || fread(cached.entries.data(), sizeof(microCacheEntry), count, fp) != count)
+			break;
+		auto bad = [&](const microCacheEntry& e) { return (e.startPC & 7) || e.startPC > mVU.microMemSize - 8; };
+		if (std::any_of(cached.entries.begin(), cached.entries.end(), bad))
+			break;
+		u64 hash = mVUcacheHash(mVU, cached.data.data(), cached.startPC);
+		cached.uses = 1;
+		cache.progs[hash] = std::move(cached);
+	}
+
+	fclose(fp);
+}
+
+// Recompiles the cached programs, with their micro memory temporarily put back in place.
+// Must run on the thread executing the VU, with x86Ptr set to the program cache.
+static void mVUcacheWarmStart(microVU& mVU) {
+	microCache& cache = mVUdiskCache[mVU.index];
+	std::lock_guard<std::mutex> lock(cache.mutex);
+
+	if (cache.progs.empty()) return;
+
+	std::unique_ptr<u8[]> micro(new u8[mVU.microMemSize]);
+	memcpy(micro.get(), mVU.regs().Micro, mVU.microMemSize);
+
+	u32 progs = 0, blocks = 0;
+	for (const auto& it : cache.progs) {
+		// Leave room for the programs the game will actually run
+		if (xGetPtr() >= mVU.prog.x86start + (mVU.prog.x86end - mVU.prog.x86start) / 2) break;
+
+		const microCacheProg& cached = it.second;
+		memcpy(mVU.regs().Micro, cached.data.data(), mVU.microMemSize);
+
+		mVU.prog.isSame = 1;
+		mVU.prog.cur = mVUcreateProg(mVU, cached.startPC);
+		mVU.prog.cur->entries->assign(cached.entries.begin(), cached.entries.end());
+		mVU.prog.prog[cached.startPC]->push_back(mVU.prog.cur);
+
+		for (const microCacheEntry& entry : cached.entries) {
+			mVUblockFetch(mVU, entry.startPC, (uptr)&entry.pState);
+			blocks++;
+		}
+		progs++;
+	}
+
+	memcpy(mVU.regs().Micro, micro.get(), mVU.microMemSize);
+
+	// Let the next execution search the program lists again
+	mVU.prog.cleared = 1;
+	mVU.prog.isSame  = -1;
+	mVU.prog.cur     = NULL;
+	for (u32 i = 0; i < (mVU.progSize / 2); i++) {
+		mVU.prog.quick[i].block = NULL;
+		mVU.prog.quick[i].prog  = NULL;
+	}
+
+	Console.WriteLn(mVU.index ? Color_Orange : Color_Magenta, "microVU%d: Recompiled %u cached programs (%u entry points)", mVU.index, progs, blocks);
+}
+
+// Called before each execution once the game has started, when the game has changed
+// since the last time: saves the programs of the previous game and warms up the next one.
+static void mVUcacheSwitchGame(microVU& mVU, u32 crc) {
+	for (u32 i = 0; i < (mVU.progSize / 2); i++) {
+		for (microProgram* prog : *mVU.prog.prog[i]) {
+			mVUcacheStash(mVU, *prog);
+			prog->entries->clear();
+		}
+	}
+
+	mVUcacheSave(mVU);
+
+	{
+		microCache& cache = mVUdiskCache[mVU.index];
+		std::lock_guard<std::mutex> lock(cache.mutex);
+		cache.progs.clear();
+		cache.crc = crc;
+	}
+
+	mVUcacheLoad(mVU);
+	mVUcacheWarmStart(mVU);
+}
+
+// Called before each execution: switches the cache over once a new game has started.
+static void mVUcacheCheckGame(microVU& mVU) {
+	if (EmuConfig.Cpu.Recompiler.EnableVUCache && g_GameStarted && ElfCRC && (ElfCRC != mVUdiskCache[mVU.index].crc))
+		mVUcacheSwitchGame(mVU, ElfCRC);
+}
@@ -770,6 +770,24 @@ __fi void* mVUblockFetch(microVU& mVU, u32 startPC, uptr pState) {
 	return mVUentryGet(mVU, mVUblocks[startPC/8], startPC, pState);
 }
 
+// Same as mVUblockFetch(), but for runtime entry points, which get recorded for the program cache
+__fi void* mVUentryFetch(microVU& mVU, u32 startPC, uptr pState) {
+
+	startPC &= mVU.microMemSize-8;
+
+	blockCreate(startPC/8);
+	microBlock* pBlock = mVUblocks[startPC/8]->search((microRegInfo*)pState);
+	if (pBlock) return pBlock->x86ptrStart;
+
+	if (EmuConfig.Cpu.Recompiler.EnableVUCache) {
+		microCacheEntry entry = {};
+		entry.startPC = startPC;
+		memcpy(&entry.pState, (void*)pState, sizeof(microRegInfo));
+		mVU.prog.cur->entries->push_back(entry);
+	}
+	return mVUcompile(mVU, startPC, pState);
+}
+
 // mVUcompileJIT() - Called By JR/JALR during execution
 _mVUt void* __fastcall mVUcompileJIT(u32 startPC, uptr ptr) {
 	if (doJumpAsSameProgram) { // Treat jump as part of same microProgram
@@ -778,12 +796,12 @@ _mVUt void* __fastcall mVUcompileJIT(u32 startPC, uptr ptr) {
 			microBlock* pBlock = (microBlock*)ptr;
 			microJumpCache& jc = pBlock->jumpCache[startPC / 8];
 			if (jc.prog && jc.prog == mVU.prog.quick[startPC / 8].prog) return jc.x86ptrStart;
-			void* v = mVUblockFetch(mVUx, startPC, (uptr)&pBlock->pStateEnd);
+			void* v = mVUentryFetch(mVUx, startPC, (uptr)&pBlock->pStateEnd);
 			jc.prog = mVU.prog.quick[startPC / 8].prog;
 			jc.x86ptrStart = v;
 			return v;
 		}
-		return mVUblockFetch(mVUx, startPC, ptr);
+		return mVUentryFetch(mVUx, startPC, ptr);
 	}
 	mVUx.regs().start_pc = startPC;
 	if (doJumpCaching) { // When doJumpCaching, ptr is a microBlock pointer
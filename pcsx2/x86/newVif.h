@@ -37,6 +37,7 @@ extern void  dVifClose   (int idx);
 extern void  dVifRelease (int idx);
 extern void  VifUnpackSSE_Init();
 extern void  VifUnpackSSE_Destroy();
+extern int   dVifBenchmark(int loops);
 
 _vifT extern void  dVifUnpack  (const u8* data, bool isFill);
 
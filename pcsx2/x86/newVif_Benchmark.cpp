@@ -0,0 +1,159 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// newVif Benchmark - Times the unpack recompiler on synthetic data (--vifbench).
+// Every kind of nVifBlock is compiled with the SSE code generator and, when the CPU
+// supports it, with the AVX2 one; the AVX2 output is checked against the SSE output.
+
+#include "PrecompiledHeader.h"
+#include "newVif_UnpackSSE.h"
+
+static const char* const dVifBenchUnpackName[16] = {
+	"S-32",  "S-16",  "S-8",  "",
+	"V2-32", "V2-16", "V2-8", "",
+	"V3-32", "V3-16", "V3-8", "",
+	"V4-32", "V4-16", "V4-8", "V4-5",
+};
+
+struct dVifBenchCycle {
+	u8 cl, wl;
+	const char* name;
+};
+
+static const dVifBenchCycle dVifBenchCycles[] = {
+	{4, 4, "full"},
+	{4, 2, "skip"}, // cl > wl, skipping write
+	{2, 4, "fill"}, // cl < wl, filling write
+};
+
+struct dVifBenchWrite {
+	bool mask;
+	u8 mode;
+	const char* name;
+};
+
+static const dVifBenchWrite dVifBenchWrites[] = {
+	{false, 0, "plain"},
+	{true,  0, "mask"},
+	{false, 1, "offset"},
+};
+
+static const uint dVifBenchNum  = 128;
+static const uint dVifBenchReps = 2000;
+
+static nVifrecCall dVifBenchCompile(nVifStruct& v, const nVifBlock& block, bool avx2) {
+	if (v.recWritePtr > (v.recReserve->GetPtrEnd() - _256kb))
+		dVifReset(1);
+
+	xSetPtr(v.recWritePtr);
+	nVifrecCall func = (nVifrecCall)xGetAlignedCallTarget();
+
+	VifUnpackSSE_Dynarec gen(v, block);
+	gen.useAVX2 = avx2;
+	gen.CompileRoutine();
+
+	v.recWritePtr = xGetPtr();
+	return func;
+}
+
+// Best time of a call to the routine over the given number of loops, in nanoseconds
+static double dVifBenchTime(nVifrecCall func, u8* dest, const u8* src, int loops) {
+	u64 best = ~0ull;
+	for (int i = 0; i < loops; i++) {
+		const u64 start = GetCPUTicks();
+		for (uint rep = 0; rep < dVifBenchReps; rep++)
+			func((uptr)dest, (uptr)src);
+		best = std::min(best, GetCPUTicks() - start);
+	}
+	return (double)best * 1e9 / (double)GetTickFrequency() / dVifBenchReps;
+}
+
+int dVifBenchmark(int loops) {
+	const bool avx2 = x86caps.hasAVX2;
+	loops = std::max(loops, 1);
+
+	// Unpacks never write more than 0xFFFF bytes (see dVifComputeLength)
+	ScopedAlignedAlloc<u8, 16> src(_4kb);
+	ScopedAlignedAlloc<u8, 16> destSSE(_64kb);
+	ScopedAlignedAlloc<u8, 16> destAVX(_64kb);
+
+	u32 seed = 0x12345678;
+	for (uint i = 0; i < _4kb; i++) {
+		seed = seed * 1103515245 + 12345;
+		src[i] = seed >> 24;
+	}
+
+	dVifReserve(1);
+	dVifReset(1);
+	nVifStruct& v = nVif[1];
+
+	Console.WriteLn(Color_StrongBlue, "VIF unpack benchmark: num=%u, %u calls x %d loops, AVX2 %s",
+		dVifBenchNum, dVifBenchReps, loops, avx2 ? "enabled" : "not supported");
+
+	int mismatches = 0;
+	double totalSSE = 0, totalAVX = 0;
+
+	for (int upk = 0; upk < 16; upk++) {
+		if (!nVifT[upk]) continue;
+		// The V2 and V3 unpacks also depend on where the data starts in its quadword
+		// (IsAligned, see xUPK_V3_32), so both alignments are compared for them.
+		const u8 alignments = (upk >= 4 && upk < 12) ? 2 : 1;
+		for (int usn = 0; usn < 2; usn++) {
+			for (u8 aligned = 0; aligned < alignments; aligned++) {
+				for (const dVifBenchWrite& write : dVifBenchWrites) {
+					for (const dVifBenchCycle& cycle : dVifBenchCycles) {
+						nVifBlock block = {};
+						block.num     = dVifBenchNum;
+						block.upkType = upk | (write.mask ? 0x10 : 0) | (usn << 5);
+						block.mask    = write.mask ? 0xE4E4E4E4 : 0;
+						block.mode    = write.mode;
+						block.cl      = cycle.cl;
+						block.wl      = cycle.wl;
+						block.aligned = aligned;
+
+						nVifrecCall funcSSE = dVifBenchCompile(v, block, false);
+						nVifrecCall funcAVX = avx2 ? dVifBenchCompile(v, block, true) : funcSSE;
+
+						memset(destSSE.GetPtr(), 0, _64kb);
+						memset(destAVX.GetPtr(), 0, _64kb);
+						funcSSE((uptr)destSSE.GetPtr(), (uptr)src.GetPtr());
+						funcAVX((uptr)destAVX.GetPtr(), (uptr)src.GetPtr());
+						const bool same = !memcmp(destSSE.GetPtr(), destAVX.GetPtr(), _64kb);
+
+						const double timeSSE = dVifBenchTime(funcSSE, destSSE.GetPtr(), src.GetPtr(), loops);
+						const double timeAVX = avx2 ? dVifBenchTime(funcAVX, destAVX.GetPtr(), src.GetPtr(), loops) : timeSSE;
+						totalSSE += timeSSE;
+						totalAVX += timeAVX;
+
+						Console.WriteLn(same ? Color_Default : Color_StrongRed,
+							"  %-5s %s %-6s %s%s:  SSE %8.1f ns  AVX2 %8.1f ns  x%.2f%s",
+							dVifBenchUnpackName[upk], usn ? "usn" : "sgn", write.name, cycle.name, aligned ? " aligned" : "",
+							timeSSE, timeAVX, timeSSE / timeAVX, same ? "" : "  MISMATCH");
+
+						if (!same) mismatches++;
+					}
+				}
+			}
+		}
+	}
+
+	Console.WriteLn(Color_StrongBlue, "Total:  SSE %.1f us  AVX2 %.1f us  x%.2f",
+		totalSSE / 1000, totalAVX / 1000, totalSSE / totalAVX);
+	if (mismatches)
+		Console.Error("VIF unpack benchmark: %d blocks unpack differently with AVX2", mismatches);
+
+	dVifRelease(1);
+	return mismatches ? 2 : 0;
+}
@@ -65,6 +65,8 @@ VifUnpackSSE_Dynarec::VifUnpackSSE_Dynarec(const nVifStruct& vif_, const nVifBlo
 	doMode		= vB.mode & 3;
 	IsAligned   = vB.aligned;
 	vCL			= 0;
+	useAVX2		= x86caps.hasAVX2;
+	upperDirty	= false;
 }
 
 __fi void makeMergeMask(u32& x)
@@ -154,6 +156,62 @@ void VifUnpackSSE_Dynarec::writeBackRow() const {
 	// ToDo: Do we need to write back to vifregs.rX too!? :/
 }
 
+// Clears the W field of the first or of the second vector of a V3-32 pair
+static const __aligned32 u32 AVXXYZWMask[2][8] =
+{
+	{0xffffffff, 0xffffffff, 0xffffffff, 0x00000000, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff},
+	{0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0x00000000}
+};
+
+// The unmasked V4-32, V4-16 and V3-32 unpacks can be done two vectors at a time with AVX2,
+// as long as both vectors are written next to each other (no skipping in between).
+bool VifUnpackSSE_Dynarec::IsWideUnpack(int upknum, uint vNum, int cycleSize, int blockSize) const
+{
+	if (!useAVX2 || !IsUnmaskedOp() || vNum < 2) return false;
+	if (upknum != 8 && upknum != 12 && upknum != 13) return false;
+
+	return (vCL + 1 < cycleSize) || (cycleSize == blockSize);
+}
+
+void VifUnpackSSE_Dynarec::xUnpackWide(int upknum)
+{
+	const xRegisterYMM destWide(destReg);
+
+	switch (upknum)
+	{
+		case 8:
+			// Same reads as two xUPK_V3_32, and since IsAligned and the loop iteration
+			// are 0 or 1, exactly one of the two vectors gets its W field cleared.
+			pxAssume(UnpkLoopIteration <= 1 && IsAligned <= 1);
+			xVINSERTI128(destWide, destWide, ptr128[srcIndirect], 0);
+			xVINSERTI128(destWide, destWide, ptr128[srcIndirect + 12], 1);
+			xVANDPS(destWide, destWide, ptr[AVXXYZWMask[UnpkLoopIteration == IsAligned]]);
+			break;
+		case 12:
+			xVMOVUPS(destWide, ptr[srcIndirect]);
+			break;
+		case 13:
+			if (usn)	xVPMOVZX.WD(destWide, ptr128[srcIndirect]);
+			else		xVPMOVSX.WD(destWide, ptr128[srcIndirect]);
+			break;
+		default:
+			pxFailRel( wxsFormat( L"Vpu/Vif - Invalid wide Unpack! [%d]", upknum ) );
+			break;
+	}
+
+	xVMOVUPS(ptr[dstIndirect], destWide);
+	upperDirty = true;
+}
+
+// Avoids the AVX to SSE transition penalty before the legacy SSE unpacks or returning
+void VifUnpackSSE_Dynarec::xClearUpper()
+{
+	if (!upperDirty) return;
+
+	xVZEROUPPER();
+	upperDirty = false;
+}
+
 static void ShiftDisplacementWindow( xAddressVoid& addr, const xRegisterLong& modReg )
 {
 	// Shifts the displacement factor of a given indirect address, so that the address
@@ -227,7 +285,20 @@ void VifUnpackSSE_Dynarec::CompileRoutine() {
 			ShiftDisplacementWindow( srcIndirect, arg2reg ); //Don't need to do this otherwise as we arent reading the source.
 
 
-		if (vCL < cycleSize) {
+		if (vCL < cycleSize && IsWideUnpack(upkNum, vNum, cycleSize, blockSize)) {
+			xUnpackWide(upkNum);
+			ModUnpack(upkNum, true);
+			ModUnpack(upkNum, true);
+
+			dstIndirect += 32;
+			srcIndirect += vift * 2;
+
+			vNum -= 2;
+			if (++vCL == blockSize) vCL = 0;
+			if (++vCL == blockSize) vCL = 0;
+		}
+		else if (vCL < cycleSize) {
+			xClearUpper();
 			ModUnpack(upkNum, false);
 			xUnpack(upkNum);
 			xMovDest();
@@ -243,6 +314,7 @@ void VifUnpackSSE_Dynarec::CompileRoutine() {
 		else if (isFill) {
 			//Filling doesn't need anything fancy, it's pretty much a normal write, just doesnt increment the source.
 			//DevCon.WriteLn("filling mode!");
+			xClearUpper();
 			xUnpack(upkNum);
 			xMovDest();
 
@@ -257,6 +329,7 @@ void VifUnpackSSE_Dynarec::CompileRoutine() {
 		}
 	}
 
+	xClearUpper();
 	if (doMode>=2) writeBackRow();
 	xRET();
 }
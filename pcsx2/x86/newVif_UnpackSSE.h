@@ -108,11 +108,13 @@ class VifUnpackSSE_Dynarec : public VifUnpackSSE_Base
 public:
 	bool			isFill;
 	int				doMode;			// two bit value representing... something!
+	bool			useAVX2;		// unpack two vectors at once when possible (defaults to x86caps)
 	
 protected:
 	const nVifStruct&	v;			// vif0 or vif1
 	const nVifBlock&	vB;			// some pre-collected data from VifStruct
 	int					vCL;		// internal copy of vif->cl
+	bool				upperDirty;	// ymm registers were written since the last VZEROUPPER
 
 public:
 	VifUnpackSSE_Dynarec(const nVifStruct& vif_, const nVifBlock& vifBlock_);
@@ -123,6 +125,8 @@ public:
 	{
 		isFill	= src.isFill;
 		vCL		= src.vCL;
+		useAVX2	= src.useAVX2;
+		upperDirty = false;
 	}
 
 	virtual ~VifUnpackSSE_Dynarec() = default;
@@ -138,6 +142,10 @@ protected:
 	void SetMasks(int cS) const;
 	void writeBackRow() const;
 
+	bool IsWideUnpack(int upknum, uint vNum, int cycleSize, int blockSize) const;
+	void xUnpackWide(int upknum);
+	void xClearUpper();
+
 	static VifUnpackSSE_Dynarec FillingWrite( const VifUnpackSSE_Dynarec& src )
 	{
 		VifUnpackSSE_Dynarec fillingWrite( src );
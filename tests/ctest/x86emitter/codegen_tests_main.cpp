@@ -163,3 +163,34 @@ TEST(CodegenTests, SSETest)
 	CODEGEN_TEST_64(xBLEND.PD(xmm8, xmm9, 0xaa), "66 45 0f 3a 0d c1 aa");
 	CODEGEN_TEST_64(xEXTRACTPS(ptr32[base], xmm1, 2), "66 0f 3a 17 0d f6 ff ff ff 02");
 }
+
+TEST(CodegenTests, BMITest)
+{
+	CODEGEN_TEST_64(xMULX(eax, ecx, edx), "c4 e2 73 f6 c2");
+	CODEGEN_TEST_64(xMULX(r8, r9, r10), "c4 42 b3 f6 c2");
+	CODEGEN_TEST_64(xPDEP(rax, rbx, ptr[r8]), "c4 c2 e3 f5 00");
+	CODEGEN_TEST_64(xPEXT(r9d, r10d, ptr[r11*4+rax]), "c4 22 2a f5 0c 98");
+	CODEGEN_TEST_64(xANDN_S(eax, ecx, edx), "c4 e2 70 f2 c2");
+}
+
+TEST(CodegenTests, AVXTest)
+{
+	CODEGEN_TEST_64(xVMOVUPS(ymm0, ymm1), "c5 fc 10 c1");
+	CODEGEN_TEST_64(xVMOVUPS(ymm8, ymm9), "c4 41 7c 10 c1");
+	CODEGEN_TEST_64(xVMOVUPS(ymm0, ptr[rax]), "c5 fc 10 00");
+	CODEGEN_TEST_64(xVMOVUPS(ymm8, ptr[r8+r9]), "c4 01 7c 10 04 08");
+	CODEGEN_TEST_64(xVMOVUPS(ymm1, ptr[base]), "c5 fc 10 0d f8 ff ff ff");
+	CODEGEN_TEST_64(xVMOVUPS(ptr[rax+r9], ymm8), "c4 21 7c 11 04 08");
+	CODEGEN_TEST_64(xVMOVUPS(ptr[r8], ymm1), "c4 c1 7c 11 08");
+	CODEGEN_TEST_64(xVANDPS(ymm0, ymm1, ymm2), "c5 f4 54 c2");
+	CODEGEN_TEST_64(xVANDPS(ymm0, ymm12, ymm3), "c5 9c 54 c3");
+	CODEGEN_TEST_64(xVANDPS(ymm8, ymm9, ptr[r10]), "c4 41 34 54 02");
+	CODEGEN_TEST_64(xVPMOVSX.WD(ymm0, xmm1), "c4 e2 7d 23 c1");
+	CODEGEN_TEST_64(xVPMOVSX.WD(ymm8, xmm9), "c4 42 7d 23 c1");
+	CODEGEN_TEST_64(xVPMOVZX.WD(ymm9, ptr[r8]), "c4 42 7d 33 08");
+	CODEGEN_TEST_64(xVPMOVZX.WD(ymm0, ptr[rbx*4+3+rcx]), "c4 e2 7d 33 44 99 03");
+	CODEGEN_TEST_64(xVINSERTI128(ymm0, ymm1, ptr[rax], 1), "c4 e3 75 38 00 01");
+	CODEGEN_TEST_64(xVINSERTI128(ymm8, ymm9, ptr[r10*4+r11], 1), "c4 03 35 38 04 93 01");
+	CODEGEN_TEST_64(xVINSERTI128(ymm0, ymm1, ptr[base], 1), "c4 e3 75 38 05 f6 ff ff ff 01");
+	CODEGEN_TEST_BOTH(xVZEROUPPER(), "c5 f8 77");
+}